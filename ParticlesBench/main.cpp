@@ -0,0 +1,440 @@
+// Headless throughput benchmark of the CPU particle step.
+//
+// Runs every combination of particle count, thread count, storage layout, kernel, force law and
+// integrator and prints the results as JSON, either to stdout or to the file given with --output.
+//
+//   particles_bench [--counts 10000,1000000] [--threads 1,8] [--layouts soa,aos]
+//                   [--kernels reference,fast] [--forces inverse-square,harmonic]
+//                   [--integrators verlet,euler] [--softening 0.1] [--boundary open|reflect]
+//                   [--steps 10] [--repeats 5] [--output results.json]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Clock.h"
+#include "ParallelUtils.h"
+#include "ParticlesSimulation.h"
+#include "ParticlesStore.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    using ParticlesSimulation::Boundary;
+    using ParticlesSimulation::ForceLaw;
+    using ParticlesSimulation::Integrator;
+    using ParticlesSimulation::Kernel;
+    using ParticlesSimulation::KernelConfig;
+    using ParticlesSimulation::Layout;
+
+    // Half size of the cube the particles are spawned in, and reflected by with --boundary reflect.
+    constexpr float s_SpawnExtent = 25.5f;
+
+    struct BenchOptions
+    {
+        std::vector<size_t> Counts = { 10000, 100000, 1000000, 10000000, 100000000 };
+        std::vector<size_t> Threads;
+        std::vector<Layout> Layouts = { Layout::StructureOfArrays, Layout::ArrayOfStructures };
+        std::vector<Kernel> Kernels = { Kernel::Reference, Kernel::Fast };
+        std::vector<ForceLaw> Forces = { ForceLaw::InverseSquare };
+        std::vector<Integrator> Integrators = { Integrator::VelocityVerlet };
+        float Softening = 0.0f;
+        Boundary Bounds = Boundary::Open;
+        size_t Steps = 10;
+        size_t Repeats = 5;
+        std::string Output;
+    };
+
+    struct BenchResult
+    {
+        size_t Count;
+        size_t Threads;
+        Layout StorageLayout;
+        KernelConfig Config;
+        std::vector<double> NanosecondsPerParticleStep = {};
+        double MeanNanoseconds = 0.0;
+        double StandardDeviation = 0.0;
+        double MinNanoseconds = 0.0;
+        double BandwidthGBs = 0.0;
+    };
+
+    std::vector<std::string_view> Split(std::string_view text)
+    {
+        std::vector<std::string_view> parts;
+
+        while (!text.empty())
+        {
+            const auto comma = text.find(',');
+            parts.push_back(text.substr(0, comma));
+            text = (comma == std::string_view::npos) ? std::string_view{} : text.substr(comma + 1);
+        }
+
+        return parts;
+    }
+
+    bool ParseSizes(std::string_view text, std::vector<size_t>& values)
+    {
+        values.clear();
+
+        for (const auto part : Split(text))
+        {
+            char* end = nullptr;
+            const std::string value{ part };
+            const auto number = std::strtoull(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != '\0' || number == 0)
+            {
+                return false;
+            }
+
+            values.push_back(static_cast<size_t>(number));
+        }
+
+        return !values.empty();
+    }
+
+    bool ParseOptions(int argc, char** argv, BenchOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            const std::string_view value = argv[++i];
+            bool result = true;
+
+            if (argument == "--counts")
+            {
+                result = ParseSizes(value, options.Counts);
+            }
+            else if (argument == "--threads")
+            {
+                result = ParseSizes(value, options.Threads);
+            }
+            else if (argument == "--steps")
+            {
+                std::vector<size_t> steps;
+                result = ParseSizes(value, steps) && steps.size() == 1;
+                options.Steps = result ? steps[0] : 0;
+            }
+            else if (argument == "--repeats")
+            {
+                std::vector<size_t> repeats;
+                result = ParseSizes(value, repeats) && repeats.size() == 1;
+                options.Repeats = result ? repeats[0] : 0;
+            }
+            else if (argument == "--layouts")
+            {
+                options.Layouts.clear();
+                for (const auto part : Split(value))
+                {
+                    if (part == "soa")
+                    {
+                        options.Layouts.push_back(Layout::StructureOfArrays);
+                    }
+                    else if (part == "aos")
+                    {
+                        options.Layouts.push_back(Layout::ArrayOfStructures);
+                    }
+                    else
+                    {
+                        result = false;
+                    }
+                }
+            }
+            else if (argument == "--kernels")
+            {
+                options.Kernels.clear();
+                for (const auto part : Split(value))
+                {
+                    if (part == "reference")
+                    {
+                        options.Kernels.push_back(Kernel::Reference);
+                    }
+                    else if (part == "fast")
+                    {
+                        options.Kernels.push_back(Kernel::Fast);
+                    }
+                    else
+                    {
+                        result = false;
+                    }
+                }
+            }
+            else if (argument == "--forces")
+            {
+                options.Forces.clear();
+                for (const auto part : Split(value))
+                {
+                    if (part == "inverse-square")
+                    {
+                        options.Forces.push_back(ForceLaw::InverseSquare);
+                    }
+                    else if (part == "harmonic")
+                    {
+                        options.Forces.push_back(ForceLaw::Harmonic);
+                    }
+                    else
+                    {
+                        result = false;
+                    }
+                }
+            }
+            else if (argument == "--integrators")
+            {
+                options.Integrators.clear();
+                for (const auto part : Split(value))
+                {
+                    if (part == "verlet")
+                    {
+                        options.Integrators.push_back(Integrator::VelocityVerlet);
+                    }
+                    else if (part == "euler")
+                    {
+                        options.Integrators.push_back(Integrator::SemiImplicitEuler);
+                    }
+                    else
+                    {
+                        result = false;
+                    }
+                }
+            }
+            else if (argument == "--softening")
+            {
+                char* end = nullptr;
+                const std::string text{ value };
+                options.Softening = std::strtof(text.c_str(), &end);
+                result = end != text.c_str() && *end == '\0' && options.Softening >= 0.0f;
+            }
+            else if (argument == "--boundary")
+            {
+                result = value == "open" || value == "reflect";
+                options.Bounds = value == "reflect" ? Boundary::Reflect : Boundary::Open;
+            }
+            else if (argument == "--output")
+            {
+                options.Output = value;
+            }
+            else
+            {
+                result = false;
+            }
+
+            if (!result)
+            {
+                return false;
+            }
+        }
+
+        // Default to powers of two up to the number of hardware threads.
+        if (options.Threads.empty())
+        {
+            const auto hardwareThreads = ParallelUtils::GetDefaultThreadCount();
+            for (size_t threads = 1; threads < hardwareThreads; threads *= 2)
+            {
+                options.Threads.push_back(threads);
+            }
+            options.Threads.push_back(hardwareThreads);
+        }
+
+        return true;
+    }
+
+    ParticlesSimulation::StepParameters GetStepParameters(size_t step) noexcept
+    {
+        // Orbit the well around the origin like the viewer does, so every step sees a different field.
+        constexpr float circleRadius = 0.5f;
+        constexpr float deltaTime = 16.0f / 15.0f;
+        const float theta = 0.01f * static_cast<float>(step);
+
+        return { { 0.0f, circleRadius * std::cos(theta), circleRadius * std::sin(theta) }, deltaTime };
+    }
+
+    BenchResult RunBench(const BenchOptions& options, size_t count, size_t threads, Layout layout, const KernelConfig& config)
+    {
+        ParticlesStore store;
+        std::vector<ParticlesSimulation::ParticleRecord> records;
+        WorkerPool workers;
+        BenchResult result{ count, threads, layout, config };
+
+        // The workers are started before the timed steps, the samples measure the kernel and not the
+        // creation of threads.
+        workers.Initialize(threads);
+
+        store.GenerateUniformCube(count, s_SpawnExtent);
+        if (layout == Layout::ArrayOfStructures)
+        {
+            ParticlesSimulation::StoreToRecords(store, records);
+            store.Clear();
+        }
+
+        const auto step = [&](size_t index) {
+            if (layout == Layout::StructureOfArrays)
+            {
+                ParticlesSimulation::Step(store, GetStepParameters(index), config, workers);
+            }
+            else
+            {
+                ParticlesSimulation::Step(records, GetStepParameters(index), config, workers);
+            }
+        };
+
+        // One untimed step to fault in the pages and warm the caches.
+        step(0);
+
+        size_t stepIndex = 1;
+        for (size_t repeat = 0; repeat < options.Repeats; ++repeat)
+        {
+            const uint64_t start = Clock::Now();
+            for (size_t i = 0; i < options.Steps; ++i)
+            {
+                step(stepIndex++);
+            }
+            const auto elapsed = static_cast<double>(Clock::Now() - start);
+
+            result.NanosecondsPerParticleStep.push_back(elapsed / static_cast<double>(count * options.Steps));
+        }
+
+        const auto& samples = result.NanosecondsPerParticleStep;
+        double sum = 0.0;
+        for (const auto sample : samples)
+        {
+            sum += sample;
+        }
+        result.MeanNanoseconds = sum / static_cast<double>(samples.size());
+
+        double squares = 0.0;
+        for (const auto sample : samples)
+        {
+            squares += (sample - result.MeanNanoseconds) * (sample - result.MeanNanoseconds);
+        }
+        result.StandardDeviation = samples.size() > 1 ? std::sqrt(squares / static_cast<double>(samples.size() - 1)) : 0.0;
+        result.MinNanoseconds = *std::min_element(samples.begin(), samples.end());
+
+        // Bytes per nanosecond is the same as gigabytes per second.
+        result.BandwidthGBs = static_cast<double>(ParticlesSimulation::GetBytesPerParticle(layout)) / result.MeanNanoseconds;
+
+        return result;
+    }
+
+    void WriteJson(std::ostream& out, const BenchOptions& options, const std::vector<BenchResult>& results)
+    {
+        out << "{\n";
+        out << "  \"benchmark\": \"particles_step\",\n";
+        out << "  \"hardware_threads\": " << ParallelUtils::GetDefaultThreadCount() << ",\n";
+        out << "  \"steps_per_repeat\": " << options.Steps << ",\n";
+        out << "  \"repeats\": " << options.Repeats << ",\n";
+        out << "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            out << "    {\n";
+            out << "      \"particles\": " << result.Count << ",\n";
+            out << "      \"threads\": " << result.Threads << ",\n";
+            out << "      \"layout\": \"" << ParticlesSimulation::GetLayoutName(result.StorageLayout) << "\",\n";
+            out << "      \"kernel\": \"" << ParticlesSimulation::GetKernelName(result.Config.Math) << "\",\n";
+            out << "      \"force\": \"" << ParticlesSimulation::GetForceLawName(result.Config.Force) << "\",\n";
+            out << "      \"integrator\": \"" << ParticlesSimulation::GetIntegratorName(result.Config.Integration) << "\",\n";
+            out << "      \"softening\": " << result.Config.Softening << ",\n";
+            out << "      \"boundary\": \"" << ParticlesSimulation::GetBoundaryName(result.Config.Bounds) << "\",\n";
+            out << "      \"ns_per_particle_step\": " << result.MeanNanoseconds << ",\n";
+            out << "      \"ns_per_particle_step_min\": " << result.MinNanoseconds << ",\n";
+            out << "      \"ns_per_particle_step_stddev\": " << result.StandardDeviation << ",\n";
+            out << "      \"variance\": " << result.StandardDeviation * result.StandardDeviation << ",\n";
+            out << "      \"gb_per_s\": " << result.BandwidthGBs << ",\n";
+            out << "      \"samples\": [";
+            for (size_t j = 0; j < result.NanosecondsPerParticleStep.size(); ++j)
+            {
+                out << (j ? ", " : "") << result.NanosecondsPerParticleStep[j];
+            }
+            out << "]\n";
+            out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n";
+        out << "}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    std::vector<BenchResult> results;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: particles_bench [--counts N,...] [--threads N,...] [--layouts soa,aos] "
+                     "[--kernels reference,fast] [--forces inverse-square,harmonic] [--integrators verlet,euler] "
+                     "[--softening F] [--boundary open|reflect] [--steps N] [--repeats N] [--output file]\n";
+        return 1;
+    }
+
+    for (const auto count : options.Counts)
+    {
+        for (const auto threads : options.Threads)
+        {
+            for (const auto layout : options.Layouts)
+            {
+                for (const auto kernel : options.Kernels)
+                {
+                    for (const auto force : options.Forces)
+                    {
+                        for (const auto integrator : options.Integrators)
+                        {
+                            KernelConfig config{ kernel };
+                            config.Force = force;
+                            config.Integration = integrator;
+                            config.Softening = options.Softening;
+                            config.Bounds = options.Bounds;
+                            config.BoundaryExtent = s_SpawnExtent;
+
+                            results.push_back(RunBench(options, count, threads, layout, config));
+
+                            // Progress goes to stderr so stdout stays valid JSON.
+                            const auto& result = results.back();
+                            std::fprintf(
+                                stderr,
+                                "%zu particles, %zu threads, %s, %s, %s, %s: %.3f ns/particle/step\n",
+                                count,
+                                threads,
+                                ParticlesSimulation::GetLayoutName(layout).data(),
+                                ParticlesSimulation::GetKernelName(kernel).data(),
+                                ParticlesSimulation::GetForceLawName(force).data(),
+                                ParticlesSimulation::GetIntegratorName(integrator).data(),
+                                result.MeanNanoseconds);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (options.Output.empty())
+    {
+        WriteJson(std::cout, options, results);
+    }
+    else
+    {
+        std::ofstream fout{ options.Output };
+        if (fout.fail())
+        {
+            std::cerr << "Could not open " << options.Output << "\n";
+            return 1;
+        }
+
+        WriteJson(fout, options, results);
+    }
+
+    return 0;
+}
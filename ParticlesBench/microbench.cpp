@@ -0,0 +1,442 @@
+// Microbenchmarks of the CPU-side functions that scale with data size or run every frame.
+//
+// Every case is measured with warm caches (repeated calls back to back) and with cold caches
+// (a large buffer is streamed through the caches before each call). Heap allocations made by a
+// call are counted through replaced global operator new/delete.
+//
+//   particles_microbench [--assets ./assets] [--output results.json]
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetManager.h"
+#include "AssetPack.h"
+#include "CameraClass.h"
+#include "Clock.h"
+#include "FontAtlas.h"
+#include "FontLayout.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+#include "MathUtils.h"
+#include "ParticlesGeometry.h"
+#include "ParticlesStore.h"
+#include "TextBatch.h"
+
+namespace
+{
+    std::atomic<size_t> s_AllocationsCount{ 0 };
+    std::atomic<size_t> s_AllocatedBytes{ 0 };
+}
+
+void* operator new(size_t size)
+{
+    s_AllocationsCount.fetch_add(1, std::memory_order_relaxed);
+    s_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size ? size : 1))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    struct CaseResult
+    {
+        std::string Name;
+        bool Cold;
+        size_t Iterations;
+        double MeanNanoseconds;
+        double MinNanoseconds;
+        double AllocationsPerCall;
+        double AllocatedBytesPerCall;
+    };
+
+    // Larger than the last level cache of the machines we run on.
+    constexpr size_t s_FlushBufferSize = 64 * 1024 * 1024;
+
+    void FlushCaches(std::vector<unsigned char>& buffer)
+    {
+        volatile unsigned char sink = 0;
+
+        for (size_t i = 0; i < buffer.size(); i += 64)
+        {
+            buffer[i] = static_cast<unsigned char>(buffer[i] + 1);
+            sink = sink + buffer[i];
+        }
+    }
+
+    CaseResult Measure(std::string_view name, bool cold, size_t iterations, const std::function<void()>& function)
+    {
+        static std::vector<unsigned char> flushBuffer(s_FlushBufferSize);
+
+        CaseResult result{ std::string(name), cold, iterations, 0.0, 0.0, 0.0, 0.0 };
+        double total = 0.0;
+        double minimum = std::numeric_limits<double>::max();
+        size_t allocations = 0;
+        size_t allocatedBytes = 0;
+
+        // Warm up once, so the warm numbers do not include first-touch page faults.
+        function();
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            if (cold)
+            {
+                FlushCaches(flushBuffer);
+            }
+
+            const auto allocationsBefore = s_AllocationsCount.load(std::memory_order_relaxed);
+            const auto bytesBefore = s_AllocatedBytes.load(std::memory_order_relaxed);
+            const uint64_t start = Clock::Now();
+
+            function();
+
+            const auto elapsed = static_cast<double>(Clock::Now() - start);
+            allocations += s_AllocationsCount.load(std::memory_order_relaxed) - allocationsBefore;
+            allocatedBytes += s_AllocatedBytes.load(std::memory_order_relaxed) - bytesBefore;
+
+            total += elapsed;
+            minimum = std::min(minimum, elapsed);
+        }
+
+        result.MeanNanoseconds = total / static_cast<double>(iterations);
+        result.MinNanoseconds = minimum;
+        result.AllocationsPerCall = static_cast<double>(allocations) / static_cast<double>(iterations);
+        result.AllocatedBytesPerCall = static_cast<double>(allocatedBytes) / static_cast<double>(iterations);
+
+        std::fprintf(
+            stderr,
+            "%-40s %-4s %14.1f ns  %8.1f allocs  %12.0f bytes\n",
+            result.Name.c_str(),
+            cold ? "cold" : "warm",
+            result.MeanNanoseconds,
+            result.AllocationsPerCall,
+            result.AllocatedBytesPerCall);
+
+        return result;
+    }
+
+    void MeasureBoth(std::vector<CaseResult>& results, std::string_view name, size_t iterations, const std::function<void()>& function)
+    {
+        results.push_back(Measure(name, false, iterations, function));
+        results.push_back(Measure(name, true, iterations, function));
+    }
+
+    // Camera and projection of the viewer: 1920x1080, 45 degree field of view, camera at z = -70.
+    void GetViewerMatrices(MathUtils::Float4x4& view, MathUtils::Float4x4& projection)
+    {
+        constexpr float fieldOfView = 3.141592654f / 4.0f;
+        constexpr float screenAspect = 1920.0f / 1080.0f;
+        constexpr float screenNear = 0.1f;
+        constexpr float screenDepth = 1000.0f;
+
+        const float yScale = 1.0f / std::tan(fieldOfView / 2.0f);
+
+        view = MathUtils::Identity();
+        view.m[3][0] = -12.5f;
+        view.m[3][2] = 70.0f;
+
+        projection = {};
+        projection.m[0][0] = yScale / screenAspect;
+        projection.m[1][1] = yScale;
+        projection.m[2][2] = screenDepth / (screenDepth - screenNear);
+        projection.m[2][3] = 1.0f;
+        projection.m[3][2] = -screenNear * screenDepth / (screenDepth - screenNear);
+    }
+
+    void WriteJson(std::ostream& out, const std::vector<CaseResult>& results)
+    {
+        out << "{\n";
+        out << "  \"benchmark\": \"cpu_hot_functions\",\n";
+        out << "  \"results\": [\n";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto& result = results[i];
+
+            out << "    {\n";
+            out << "      \"name\": \"" << result.Name << "\",\n";
+            out << "      \"cache\": \"" << (result.Cold ? "cold" : "warm") << "\",\n";
+            out << "      \"iterations\": " << result.Iterations << ",\n";
+            out << "      \"ns_per_call\": " << result.MeanNanoseconds << ",\n";
+            out << "      \"ns_per_call_min\": " << result.MinNanoseconds << ",\n";
+            out << "      \"allocations_per_call\": " << result.AllocationsPerCall << ",\n";
+            out << "      \"allocated_bytes_per_call\": " << result.AllocatedBytesPerCall << "\n";
+            out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        out << "  ]\n";
+        out << "}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string assets = "./assets";
+    std::string output;
+    std::vector<CaseResult> results;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const std::string_view argument = argv[i];
+        if (argument == "--assets")
+        {
+            assets = argv[i + 1];
+        }
+        else if (argument == "--output")
+        {
+            output = argv[i + 1];
+        }
+        else
+        {
+            std::cerr << "usage: particles_microbench [--assets dir] [--output file]\n";
+            return 1;
+        }
+    }
+
+    // ParticlesShader: index buffer for the default 1M particles (6M entries).
+    MeasureBoth(results, "ParticlesGeometry::GenerateIndexBuffer/1M", 5, []() {
+        const auto indices = ParticlesGeometry::GenerateIndexBuffer(1000000);
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    });
+
+    // ParticlesShader: initial uniform cube of the default 1M particles.
+    MeasureBoth(results, "ParticlesStore::GenerateUniformCube/1M", 5, []() {
+        ParticlesStore store;
+        store.GenerateUniformCube(1000000, 25.5f);
+    });
+
+    // The unprojection the gravity well used before the camera cached its matrices: three matrix
+    // inversions per point.
+    MathUtils::Float4x4 view, projection;
+    GetViewerMatrices(view, projection);
+    volatile float sink = 0.0f;
+
+    MeasureBoth(results, "MathUtils::UnprojectToWorldPlaneXY", 10000, [&]() {
+        const auto position = MathUtils::UnprojectToWorldPlaneXY(view, projection, 0.25f, -0.5f);
+        sink = sink + position.x;
+    });
+
+    // ParticlesShader::UpdateGravityFieldPosition: the drifting camera rebuilds its view once per
+    // frame, then every substep of the cursor path is unprojected in one batch.
+    CameraClass camera;
+    camera.SetProjection(projection);
+    camera.SetPosition(12.5f, 0.0f, -70.0f);
+    camera.Render();
+
+    MeasureBoth(results, "CameraClass::Render/Moved", 10000, [&]() {
+        const auto position = camera.GetPosition();
+        camera.SetPosition(position.x + 1e-3f, position.y, position.z);
+        camera.Render();
+    });
+
+    std::vector<MathUtils::Float2> points(16);
+    std::vector<MathUtils::Float3> positions(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        points[i] = { -0.5f + static_cast<float>(i) / 16.0f, 0.25f };
+    }
+
+    MeasureBoth(results, "CameraClass::UnprojectToPlane/16", 10000, [&]() {
+        camera.UnprojectToPlane(points, { 0.0f, 0.0f, 1.0f, 0.0f }, positions);
+        sink = sink + positions.back().x;
+    });
+
+    // FontClass: the font metrics of the HUD.
+    FontLayout font;
+    const auto fontFilename = assets + "/fontdata.txt";
+
+    if (font.LoadFontData(fontFilename))
+    {
+        MeasureBoth(results, "FontLayout::LoadFontData", 100, [&]() {
+            FontLayout layout;
+            layout.LoadFontData(fontFilename);
+        });
+
+        // FontClass::LoadAtlas: the same glyphs from the baked atlas, mapped and used in place.
+        const auto atlasFilename = assets + "/font.atlas";
+        FontAtlas atlas;
+
+        if (atlas.Load(atlasFilename))
+        {
+            MeasureBoth(results, "FontAtlas::Load", 100, [&]() {
+                FontAtlas mapped;
+                FontLayout layout;
+                mapped.Load(atlasFilename);
+                layout.LoadGlyphs(mapped.GetGlyphs(), mapped.GetLineHeight());
+                sink = sink + static_cast<float>(std::to_integer<int>(mapped.GetTexels()[0]));
+            });
+        }
+
+        // FontClass::BuildVertexArray: one HUD line, 16 characters at most.
+        std::vector<FontLayout::VertexType> vertices(6 * 16);
+
+        MeasureBoth(results, "FontLayout::BuildVertexArray/Fps", 10000, [&]() {
+            font.BuildVertexArray(vertices.data(), "Fps: 9999", -940.0f, 520.0f, 0.0f, 1.0f, 0.0f);
+        });
+
+        // TextBatch: the same line as indexed quads, four vertices per letter.
+        MeasureBoth(results, "FontLayout::BuildQuadArray/Fps", 10000, [&]() {
+            font.BuildQuadArray(vertices.data(), "Fps: 9999", -940.0f, 520.0f, 0.0f, 1.0f, 0.0f);
+        });
+
+        // A block of three HUD lines laid out as one string.
+        constexpr std::string_view block = "Fps: 9999\nCpu 42% App 12%\nMem 812MB Peak 901MB";
+        std::vector<FontLayout::VertexType> blockVertices(FontLayout::s_VerticesPerQuad * block.size());
+
+        MeasureBoth(results, "FontLayout::BuildQuadArray/MultiLine", 10000, [&]() {
+            font.BuildQuadArray(blockVertices.data(), block, -940.0f, 520.0f, 0.0f, 1.0f, 0.0f);
+        });
+
+        // TextClass: a HUD of 24 lines set every frame, with unchanged text and with one line
+        // changing. Only changed lines are laid out again.
+        TextBatch batch;
+        batch.Initialize(font, 1920, 1080);
+        for (int line = 0; line < 24; ++line)
+        {
+            batch.AddLine(32, 20, 20 + 40 * line);
+            batch.SetLine(static_cast<size_t>(line), "p50 16.6 p90 16.7 p99 18.2", 0.0f, 1.0f, 0.0f);
+        }
+        batch.Update();
+
+        MeasureBoth(results, "TextBatch::Update/24Lines/Unchanged", 10000, [&]() {
+            for (size_t line = 0; line < 24; ++line)
+            {
+                batch.SetLine(line, "p50 16.6 p90 16.7 p99 18.2", 0.0f, 1.0f, 0.0f);
+            }
+            batch.Update();
+        });
+
+        int fps = 0;
+        MeasureBoth(results, "TextBatch::Update/24Lines/OneChanged", 10000, [&]() {
+            char fpsString[16];
+            std::snprintf(fpsString, sizeof(fpsString), "Fps: %d", fps++ % 10000);
+            batch.SetLine(0, fpsString, 0.0f, 1.0f, 0.0f);
+            for (size_t line = 1; line < 24; ++line)
+            {
+                batch.SetLine(line, "p50 16.6 p90 16.7 p99 18.2", 0.0f, 1.0f, 0.0f);
+            }
+            batch.Update();
+        });
+    }
+    else
+    {
+        std::cerr << "Could not read " << fontFilename << ", skipping the font cases\n";
+    }
+
+    // AssetPack: the startup files of the viewer opened one by one, and packed and opened as one
+    // mapping. Both touch the first byte of every file.
+    const std::vector<std::string> packedNames = { "blue_texture.jpg", "font.atlas", "font.gif", "fontdata.txt" };
+    const auto packFilename = (std::filesystem::temp_directory_path() / "particles_microbench.pack").string();
+    AssetPack packWriter;
+
+    {
+        std::vector<std::unique_ptr<MappedFile>> packedFiles;
+        std::vector<AssetPack::PackFile> packFiles;
+
+        for (const auto& name : packedNames)
+        {
+            auto file = std::make_unique<MappedFile>();
+            if (file->Open(assets + "/" + name))
+            {
+                packFiles.push_back({ name, { file->GetData(), file->GetSize() } });
+                packedFiles.push_back(std::move(file));
+            }
+        }
+
+        if (packFiles.size() != packedNames.size() || !packWriter.Save(packFilename, packFiles))
+        {
+            std::cerr << "Could not pack the assets, skipping the asset pack cases\n";
+        }
+        else
+        {
+            MeasureBoth(results, "MappedFile::Open/4Files", 100, [&]() {
+                for (const auto& name : packedNames)
+                {
+                    MappedFile file;
+                    file.Open(assets + "/" + name);
+                    sink = sink + static_cast<float>(std::to_integer<int>(file.GetData()[0]));
+                }
+            });
+
+            MeasureBoth(results, "AssetPack::Open/4Files", 100, [&]() {
+                AssetPack pack;
+                pack.Open(packFilename);
+                for (const auto& name : packedNames)
+                {
+                    sink = sink + static_cast<float>(std::to_integer<int>(pack.Find(name)[0]));
+                }
+            });
+        }
+    }
+
+    std::filesystem::remove(packFilename);
+
+    // AssetManager: the software decode of the font texture, and loading a path that is already
+    // cached, which is all a repeated texture request costs.
+    const auto imageFilename = assets + "/font.gif";
+    MappedFile imageFile;
+
+    if (imageFile.Open(imageFilename))
+    {
+        MeasureBoth(results, "ImageDecoder::DecodeGif/Font", 100, [&]() {
+            ImageData image;
+            std::string errorMessage;
+            ImageDecoder::DecodeGif({ imageFile.GetData(), imageFile.GetSize() }, image, errorMessage);
+            sink = sink + static_cast<float>(image.Width);
+        });
+
+        AssetManager assetManager;
+        assetManager.Initialize(1);
+        assetManager.Load(imageFilename)->Wait();
+
+        MeasureBoth(results, "AssetManager::Load/Cached", 1000, [&]() {
+            sink = sink + static_cast<float>(assetManager.Load(imageFilename)->GetState() == AssetManager::State::Ready);
+        });
+    }
+
+    if (output.empty())
+    {
+        WriteJson(std::cout, results);
+    }
+    else
+    {
+        std::ofstream fout{ output };
+        if (fout.fail())
+        {
+            std::cerr << "Could not open " << output << "\n";
+            return 1;
+        }
+
+        WriteJson(fout, results);
+    }
+
+    return 0;
+}
@@ -0,0 +1,283 @@
+// Checks of ShaderCache with a stub compiler, so they run without Direct3D.
+//
+// The shaders are loose files of a directory pack in a temporary directory. Every step opens the
+// pack and the cache again, the way a new launch of the viewer does, and checks whether the
+// bytecode came from the pack, the cache directory or the compiler. Changing the source, a
+// file it includes, the entry point, the profile, the flags or the compiler has to compile again.
+// Changing nothing must not.
+//
+//   particles_shadercache_check [--directory dir]
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetPack.h"
+#include "ShaderCache.h"
+
+namespace
+{
+    // Bytecode that echoes everything it was compiled from, so a stale entry shows up as
+    // different bytecode and not only in the statistics.
+    class StubCompiler final : public ShaderCompiler
+    {
+    public:
+        explicit StubCompiler(std::string identity)
+            : m_identity(std::move(identity))
+        {
+        }
+
+        std::string_view GetIdentity() const noexcept override
+        {
+            return m_identity;
+        }
+
+        bool Compile(
+            const ShaderDesc& desc,
+            std::span<const std::byte> source,
+            const AssetPack& pack,
+            std::vector<std::byte>& bytecode,
+            std::string& errors) override
+        {
+            std::string text = m_identity + "|" + std::string(desc.EntryPoint) + "|" + std::string(desc.Target) + "|" +
+                               std::to_string(desc.Flags) + "|";
+            text.append(reinterpret_cast<const char*>(source.data()), source.size());
+
+            // The stub knows the one include of the check shader.
+            const auto include = pack.Find(ShaderCache::ResolveInclude(desc.Filename, "common.hlsli"));
+            text.append(reinterpret_cast<const char*>(include.data()), include.size());
+
+            if (text.find("error") != std::string::npos)
+            {
+                errors = "stub: the source asks for an error";
+                return false;
+            }
+
+            const auto bytes = std::as_bytes(std::span(text.data(), text.size()));
+            bytecode.assign(bytes.begin(), bytes.end());
+
+            return true;
+        }
+
+    private:
+        std::string m_identity;
+    };
+
+    enum class Outcome
+    {
+        PackHit,
+        DirectoryHit,
+        Compile,
+        Failure
+    };
+
+    const char* GetOutcomeName(Outcome outcome)
+    {
+        switch (outcome)
+        {
+        case Outcome::PackHit:
+            return "pack hit";
+        case Outcome::DirectoryHit:
+            return "directory hit";
+        case Outcome::Compile:
+            return "compile";
+        default:
+            return "failure";
+        }
+    }
+
+    class CheckRunner
+    {
+    public:
+        explicit CheckRunner(std::filesystem::path root)
+            : m_root(std::move(root))
+            , m_failures(0)
+        {
+        }
+
+        void WriteFile(std::string_view name, std::string_view text) const
+        {
+            const auto path = m_root / "assets" / name;
+
+            std::filesystem::create_directories(path.parent_path());
+            std::ofstream fout{ path, std::ios::binary };
+            fout.write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+
+        //--------------------------------------------------------------------------------------
+        // Open the pack and the cache like a new launch, request the shader once and check
+        // where its bytecode came from.
+        //--------------------------------------------------------------------------------------
+        void Expect(
+            std::string_view step,
+            const ShaderDesc& desc,
+            Outcome expected,
+            std::string_view identity = "stub 1",
+            std::string_view cacheDirectory = "cache")
+        {
+            AssetPack pack;
+            ShaderCache cache;
+            std::vector<std::byte> bytecode;
+            std::string errors;
+
+            pack.OpenDirectory((m_root / "assets").string());
+            cache.Initialize(std::make_unique<StubCompiler>(std::string(identity)), pack,
+                             (m_root / cacheDirectory).string());
+
+            const bool result = cache.GetBytecode(desc, bytecode, errors);
+            const auto stats = cache.GetStats();
+
+            Outcome outcome = Outcome::Failure;
+            if (result && stats.PackHits == 1)
+            {
+                outcome = Outcome::PackHit;
+            }
+            else if (result && stats.DirectoryHits == 1)
+            {
+                outcome = Outcome::DirectoryHit;
+            }
+            else if (result && stats.Compiles == 1)
+            {
+                outcome = Outcome::Compile;
+            }
+
+            // A hit has to return what the compiler would return now.
+            bool matches = true;
+            if (result)
+            {
+                std::vector<std::byte> compiled;
+                std::string compileErrors;
+
+                StubCompiler compiler{ std::string(identity) };
+                compiler.Compile(desc, pack.Find(desc.Filename), pack, compiled, compileErrors);
+                matches = compiled == bytecode;
+            }
+
+            const bool passed = outcome == expected && matches;
+            m_failures += passed ? 0 : 1;
+
+            std::cout << (passed ? "ok     " : "FAILED ") << step << ": " << GetOutcomeName(outcome);
+            if (outcome != expected)
+            {
+                std::cout << ", expected " << GetOutcomeName(expected);
+            }
+            if (!matches)
+            {
+                std::cout << ", stale bytecode";
+            }
+            std::cout << "\n";
+        }
+
+        int GetFailures() const noexcept
+        {
+            return m_failures;
+        }
+
+    private:
+        std::filesystem::path m_root;
+        int m_failures;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    std::filesystem::path root = std::filesystem::temp_directory_path() / "particles_shadercache_check";
+
+    if (argc == 3 && std::string_view(argv[1]) == "--directory")
+    {
+        root = argv[2];
+    }
+    else if (argc != 1)
+    {
+        std::cerr << "usage: particles_shadercache_check [--directory dir]\n";
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(root, error);
+
+    CheckRunner runner{ root };
+
+    constexpr std::string_view source = "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return Color; }\n";
+    constexpr std::string_view common = "float4 Color;\n";
+
+    runner.WriteFile("shaders/check.hlsl", source);
+    runner.WriteFile("shaders/common.hlsli", common);
+
+    const ShaderDesc desc{ "shaders/check.hlsl", "main", "ps_5_0", 0 };
+
+    // An empty cache compiles, the next launch finds the entry.
+    runner.Expect("first launch", desc, Outcome::Compile);
+    runner.Expect("second launch", desc, Outcome::DirectoryHit);
+    runner.Expect("same file by another name", { "./shaders/check.hlsl", "main", "ps_5_0", 0 }, Outcome::DirectoryHit);
+
+    // Everything that decides the bytecode is part of the key.
+    runner.Expect("other flags", { "shaders/check.hlsl", "main", "ps_5_0", 1 }, Outcome::Compile);
+    runner.Expect("other entry point", { "shaders/check.hlsl", "other", "ps_5_0", 0 }, Outcome::Compile);
+    runner.Expect("other profile", { "shaders/check.hlsl", "main", "ps_4_0", 0 }, Outcome::Compile);
+    runner.Expect("other compiler", desc, Outcome::Compile, "stub 2");
+
+    runner.WriteFile("shaders/common.hlsli", "float4 Color;\nfloat4 Tint;\n");
+    runner.Expect("changed include", desc, Outcome::Compile);
+    runner.Expect("changed include again", desc, Outcome::DirectoryHit);
+
+    runner.WriteFile("shaders/check.hlsl", "#include \"common.hlsli\"\nfloat4 main() : SV_Target { return Tint; }\n");
+    runner.Expect("changed source", desc, Outcome::Compile);
+
+    // Entries are never invalidated, going back to the old files finds the old entry.
+    runner.WriteFile("shaders/check.hlsl", source);
+    runner.WriteFile("shaders/common.hlsli", common);
+    runner.Expect("restored files", desc, Outcome::DirectoryHit);
+
+    // A truncated entry is not used, the shader compiles and the entry is written again.
+    {
+        AssetPack pack;
+        ShaderCache cache;
+
+        pack.OpenDirectory((root / "assets").string());
+        cache.Initialize(std::make_unique<StubCompiler>("stub 1"), pack, std::string());
+
+        const auto entry = root / "cache" / ShaderCache::GetEntryName(cache.ComputeKey(desc, pack.Find(desc.Filename)));
+        std::filesystem::resize_file(entry, sizeof(ShaderCache::ShaderEntryHeader) + 1, error);
+    }
+    runner.Expect("truncated entry", desc, Outcome::Compile);
+    runner.Expect("rewritten entry", desc, Outcome::DirectoryHit);
+
+    // An entry shipped in the pack is found before the cache directory is looked at.
+    {
+        AssetPack pack;
+        ShaderCache cache;
+
+        pack.OpenDirectory((root / "assets").string());
+        cache.Initialize(std::make_unique<StubCompiler>("stub 1"), pack, std::string());
+
+        const auto name = ShaderCache::GetEntryName(cache.ComputeKey(desc, pack.Find(desc.Filename)));
+        std::filesystem::create_directories(root / "assets" / ShaderCache::s_PackDirectory, error);
+        std::filesystem::copy_file(root / "cache" / name, root / "assets" / ShaderCache::s_PackDirectory / name,
+                                   std::filesystem::copy_options::overwrite_existing, error);
+    }
+    runner.Expect("prebuilt entry", desc, Outcome::PackHit, "stub 1", "empty");
+
+    // Failures are not cached.
+    runner.WriteFile("shaders/check.hlsl", "#include \"common.hlsli\"\nerror\n");
+    runner.Expect("compile error", desc, Outcome::Failure);
+    runner.Expect("compile error again", desc, Outcome::Failure);
+    runner.Expect("missing source", { "shaders/missing.hlsl", "main", "ps_5_0", 0 }, Outcome::Failure);
+
+    std::filesystem::remove_all(root, error);
+
+    if (runner.GetFailures() != 0)
+    {
+        std::cout << runner.GetFailures() << " shader cache checks failed\n";
+        return 1;
+    }
+
+    std::cout << "All shader cache checks passed\n";
+    return 0;
+}
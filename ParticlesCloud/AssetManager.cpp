@@ -0,0 +1,376 @@
+#include "AssetManager.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+
+#include "Profiler.h"
+
+namespace
+{
+    constexpr uint64_t Rotl(uint64_t value, int bits) noexcept
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    // Mix eight bytes into the hash, the round of the single lane xxHash64 loop.
+    constexpr uint64_t MixWord(uint64_t hash, uint64_t word) noexcept
+    {
+        constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+        constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+        constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+
+        hash ^= Rotl(word * prime2, 31) * prime1;
+        return Rotl(hash, 27) * prime1 + prime4;
+    }
+
+    // 64-bit hash over eight bytes at a time. The last bytes are zero padded into one more
+    // word, the length is mixed in so the padding can not be mistaken for content, and the
+    // MurmurHash3 finalizer spreads every input bit over the whole hash. Equal hashes are
+    // only a hint, the bytes are compared before an image is shared.
+    uint64_t HashContent(std::span<const std::byte> data) noexcept
+    {
+        uint64_t hash = 0x27D4EB2F165667C5ull + data.size();
+        size_t i = 0;
+
+        for (; i + sizeof(uint64_t) <= data.size(); i += sizeof(uint64_t))
+        {
+            uint64_t word;
+            std::memcpy(&word, data.data() + i, sizeof(word));
+            hash = MixWord(hash, word);
+        }
+        if (i < data.size())
+        {
+            uint64_t word = 0;
+            std::memcpy(&word, data.data() + i, data.size() - i);
+            hash = MixWord(hash, word);
+        }
+
+        hash ^= hash >> 33;
+        hash *= 0xFF51AFD7ED558CCDull;
+        hash ^= hash >> 33;
+        hash *= 0xC4CEB9FE1A85EC53ull;
+        hash ^= hash >> 33;
+
+        return hash;
+    }
+
+    std::string ToLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) {
+            return static_cast<char>(std::tolower(c));
+        });
+
+        return text;
+    }
+
+    std::string GetExtension(const std::string& path)
+    {
+        return ToLower(std::filesystem::path(path).extension().string());
+    }
+}
+
+AssetManager::ImageAsset::ImageAsset(std::string path)
+    : m_path(std::move(path))
+    , m_contentHash(0)
+    , m_contentSize(0)
+    , m_state(State::Loading)
+{
+}
+
+AssetManager::State AssetManager::ImageAsset::GetState() const noexcept
+{
+    return m_state.load(std::memory_order_acquire);
+}
+
+AssetManager::State AssetManager::ImageAsset::Wait() const
+{
+    State state = m_state.load(std::memory_order_acquire);
+    if (state != State::Loading)
+    {
+        return state;
+    }
+
+    std::unique_lock lock{ m_mutex };
+    m_finished.wait(lock, [this, &state]() {
+        state = m_state.load(std::memory_order_acquire);
+        return state != State::Loading;
+    });
+
+    return state;
+}
+
+const ImageData& AssetManager::ImageAsset::GetImage() const noexcept
+{
+    return *m_image;
+}
+
+const std::string& AssetManager::ImageAsset::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
+
+const std::string& AssetManager::ImageAsset::GetPath() const noexcept
+{
+    return m_path;
+}
+
+uint64_t AssetManager::ImageAsset::GetContentHash() const noexcept
+{
+    return m_contentHash;
+}
+
+AssetManager::AssetManager()
+    : m_pack(nullptr)
+    , m_stop(false)
+{
+}
+
+AssetManager::~AssetManager()
+{
+    Shutdown();
+}
+
+void AssetManager::Initialize(size_t threadCount, const AssetPack* pack)
+{
+    // Restart a running manager, images queued before the first Initialize are kept.
+    if (!m_threads.empty())
+    {
+        Shutdown();
+    }
+
+    {
+        std::lock_guard lock{ m_mutex };
+        m_stop = false;
+    }
+
+    m_pack = pack;
+
+    RegisterDecoder(".gif", ImageDecoder::DecodeGif);
+#ifdef _WIN32
+    for (const auto* extension : { ".bmp", ".jpeg", ".jpg", ".png", ".tif", ".tiff" })
+    {
+        RegisterDecoder(extension, ImageDecoder::DecodeWic);
+    }
+#endif
+
+    threadCount = std::max<size_t>(threadCount, 1);
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        m_threads.emplace_back(&AssetManager::WorkerThread, this);
+    }
+}
+
+void AssetManager::Shutdown()
+{
+    std::deque<std::shared_ptr<ImageAsset>> pending;
+
+    {
+        std::lock_guard lock{ m_mutex };
+        m_stop = true;
+    }
+    m_queued.notify_all();
+
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+    m_threads.clear();
+
+    // Handles stay valid after the caches are dropped, the queued ones just never decode.
+    {
+        std::lock_guard lock{ m_mutex };
+        pending.swap(m_queue);
+        m_paths.clear();
+        m_contents.clear();
+    }
+
+    for (const auto& asset : pending)
+    {
+        asset->m_errorMessage = "The asset manager shut down before the image was decoded.";
+        Finish(*asset, State::Failed);
+    }
+}
+
+void AssetManager::RegisterDecoder(std::string_view extension, ImageDecoder::DecodeFunction decoder)
+{
+    std::lock_guard lock{ m_mutex };
+    m_decoders[ToLower(std::string(extension))] = decoder;
+}
+
+AssetManager::ImageHandle AssetManager::Load(std::string_view path)
+{
+    // "./assets/a.gif" and "assets/a.gif" are the same asset.
+    auto key = AssetPack::NormalizeName(path);
+
+    std::lock_guard lock{ m_mutex };
+
+    ++m_stats.Requests;
+
+    // Nothing would ever decode the image after Shutdown, so it fails right away.
+    if (m_stop)
+    {
+        std::shared_ptr<ImageAsset> asset{ new ImageAsset(std::move(key)) };
+        asset->m_errorMessage = "The asset manager is shut down.";
+        ++m_stats.Failures;
+        Finish(*asset, State::Failed);
+        return asset;
+    }
+
+    const auto found = m_paths.find(key);
+    if (found != m_paths.end())
+    {
+        ++m_stats.PathHits;
+        return found->second;
+    }
+
+    std::shared_ptr<ImageAsset> asset{ new ImageAsset(key) };
+    m_paths.emplace(std::move(key), asset);
+    m_queue.push_back(asset);
+    m_queued.notify_one();
+
+    return asset;
+}
+
+AssetManager::AssetStats AssetManager::GetStats() const
+{
+    std::lock_guard lock{ m_mutex };
+    return m_stats;
+}
+
+void AssetManager::WorkerThread()
+{
+    Profiler::SetThreadName("Assets");
+
+    for (;;)
+    {
+        std::shared_ptr<ImageAsset> asset;
+
+        {
+            std::unique_lock lock{ m_mutex };
+            m_queued.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+            if (m_stop)
+            {
+                return;
+            }
+
+            asset = std::move(m_queue.front());
+            m_queue.pop_front();
+        }
+
+        Decode(asset);
+    }
+}
+
+void AssetManager::Decode(const std::shared_ptr<ImageAsset>& asset)
+{
+    PROFILE_ZONE("Decode image");
+
+    MappedFile file;
+    ImageDecoder::DecodeFunction decoder = nullptr;
+    std::shared_ptr<ImageAsset> original;
+
+    // Decode straight from the pack or the mapped file, the bytes are only read once.
+    const auto data = OpenContent(asset->m_path, file);
+    if (data.empty())
+    {
+        asset->m_errorMessage = "Could not open the image file.";
+        std::lock_guard lock{ m_mutex };
+        ++m_stats.Failures;
+        Finish(*asset, State::Failed);
+        return;
+    }
+
+    asset->m_contentHash = HashContent(data);
+    asset->m_contentSize = data.size();
+
+    {
+        std::lock_guard lock{ m_mutex };
+
+        const auto foundDecoder = m_decoders.find(GetExtension(asset->m_path));
+        if (foundDecoder != m_decoders.end())
+        {
+            decoder = foundDecoder->second;
+
+            // The first asset with some content decodes it, the others wait for its image.
+            const auto [found, inserted] = m_contents.try_emplace(asset->m_contentHash, asset);
+            if (!inserted && found->second->m_contentSize == asset->m_contentSize)
+            {
+                original = found->second;
+            }
+        }
+    }
+
+    if (!decoder)
+    {
+        asset->m_errorMessage = "There is no decoder for the type of the image file.";
+        std::lock_guard lock{ m_mutex };
+        ++m_stats.Failures;
+        Finish(*asset, State::Failed);
+        return;
+    }
+
+    // Different files that hash the same are decoded each on their own, only the first one
+    // is found by its hash.
+    if (original)
+    {
+        MappedFile originalFile;
+        const auto originalData = OpenContent(original->m_path, originalFile);
+
+        if (originalData.size() != data.size() || std::memcmp(originalData.data(), data.data(), data.size()) != 0)
+        {
+            original.reset();
+        }
+    }
+
+    // The original is being decoded by another worker, it never waits itself.
+    if (original)
+    {
+        const State state = original->Wait();
+        asset->m_image = original->m_image;
+        asset->m_errorMessage = original->m_errorMessage;
+
+        std::lock_guard lock{ m_mutex };
+        ++m_stats.ContentHits;
+        Finish(*asset, state);
+        return;
+    }
+
+    auto image = std::make_shared<ImageData>();
+    const bool result = decoder(data, *image, asset->m_errorMessage);
+    if (result)
+    {
+        asset->m_image = std::move(image);
+    }
+
+    std::lock_guard lock{ m_mutex };
+    ++m_stats.Decodes;
+    m_stats.Failures += result ? 0 : 1;
+    Finish(*asset, result ? State::Ready : State::Failed);
+}
+
+std::span<const std::byte> AssetManager::OpenContent(const std::string& path, MappedFile& file) const
+{
+    if (m_pack)
+    {
+        return m_pack->Find(path);
+    }
+
+    if (file.Open(path))
+    {
+        return { file.GetData(), file.GetSize() };
+    }
+
+    return {};
+}
+
+void AssetManager::Finish(ImageAsset& asset, State state)
+{
+    {
+        std::lock_guard lock{ asset.m_mutex };
+        asset.m_state.store(state, std::memory_order_release);
+    }
+    asset.m_finished.notify_all();
+}
@@ -0,0 +1,145 @@
+#ifndef _ASSETMANAGER_H_
+#define _ASSETMANAGER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "AssetPack.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+
+// Decodes images on a pool of worker threads while the caller goes on with its own work. Load
+// returns a handle right away that becomes ready once the file is decoded. Images are cached by
+// path, so loading a path again returns the same handle, and by the hash of the file content, so
+// a second path with the same bytes shares the decoded image instead of decoding it again.
+class AssetManager
+{
+public:
+    enum class State
+    {
+        Loading,
+        Ready,
+        Failed
+    };
+
+    class ImageAsset
+    {
+    public:
+        ImageAsset(const ImageAsset&) = delete;
+        ImageAsset& operator=(const ImageAsset&) = delete;
+
+        State GetState() const noexcept;
+
+        //--------------------------------------------------------------------------------------
+        // Block until the image is decoded or failed, and return which.
+        //--------------------------------------------------------------------------------------
+        State Wait() const;
+
+        // The image is only valid once the asset is ready, the error message once it failed.
+        const ImageData& GetImage() const noexcept;
+        const std::string& GetErrorMessage() const noexcept;
+        const std::string& GetPath() const noexcept;
+        uint64_t GetContentHash() const noexcept;
+
+    private:
+        friend class AssetManager;
+
+        explicit ImageAsset(std::string path);
+
+    private:
+        std::string m_path;
+        uint64_t m_contentHash;
+        size_t m_contentSize;
+        std::shared_ptr<const ImageData> m_image;
+        std::string m_errorMessage;
+
+        std::atomic<State> m_state;
+        mutable std::mutex m_mutex;
+        mutable std::condition_variable m_finished;
+    };
+
+    using ImageHandle = std::shared_ptr<const ImageAsset>;
+
+    struct AssetStats
+    {
+        uint64_t Requests = 0;
+        uint64_t PathHits = 0;
+        uint64_t ContentHits = 0;
+        uint64_t Decodes = 0;
+        uint64_t Failures = 0;
+    };
+
+public:
+    AssetManager();
+    AssetManager(const AssetManager&) = delete;
+    AssetManager& operator=(const AssetManager&) = delete;
+    ~AssetManager();
+
+    //--------------------------------------------------------------------------------------
+    // Start the worker threads and register the decoders built into the platform: the
+    // software GIF decoder everywhere and the Windows imaging component on Windows. With a
+    // pack, images are decoded from it instead of from loose files; it has to outlive the
+    // manager.
+    //--------------------------------------------------------------------------------------
+    void Initialize(size_t threadCount, const AssetPack* pack = nullptr);
+
+    //--------------------------------------------------------------------------------------
+    // Stop the workers after the image they are decoding. Images still waiting in the queue
+    // fail, so nobody waits on them forever, and so do the ones loaded until the next
+    // Initialize.
+    //--------------------------------------------------------------------------------------
+    void Shutdown();
+
+    //--------------------------------------------------------------------------------------
+    // Decode files with the given extension, like ".png", with the decoder. Replaces the
+    // decoder registered before for the extension.
+    //--------------------------------------------------------------------------------------
+    void RegisterDecoder(std::string_view extension, ImageDecoder::DecodeFunction decoder);
+
+    //--------------------------------------------------------------------------------------
+    // Queue an image for decoding, or return the handle of the path when it was loaded
+    // before. Never blocks on the decode.
+    //--------------------------------------------------------------------------------------
+    ImageHandle Load(std::string_view path);
+
+    AssetStats GetStats() const;
+
+private:
+    void WorkerThread();
+    void Decode(const std::shared_ptr<ImageAsset>& asset);
+
+    //--------------------------------------------------------------------------------------
+    // Bytes of the file from the pack, or mapped into file when there is no pack. Empty
+    // when the file can not be read.
+    //--------------------------------------------------------------------------------------
+    std::span<const std::byte> OpenContent(const std::string& path, MappedFile& file) const;
+    static void Finish(ImageAsset& asset, State state);
+
+private:
+    std::vector<std::thread> m_threads;
+    const AssetPack* m_pack;
+
+    // Guards everything below.
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::deque<std::shared_ptr<ImageAsset>> m_queue;
+    bool m_stop;
+
+    std::unordered_map<std::string, std::shared_ptr<ImageAsset>> m_paths;
+    std::unordered_map<uint64_t, std::shared_ptr<ImageAsset>> m_contents;
+    std::unordered_map<std::string, ImageDecoder::DecodeFunction> m_decoders;
+    AssetStats m_stats;
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include "AssetPack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace
+{
+    uint64_t AlignSection(uint64_t offset) noexcept
+    {
+        return (offset + AssetPack::s_SectionAlignment - 1) / AssetPack::s_SectionAlignment * AssetPack::s_SectionAlignment;
+    }
+
+    bool WritePadding(std::ofstream& fout, uint64_t size)
+    {
+        const char padding[AssetPack::s_SectionAlignment] = {};
+        fout.write(padding, static_cast<std::streamsize>(size));
+        return !fout.fail();
+    }
+}
+
+AssetPack::AssetPack()
+    : m_entries(nullptr)
+    , m_entryCount(0)
+    , m_names(nullptr)
+{
+}
+
+bool AssetPack::Open(std::string_view filename)
+{
+    AssetPackHeader header;
+
+    m_errorMessage.clear();
+    Close();
+
+    // One mapping for every file in the pack, the entries and names are read in place.
+    if (!m_file.Open(filename))
+    {
+        m_errorMessage = "Could not open the asset pack.";
+        return false;
+    }
+
+    if (m_file.GetSize() < sizeof(AssetPackHeader))
+    {
+        m_errorMessage = "The asset pack is too small to hold a header.";
+        Close();
+        return false;
+    }
+
+    std::memcpy(&header, m_file.GetData(), sizeof(AssetPackHeader));
+
+    if (!ValidateHeader(header, m_file.GetSize()) || !ValidateEntries(header, m_file.GetSize()))
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void AssetPack::OpenDirectory(std::string_view directory)
+{
+    Close();
+    m_directory = directory;
+}
+
+void AssetPack::Close() noexcept
+{
+    m_file.Close();
+    m_entries = nullptr;
+    m_entryCount = 0;
+    m_names = nullptr;
+
+    std::lock_guard lock{ m_looseMutex };
+    m_directory.clear();
+    m_looseFiles.clear();
+}
+
+std::span<const std::byte> AssetPack::Find(std::string_view name) const
+{
+    const auto normalized = NormalizeName(name);
+
+    if (m_entries)
+    {
+        const auto* end = m_entries + m_entryCount;
+        const auto* entry = std::lower_bound(m_entries, end, normalized, [this](const EntryType& entry, const std::string& name) {
+            return GetName(entry) < name;
+        });
+        if (entry == end || GetName(*entry) != normalized)
+        {
+            return {};
+        }
+
+        return { m_file.GetData() + entry->Offset, entry->Size };
+    }
+
+    // Loose files stay mapped, so the spans handed out before stay valid.
+    std::lock_guard lock{ m_looseMutex };
+
+    if (m_directory.empty())
+    {
+        return {};
+    }
+
+    auto& file = m_looseFiles[normalized];
+    if (!file)
+    {
+        file = std::make_unique<MappedFile>();
+        if (!file->Open(m_directory + "/" + normalized))
+        {
+            return {};
+        }
+    }
+
+    return { file->GetData(), file->GetSize() };
+}
+
+bool AssetPack::Save(std::string_view filename, std::span<const PackFile> files)
+{
+    std::vector<PackFile> sorted;
+    std::vector<EntryType> entries;
+    AssetPackHeader header{};
+
+    m_errorMessage.clear();
+
+    sorted.reserve(files.size());
+    for (const auto& file : files)
+    {
+        sorted.push_back({ NormalizeName(file.Name), file.Data });
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const PackFile& a, const PackFile& b) { return a.Name < b.Name; });
+
+    const auto duplicate = std::adjacent_find(
+        sorted.begin(), sorted.end(), [](const PackFile& a, const PackFile& b) { return a.Name == b.Name; });
+    if (duplicate != sorted.end())
+    {
+        m_errorMessage = "The file " + duplicate->Name + " is packed twice.";
+        return false;
+    }
+
+    // Lay out the names after the entries and every file after the names.
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.EntryCount = static_cast<uint32_t>(sorted.size());
+    header.EntriesOffset = AlignSection(sizeof(AssetPackHeader));
+    header.NamesOffset = AlignSection(header.EntriesOffset + sorted.size() * sizeof(EntryType));
+
+    entries.reserve(sorted.size());
+    for (const auto& file : sorted)
+    {
+        entries.push_back({ header.NamesSize, file.Name.size(), 0, file.Data.size() });
+        header.NamesSize += file.Name.size();
+    }
+
+    uint64_t offset = AlignSection(header.NamesOffset + header.NamesSize);
+    for (auto& entry : entries)
+    {
+        entry.Offset = offset;
+        offset = AlignSection(offset + entry.Size);
+    }
+
+    std::ofstream fout{ std::string(filename), std::ios::binary };
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not create the asset pack.";
+        return false;
+    }
+
+    uint64_t position = sizeof(header);
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(fout, header.EntriesOffset - position);
+    fout.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(EntryType)));
+    position = header.EntriesOffset + entries.size() * sizeof(EntryType);
+    WritePadding(fout, header.NamesOffset - position);
+    for (const auto& file : sorted)
+    {
+        fout.write(file.Name.data(), static_cast<std::streamsize>(file.Name.size()));
+    }
+    position = header.NamesOffset + header.NamesSize;
+
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        WritePadding(fout, entries[i].Offset - position);
+        fout.write(reinterpret_cast<const char*>(sorted[i].Data.data()), static_cast<std::streamsize>(sorted[i].Data.size()));
+        position = entries[i].Offset + entries[i].Size;
+    }
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not write the asset pack.";
+        return false;
+    }
+
+    return true;
+}
+
+bool AssetPack::IsPacked() const noexcept
+{
+    return m_entries != nullptr;
+}
+
+size_t AssetPack::GetEntryCount() const noexcept
+{
+    return m_entryCount;
+}
+
+const std::string& AssetPack::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
+
+std::string AssetPack::NormalizeName(std::string_view name)
+{
+    return std::filesystem::path(name).lexically_normal().generic_string();
+}
+
+bool AssetPack::ValidateHeader(const AssetPackHeader& header, size_t fileSize)
+{
+    if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0)
+    {
+        m_errorMessage = "The file is not an asset pack.";
+        return false;
+    }
+
+    if (header.Version != s_Version)
+    {
+        m_errorMessage = "Unsupported asset pack version.";
+        return false;
+    }
+
+    if (header.EntriesOffset < sizeof(AssetPackHeader) || header.EntriesOffset % s_SectionAlignment != 0 ||
+        header.NamesOffset % s_SectionAlignment != 0)
+    {
+        m_errorMessage = "The asset pack has a misplaced section.";
+        return false;
+    }
+
+    const uint64_t entriesSize = uint64_t{ header.EntryCount } * sizeof(EntryType);
+    if (header.EntriesOffset > fileSize || entriesSize > fileSize - header.EntriesOffset ||
+        header.NamesOffset > fileSize || header.NamesSize > fileSize - header.NamesOffset)
+    {
+        m_errorMessage = "The asset pack is truncated.";
+        return false;
+    }
+
+    return true;
+}
+
+bool AssetPack::ValidateEntries(const AssetPackHeader& header, size_t fileSize)
+{
+    const auto* entries = reinterpret_cast<const EntryType*>(m_file.GetData() + header.EntriesOffset);
+    const auto* names = reinterpret_cast<const char*>(m_file.GetData() + header.NamesOffset);
+
+    for (uint32_t i = 0; i < header.EntryCount; ++i)
+    {
+        const auto& entry = entries[i];
+
+        if (entry.NameOffset > header.NamesSize || entry.NameSize > header.NamesSize - entry.NameOffset ||
+            entry.Offset > fileSize || entry.Size > fileSize - entry.Offset)
+        {
+            m_errorMessage = "The asset pack is truncated.";
+            return false;
+        }
+
+        // Find relies on the order for its binary search.
+        if (i > 0)
+        {
+            const auto& previous = entries[i - 1];
+            const std::string_view previousName{ names + previous.NameOffset, previous.NameSize };
+            if (previousName >= std::string_view{ names + entry.NameOffset, entry.NameSize })
+            {
+                m_errorMessage = "The asset pack entries are not sorted by name.";
+                return false;
+            }
+        }
+    }
+
+    m_entries = entries;
+    m_entryCount = header.EntryCount;
+    m_names = names;
+
+    return true;
+}
+
+std::string_view AssetPack::GetName(const EntryType& entry) const noexcept
+{
+    return { m_names + entry.NameOffset, entry.NameSize };
+}
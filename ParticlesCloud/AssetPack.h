@@ -0,0 +1,112 @@
+#ifndef _ASSETPACK_H_
+#define _ASSETPACK_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "MappedFile.h"
+
+// The files the viewer reads at startup packed into one archive that is mapped once. Find returns
+// the bytes of a file as a span into the mapping, so readers parse, decode or compile them in
+// place. Without a pack the same names are looked up as loose files below a directory, which is
+// what development builds use.
+//
+// File layout (little endian, every section 16-byte aligned):
+//   AssetPackHeader
+//   EntryType[EntryCount]   sorted by name
+//   char[NamesSize]         the names, relative paths with forward slashes, not terminated
+//   file contents           each starting on a 16-byte boundary
+// Offsets in the header and the entries are measured from the beginning of the file.
+class AssetPack
+{
+public:
+    static constexpr char s_Magic[4] = { 'P', 'C', 'A', 'P' };
+    static constexpr uint32_t s_Version = 1;
+    static constexpr uint32_t s_SectionAlignment = 16;
+
+    struct AssetPackHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t EntryCount;
+        uint32_t Reserved;
+        uint64_t EntriesOffset;
+        uint64_t NamesOffset;
+        uint64_t NamesSize;
+    };
+
+    struct EntryType
+    {
+        uint64_t NameOffset;
+        uint64_t NameSize;
+        uint64_t Offset;
+        uint64_t Size;
+    };
+
+    struct PackFile
+    {
+        std::string Name;
+        std::span<const std::byte> Data;
+    };
+
+public:
+    AssetPack();
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    //--------------------------------------------------------------------------------------
+    // Map and validate a pack, every entry is checked here so Find does not have to.
+    //--------------------------------------------------------------------------------------
+    bool Open(std::string_view filename);
+
+    //--------------------------------------------------------------------------------------
+    // Look files up as loose files below the directory instead, each one mapped on its first
+    // Find and kept mapped until Close.
+    //--------------------------------------------------------------------------------------
+    void OpenDirectory(std::string_view directory);
+    void Close() noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Bytes of the file with the given relative path, "./shaders/a.hlsl" and
+    // "shaders/a.hlsl" name the same file. Empty when there is no such file. Safe to call
+    // from several threads.
+    //--------------------------------------------------------------------------------------
+    std::span<const std::byte> Find(std::string_view name) const;
+
+    //--------------------------------------------------------------------------------------
+    // Write the files into a pack, sorted by their normalized names.
+    //--------------------------------------------------------------------------------------
+    bool Save(std::string_view filename, std::span<const PackFile> files);
+
+    bool IsPacked() const noexcept;
+    size_t GetEntryCount() const noexcept;
+    const std::string& GetErrorMessage() const noexcept;
+
+    static std::string NormalizeName(std::string_view name);
+
+private:
+    bool ValidateHeader(const AssetPackHeader& header, size_t fileSize);
+    bool ValidateEntries(const AssetPackHeader& header, size_t fileSize);
+    std::string_view GetName(const EntryType& entry) const noexcept;
+
+private:
+    MappedFile m_file;
+    const EntryType* m_entries;
+    size_t m_entryCount;
+    const char* m_names;
+
+    std::string m_directory;
+    mutable std::mutex m_looseMutex;
+    mutable std::unordered_map<std::string, std::unique_ptr<MappedFile>> m_looseFiles;
+
+    std::string m_errorMessage;
+};
+
+#endif
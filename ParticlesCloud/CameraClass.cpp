@@ -1,7 +1,13 @@
 #include "CameraClass.h"
 
+#include <algorithm>
+#include <cmath>
+
 void CameraClass::SetPosition(float x, float y, float z)
 {
+    // Only a change makes the cached matrices stale.
+    m_viewDirty |= x != m_positionX || y != m_positionY || z != m_positionZ;
+
     m_positionX = x;
     m_positionY = y;
     m_positionZ = z;
@@ -10,27 +16,63 @@ void CameraClass::SetPosition(float x, float y, float z)
 
 void CameraClass::SetRotation(float x, float y, float z)
 {
+    m_viewDirty |= x != m_rotationX || y != m_rotationY || z != m_rotationZ;
+
     m_rotationX = x;
     m_rotationY = y;
     m_rotationZ = z;
     return;
 }
 
-Vector3 CameraClass::GetPosition() const noexcept
+void CameraClass::SetProjection(const MathUtils::Float4x4& projection)
+{
+    m_projectionMatrix = projection;
+    m_projectionDirty = true;
+    return;
+}
+
+MathUtils::Float3 CameraClass::GetPosition() const noexcept
 {
     return { m_positionX, m_positionY, m_positionZ };
 }
 
-Vector3 CameraClass::GetRotation() const noexcept
+MathUtils::Float3 CameraClass::GetRotation() const noexcept
 {
     return { m_rotationX, m_rotationY, m_rotationZ };
 }
 
 void CameraClass::Render()
 {
-    Vector3 up, position, lookAt;
+    if (!m_viewDirty && !m_projectionDirty)
+    {
+        return;
+    }
+
+    if (m_viewDirty)
+    {
+        UpdateViewMatrix();
+    }
+
+    if (m_projectionDirty)
+    {
+        // A singular projection keeps the identity so unprojection stays finite.
+        m_inverseProjectionMatrix = MathUtils::Identity();
+        MathUtils::Invert(m_projectionMatrix, m_inverseProjectionMatrix);
+    }
+
+    UpdateViewProjection();
+
+    m_viewDirty = false;
+    m_projectionDirty = false;
+
+    return;
+}
+
+void CameraClass::UpdateViewMatrix() noexcept
+{
+    MathUtils::Float3 up, position, lookAt;
     float yaw, pitch, roll;
-    Matrix rotationMatrix;
+    MathUtils::Float4x4 rotationMatrix;
 
     // Setup the vector that points upwards.
     up.x = 0.0f;
@@ -49,28 +91,181 @@ void CameraClass::Render()
 
     // Set the yaw (Y axis), pitch (X axis), and roll (Z axis) rotations in
     // radians.
-    pitch = DirectX::XMConvertToRadians(m_rotationX);
-    yaw = DirectX::XMConvertToRadians(m_rotationY);
-    roll = DirectX::XMConvertToRadians(m_rotationZ);
+    pitch = MathUtils::ToRadians(m_rotationX);
+    yaw = MathUtils::ToRadians(m_rotationY);
+    roll = MathUtils::ToRadians(m_rotationZ);
 
     // Create the rotation matrix from the yaw, pitch, and roll values.
-    rotationMatrix = DirectX::XMMatrixRotationRollPitchYaw(pitch, yaw, roll);
+    rotationMatrix = MathUtils::RotationRollPitchYaw(pitch, yaw, roll);
 
     // Transform the lookAt and up vector by the rotation matrix so the view is
     // correctly rotated at the origin.
-    lookAt = DirectX::XMVector3TransformCoord(lookAt, rotationMatrix);
-    up = DirectX::XMVector3TransformCoord(up, rotationMatrix);
+    lookAt = MathUtils::TransformCoord(lookAt, rotationMatrix);
+    up = MathUtils::TransformCoord(up, rotationMatrix);
 
     // Translate the rotated camera position to the location of the viewer.
-    lookAt += position;
+    lookAt = { lookAt.x + position.x, lookAt.y + position.y, lookAt.z + position.z };
 
     // Finally create the view matrix from the three updated vectors.
-    m_viewMatrix = DirectX::XMMatrixLookAtLH(position, lookAt, up);
+    m_viewMatrix = MathUtils::LookAtLH(position, lookAt, up);
+
+    m_inverseViewMatrix = MathUtils::Identity();
+    MathUtils::Invert(m_viewMatrix, m_inverseViewMatrix);
 
     return;
 }
 
-const Matrix& CameraClass::GetViewMatrix() const noexcept
+void CameraClass::UpdateViewProjection() noexcept
+{
+    m_viewProjectionMatrix = MathUtils::Multiply(m_viewMatrix, m_projectionMatrix);
+
+    // The inverse of a product is the product of the inverses in reverse order, which saves a
+    // third inversion.
+    m_inverseViewProjectionMatrix = MathUtils::Multiply(m_inverseProjectionMatrix, m_inverseViewMatrix);
+
+    const auto& m = m_viewProjectionMatrix.m;
+
+    // Row vectors are transformed as clip = world * M, so every clip coordinate is the dot
+    // product of the point with a column of M. The frustum is -w <= x <= w, -w <= y <= w and
+    // 0 <= z <= w.
+    const auto column = [&m](int i) -> MathUtils::Float4 {
+        return { m[0][i], m[1][i], m[2][i], m[3][i] };
+    };
+    const auto add = [](const MathUtils::Float4& a, const MathUtils::Float4& b) -> MathUtils::Float4 {
+        return { a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w };
+    };
+    const auto subtract = [](const MathUtils::Float4& a, const MathUtils::Float4& b) -> MathUtils::Float4 {
+        return { a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w };
+    };
+
+    const MathUtils::Float4 x = column(0), y = column(1), z = column(2), w = column(3);
+
+    m_frustumPlanes[FrustumLeft] = add(w, x);
+    m_frustumPlanes[FrustumRight] = subtract(w, x);
+    m_frustumPlanes[FrustumBottom] = add(w, y);
+    m_frustumPlanes[FrustumTop] = subtract(w, y);
+    m_frustumPlanes[FrustumNear] = z;
+    m_frustumPlanes[FrustumFar] = subtract(w, z);
+
+    for (auto& plane : m_frustumPlanes)
+    {
+        const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        const float scale = length > 0.0f ? 1.0f / length : 0.0f;
+        plane = { plane.x * scale, plane.y * scale, plane.z * scale, plane.w * scale };
+    }
+
+    return;
+}
+
+const MathUtils::Float4x4& CameraClass::GetViewMatrix() const noexcept
 {
     return m_viewMatrix;
 }
+
+const MathUtils::Float4x4& CameraClass::GetInverseViewMatrix() const noexcept
+{
+    return m_inverseViewMatrix;
+}
+
+const MathUtils::Float4x4& CameraClass::GetProjectionMatrix() const noexcept
+{
+    return m_projectionMatrix;
+}
+
+const MathUtils::Float4x4& CameraClass::GetInverseProjectionMatrix() const noexcept
+{
+    return m_inverseProjectionMatrix;
+}
+
+const MathUtils::Float4x4& CameraClass::GetViewProjectionMatrix() const noexcept
+{
+    return m_viewProjectionMatrix;
+}
+
+const MathUtils::Float4x4& CameraClass::GetInverseViewProjectionMatrix() const noexcept
+{
+    return m_inverseViewProjectionMatrix;
+}
+
+const std::array<MathUtils::Float4, CameraClass::FrustumPlaneCount>& CameraClass::GetFrustumPlanes() const noexcept
+{
+    return m_frustumPlanes;
+}
+
+void CameraClass::UnprojectToRays(std::span<const MathUtils::Float2> points, std::span<Ray> rays) const noexcept
+{
+    const auto& m = m_inverseViewProjectionMatrix.m;
+    const size_t count = std::min(points.size(), rays.size());
+
+    // Straight line code over plain arrays, so the compiler can vectorize the loop across
+    // points. The near point is (x, y, 0, 1) and the far point (x, y, 1, 1), which share
+    // everything but the third row of the matrix.
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float x = points[i].x;
+        const float y = points[i].y;
+
+        const float nearX = x * m[0][0] + y * m[1][0] + m[3][0];
+        const float nearY = x * m[0][1] + y * m[1][1] + m[3][1];
+        const float nearZ = x * m[0][2] + y * m[1][2] + m[3][2];
+        const float nearW = x * m[0][3] + y * m[1][3] + m[3][3];
+
+        const float farX = nearX + m[2][0];
+        const float farY = nearY + m[2][1];
+        const float farZ = nearZ + m[2][2];
+        const float farW = nearW + m[2][3];
+
+        const float nearScale = 1.0f / nearW;
+        const float farScale = 1.0f / farW;
+
+        const MathUtils::Float3 origin = { nearX * nearScale, nearY * nearScale, nearZ * nearScale };
+        const MathUtils::Float3 direction = { farX * farScale - origin.x, farY * farScale - origin.y, farZ * farScale - origin.z };
+
+        const float lengthSquared = direction.x * direction.x + direction.y * direction.y + direction.z * direction.z;
+        const float directionScale = lengthSquared > 0.0f ? 1.0f / std::sqrt(lengthSquared) : 0.0f;
+
+        rays[i] = Ray{ origin, { direction.x * directionScale, direction.y * directionScale, direction.z * directionScale } };
+    }
+
+    return;
+}
+
+void CameraClass::UnprojectToPlane(
+    std::span<const MathUtils::Float2> points,
+    const MathUtils::Float4& plane,
+    std::span<MathUtils::Float3> positions) const noexcept
+{
+    const auto& m = m_inverseViewProjectionMatrix.m;
+    const size_t count = std::min(points.size(), positions.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float x = points[i].x;
+        const float y = points[i].y;
+
+        const float nearX = x * m[0][0] + y * m[1][0] + m[3][0];
+        const float nearY = x * m[0][1] + y * m[1][1] + m[3][1];
+        const float nearZ = x * m[0][2] + y * m[1][2] + m[3][2];
+        const float nearW = x * m[0][3] + y * m[1][3] + m[3][3];
+
+        const float nearScale = 1.0f / nearW;
+        const float farScale = 1.0f / (nearW + m[2][3]);
+
+        const float originX = nearX * nearScale;
+        const float originY = nearY * nearScale;
+        const float originZ = nearZ * nearScale;
+
+        // The direction does not need to be normalized for the intersection.
+        const float directionX = (nearX + m[2][0]) * farScale - originX;
+        const float directionY = (nearY + m[2][1]) * farScale - originY;
+        const float directionZ = (nearZ + m[2][2]) * farScale - originZ;
+
+        const float distance = plane.x * originX + plane.y * originY + plane.z * originZ + plane.w;
+        const float rate = plane.x * directionX + plane.y * directionY + plane.z * directionZ;
+        const float t = rate != 0.0f ? -distance / rate : 0.0f;
+
+        positions[i] = { originX + directionX * t, originY + directionY * t, originZ + directionZ * t };
+    }
+
+    return;
+}
@@ -1,21 +1,73 @@
 #ifndef _CAMERACLASS_H_
 #define _CAMERACLASS_H_
 
-#include <directxtk/SimpleMath.h>
+#include <array>
+#include <span>
 
-using namespace DirectX::SimpleMath;
+#include "MathUtils.h"
 
+// Keeps the view and projection of the camera together with their inverses, the view-projection
+// matrix and the frustum planes. Render only rebuilds what the last position, rotation or
+// projection change made stale, so a camera at rest costs nothing per frame.
 class CameraClass
 {
+public:
+    // Ray from the near plane towards the far plane, with a unit direction.
+    struct Ray
+    {
+        MathUtils::Float3 Origin;
+        MathUtils::Float3 Direction;
+    };
+
+    enum FrustumPlane
+    {
+        FrustumLeft,
+        FrustumRight,
+        FrustumBottom,
+        FrustumTop,
+        FrustumNear,
+        FrustumFar,
+        FrustumPlaneCount,
+    };
+
 public:
     void SetPosition(float x, float y, float z);
     void SetRotation(float x, float y, float z);
+    void SetProjection(const MathUtils::Float4x4& projection);
 
-    Vector3 GetPosition() const noexcept;
-    Vector3 GetRotation() const noexcept;
+    MathUtils::Float3 GetPosition() const noexcept;
+    MathUtils::Float3 GetRotation() const noexcept;
 
     void Render();
-    const Matrix& GetViewMatrix() const noexcept;
+
+    const MathUtils::Float4x4& GetViewMatrix() const noexcept;
+    const MathUtils::Float4x4& GetInverseViewMatrix() const noexcept;
+    const MathUtils::Float4x4& GetProjectionMatrix() const noexcept;
+    const MathUtils::Float4x4& GetInverseProjectionMatrix() const noexcept;
+    const MathUtils::Float4x4& GetViewProjectionMatrix() const noexcept;
+    const MathUtils::Float4x4& GetInverseViewProjectionMatrix() const noexcept;
+
+    // Normalized world space planes (a, b, c, d), a point is inside when ax + by + cz + d >= 0.
+    const std::array<MathUtils::Float4, FrustumPlaneCount>& GetFrustumPlanes() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Unproject points in normalized device coordinates to world space rays, all with the
+    // matrices cached by the last Render.
+    //--------------------------------------------------------------------------------------
+    void UnprojectToRays(std::span<const MathUtils::Float2> points, std::span<Ray> rays) const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Intersect the rays through points in normalized device coordinates with the world plane
+    // (a, b, c, d). A ray parallel to the plane gives its point on the near plane.
+    //--------------------------------------------------------------------------------------
+    void UnprojectToPlane(
+        std::span<const MathUtils::Float2> points,
+        const MathUtils::Float4& plane,
+        std::span<MathUtils::Float3> positions) const noexcept;
+
+private:
+    void UpdateViewMatrix() noexcept;
+    void UpdateViewProjection() noexcept;
 
 private:
     float m_positionX = 0.0f;
@@ -26,7 +78,17 @@ private:
     float m_rotationY = 0.0f;
     float m_rotationZ = 0.0f;
 
-    Matrix m_viewMatrix;
+    MathUtils::Float4x4 m_viewMatrix = MathUtils::Identity();
+    MathUtils::Float4x4 m_inverseViewMatrix = MathUtils::Identity();
+    MathUtils::Float4x4 m_projectionMatrix = MathUtils::Identity();
+    MathUtils::Float4x4 m_inverseProjectionMatrix = MathUtils::Identity();
+    MathUtils::Float4x4 m_viewProjectionMatrix = MathUtils::Identity();
+    MathUtils::Float4x4 m_inverseViewProjectionMatrix = MathUtils::Identity();
+    std::array<MathUtils::Float4, FrustumPlaneCount> m_frustumPlanes = {};
+
+    // The view matrix starts stale so the first Render builds it.
+    bool m_viewDirty = true;
+    bool m_projectionDirty = true;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,38 @@
+#include "Clock.h"
+
+#include <thread>
+
+namespace
+{
+    // Long enough to keep the error of the ratio in the parts per million.
+    constexpr uint64_t s_CalibrationNanoseconds = 20 * Clock::s_NanosecondsPerMillisecond;
+
+    double MeasureNanosecondsPerTick()
+    {
+#if defined(CLOCK_HAS_TSC)
+        const uint64_t startTime = Clock::Now();
+        const uint64_t startTicks = Clock::ReadTicks();
+
+        std::this_thread::sleep_for(std::chrono::nanoseconds(s_CalibrationNanoseconds));
+
+        const uint64_t endTicks = Clock::ReadTicks();
+        const uint64_t endTime = Clock::Now();
+
+        return endTicks > startTicks ? static_cast<double>(endTime - startTime) / static_cast<double>(endTicks - startTicks) : 1.0;
+#else
+        // Ticks are already nanoseconds.
+        return 1.0;
+#endif
+    }
+}
+
+void Clock::Calibrate()
+{
+    GetNanosecondsPerTick();
+}
+
+double Clock::GetNanosecondsPerTick()
+{
+    static const double s_NanosecondsPerTick = MeasureNanosecondsPerTick();
+    return s_NanosecondsPerTick;
+}
@@ -0,0 +1,75 @@
+#ifndef _CLOCK_H_
+#define _CLOCK_H_
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define CLOCK_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CLOCK_HAS_TSC 1
+#endif
+
+// The one time source of the application. Timestamps are integer nanoseconds of the monotonic
+// clock (QueryPerformanceCounter on Windows, CLOCK_MONOTONIC on Linux), so intervals measured
+// by different subsystems and threads can be compared directly.
+//
+// Profiling zones read raw ticks instead: the time stamp counter on x86, which costs a few
+// cycles, and the monotonic clock elsewhere. Ticks are converted to nanoseconds with a ratio
+// calibrated against the monotonic clock.
+namespace Clock
+{
+    constexpr uint64_t s_NanosecondsPerMicrosecond = 1000;
+    constexpr uint64_t s_NanosecondsPerMillisecond = 1000 * 1000;
+    constexpr uint64_t s_NanosecondsPerSecond = 1000 * 1000 * 1000;
+
+    //--------------------------------------------------------------------------------------
+    // Monotonic timestamp in nanoseconds.
+    //--------------------------------------------------------------------------------------
+    inline uint64_t Now() noexcept
+    {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Raw tick counter for hot paths. Only differences of ticks are meaningful.
+    //--------------------------------------------------------------------------------------
+    inline uint64_t ReadTicks() noexcept
+    {
+#if defined(CLOCK_HAS_TSC)
+        return __rdtsc();
+#else
+        return Now();
+#endif
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Measure the tick rate against the monotonic clock. Runs once, the first conversion
+    // calls it if the application did not, which blocks for a few milliseconds.
+    //--------------------------------------------------------------------------------------
+    void Calibrate();
+    double GetNanosecondsPerTick();
+
+    inline uint64_t TicksToNanoseconds(uint64_t ticks)
+    {
+        return static_cast<uint64_t>(static_cast<double>(ticks) * GetNanosecondsPerTick());
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Conversions of nanosecond intervals for reporting.
+    //--------------------------------------------------------------------------------------
+    constexpr float ToMilliseconds(uint64_t nanoseconds) noexcept
+    {
+        return static_cast<float>(static_cast<double>(nanoseconds) / static_cast<double>(s_NanosecondsPerMillisecond));
+    }
+
+    constexpr double ToSeconds(uint64_t nanoseconds) noexcept
+    {
+        return static_cast<double>(nanoseconds) / static_cast<double>(s_NanosecondsPerSecond);
+    }
+};
+
+#endif
@@ -1,68 +1,186 @@
 #include "CpuClass.h"
 
-void CpuClass::Initialize()
-{
-    PDH_STATUS status;
+#include <algorithm>
+#include <chrono>
 
-    // Initialize the flag indicating whether this object can read the system cpu usage or not.
-    m_canReadCpu = true;
+#include "Clock.h"
+#include "Profiler.h"
 
-    // Create a query object to poll cpu usage.
-    status = PdhOpenQuery(NULL, 0, &m_queryHandle);
-    if (status != ERROR_SUCCESS)
+namespace
+{
+    float ToPercentage(uint64_t busy, double available) noexcept
     {
-        m_canReadCpu = false;
+        return available > 0.0 ? static_cast<float>(std::min(100.0 * static_cast<double>(busy) / available, 100.0)) : 0.0f;
     }
 
-    // Set query object to poll all cpus in the system.
-    status = PdhAddCounter(m_queryHandle, TEXT("\\Processor(_Total)\\% processor time"), 0, &m_counterHandle);
-    if (status != ERROR_SUCCESS)
+    // A recycled thread id can report less time than the thread it replaced.
+    float ToPercentage(uint64_t time, uint64_t lastTime, double available) noexcept
     {
-        m_canReadCpu = false;
+        return time >= lastTime ? ToPercentage(time - lastTime, available) : 0.0f;
     }
+}
+
+CpuClass::CpuClass()
+    : m_middle(1)
+    , m_back(0)
+    , m_front(2)
+    , m_stop(false)
+    , m_mainThreadId(0)
+    , m_lastSampleTime(0)
+    , m_lastProcessTime(0)
+    , m_systemPercentage(0.0f)
+{
+}
+
+CpuClass::~CpuClass()
+{
+    Shutdown();
+}
+
+void CpuClass::Initialize()
+{
+    CpuSnapshot scratch;
+
+    // The thread that initializes the object is the render thread, it is reported separately.
+    m_mainThreadId = Platform::GetCurrentThreadId();
+    m_stop = false;
+
+    // Machine figures stay at zero if the counters are not available.
+    m_systemCounters.Open();
 
-    //m_lastSampleTime = GetTickCount64();
-    m_lastSampleTime = std::chrono::system_clock::now();
+    // Take the first sample now, usage is the difference between two samples.
+    m_lastSampleTime = Clock::Now();
+    Sample(scratch);
 
-    m_cpuUsage = 0;
+    m_thread = std::thread(&CpuClass::SamplerThread, this);
 
     return;
 }
 
 void CpuClass::Shutdown()
 {
-    if (m_canReadCpu)
+    // Wake up and join the sampler thread.
+    if (m_thread.joinable())
     {
-        PdhCloseQuery(m_queryHandle);
+        {
+            std::lock_guard lock{ m_mutex };
+            m_stop = true;
+        }
+
+        m_stopCondition.notify_all();
+        m_thread.join();
     }
 
+    m_systemCounters.Close();
+
     return;
 }
 
-void CpuClass::Frame()
+void CpuClass::Frame() noexcept
 {
-    if (!m_canReadCpu)
+    // Swap in the newest snapshot if the sampler published one since the last frame.
+    if (m_middle.load(std::memory_order_relaxed) & s_FreshBit)
     {
-        return;
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & ~s_FreshBit;
     }
 
-    if ((m_lastSampleTime + std::chrono::seconds(1)) < std::chrono::system_clock::now())
+    return;
+}
+
+int CpuClass::GetCpuPercentage() const noexcept
+{
+    return static_cast<int>(GetSnapshot().SystemPercentage + 0.5f);
+}
+
+int CpuClass::GetProcessCpuPercentage() const noexcept
+{
+    return static_cast<int>(GetSnapshot().ProcessPercentage + 0.5f);
+}
+
+const CpuSnapshot& CpuClass::GetSnapshot() const noexcept
+{
+    return m_snapshots[m_front];
+}
+
+void CpuClass::SamplerThread()
+{
+    uint64_t sampleIndex = 0;
+
+    Profiler::SetThreadName("CpuSampler");
+    Platform::LowerCurrentThreadPriority();
+
+    std::unique_lock lock{ m_mutex };
+
+    while (!m_stopCondition.wait_for(lock, std::chrono::seconds(1), [this]() { return m_stop; }))
     {
-        m_lastSampleTime = std::chrono::system_clock::now();
+        lock.unlock();
 
-        PdhCollectQueryData(m_queryHandle);
+        {
+            PROFILE_ZONE("CpuSample");
 
-        PDH_FMT_COUNTERVALUE value;
-        PdhGetFormattedCounterValue(m_counterHandle, PDH_FMT_LONG, nullptr, &value);
+            auto& snapshot = m_snapshots[m_back];
+            Sample(snapshot);
+            snapshot.SampleIndex = ++sampleIndex;
 
-        m_cpuUsage = value.longValue;
-    }
+            // Publish the snapshot and take the buffer the reader released.
+            m_back = m_middle.exchange(m_back | s_FreshBit, std::memory_order_acq_rel) & ~s_FreshBit;
+        }
 
-    return;
+        lock.lock();
+    }
 }
 
-int CpuClass::GetCpuPercentage() const noexcept
+void CpuClass::Sample(CpuSnapshot& snapshot)
 {
-    return m_canReadCpu ? static_cast<int>(m_cpuUsage) : 0;
+    const uint64_t now = Clock::Now();
+    const double elapsedSeconds = Clock::ToSeconds(now - m_lastSampleTime);
+    const auto hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    m_lastSampleTime = now;
+
+    // The snapshots rotate through the triple buffer, so the machine figures are kept here and
+    // copied into every snapshot. They keep their last values if the counters are not available.
+    m_systemCounters.Sample(m_systemPercentage, m_corePercentages);
+
+    snapshot.SystemPercentage = m_systemPercentage;
+    snapshot.CoreCount = static_cast<uint32_t>(std::min(m_corePercentages.size(), CpuSnapshot::s_MaxCores));
+    std::copy_n(m_corePercentages.begin(), snapshot.CoreCount, snapshot.CorePercentages.begin());
+
+    const uint64_t processTime = Platform::GetProcessCpuTime();
+    snapshot.ProcessPercentage = ToPercentage(processTime, m_lastProcessTime, elapsedSeconds * 1e9 * hardwareThreads);
+    m_lastProcessTime = processTime;
+
+    SampleThreads(snapshot, elapsedSeconds);
 }
 
+void CpuClass::SampleThreads(CpuSnapshot& snapshot, double elapsedSeconds)
+{
+    std::vector<CpuThreadUsage> threads;
+    std::unordered_map<uint64_t, uint64_t> threadTimes;
+
+    if (!Platform::EnumerateThreadTimes(m_threadTimes))
+    {
+        return;
+    }
+
+    for (const auto& times : m_threadTimes)
+    {
+        CpuThreadUsage usage;
+        const auto last = m_lastThreadTimes.find(times.Id);
+
+        usage.Id = times.Id;
+        usage.IsMainThread = times.Id == m_mainThreadId;
+        usage.Percentage = last != m_lastThreadTimes.end() ? ToPercentage(times.Time, last->second, elapsedSeconds * 1e9) : 0.0f;
+        std::copy(std::begin(times.Name), std::end(times.Name), usage.Name);
+
+        threads.push_back(usage);
+        threadTimes[times.Id] = times.Time;
+    }
+
+    // Keep the busiest threads.
+    std::sort(threads.begin(), threads.end(), [](const auto& a, const auto& b) { return a.Percentage > b.Percentage; });
+
+    snapshot.ThreadCount = static_cast<uint32_t>(std::min(threads.size(), CpuSnapshot::s_MaxThreads));
+    std::copy_n(threads.begin(), snapshot.ThreadCount, snapshot.Threads.begin());
+
+    m_lastThreadTimes = std::move(threadTimes);
+}
@@ -1,24 +1,93 @@
 #ifndef _CPUCLASS_H_
 #define _CPUCLASS_H_
 
-#include <chrono>
-#include <pdh.h>
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
+#include "Platform.h"
+
+// CPU time of one thread of this process over the last sample, in percent of one core.
+struct CpuThreadUsage
+{
+    uint64_t Id = 0;
+    char Name[16] = {};
+    float Percentage = 0.0f;
+    bool IsMainThread = false;
+};
+
+// One sample of the machine and process CPU usage. Machine and process figures are in percent of
+// all cores, so 100 means every core was busy.
+struct CpuSnapshot
+{
+    static constexpr size_t s_MaxCores = 256;
+    static constexpr size_t s_MaxThreads = 32;
+
+    uint64_t SampleIndex = 0;
+    float SystemPercentage = 0.0f;
+    float ProcessPercentage = 0.0f;
+
+    uint32_t CoreCount = 0;
+    std::array<float, s_MaxCores> CorePercentages = {};
+
+    // The busiest threads first.
+    uint32_t ThreadCount = 0;
+    std::array<CpuThreadUsage, s_MaxThreads> Threads = {};
+};
+
+// Samples the machine, process and thread CPU usage through the platform layer once per second on
+// its own low priority thread. Snapshots are handed to the thread
+// that calls Frame through a lock-free triple buffer.
 class CpuClass
 {
 public:
+    CpuClass();
+    CpuClass(const CpuClass&) = delete;
+    CpuClass& operator=(const CpuClass&) = delete;
+    ~CpuClass();
+
     void Initialize();
     void Shutdown();
-    void Frame();
+    void Frame() noexcept;
+
     int GetCpuPercentage() const noexcept;
+    int GetProcessCpuPercentage() const noexcept;
+    const CpuSnapshot& GetSnapshot() const noexcept;
 
 private:
-    bool m_canReadCpu;
-    HQUERY m_queryHandle;
-    HCOUNTER m_counterHandle;
+    void SamplerThread();
+    void Sample(CpuSnapshot& snapshot);
+    void SampleThreads(CpuSnapshot& snapshot, double elapsedSeconds);
+
+private:
+    // Triple buffer: the sampler fills m_back, the reader owns m_front and the two swap through
+    // m_middle, whose s_FreshBit tells the reader that a newer snapshot is waiting.
+    static constexpr uint32_t s_FreshBit = 4;
+
+    std::array<CpuSnapshot, 3> m_snapshots;
+    std::atomic<uint32_t> m_middle;
+    uint32_t m_back;
+    uint32_t m_front;
+
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_stopCondition;
+    bool m_stop;
+    uint64_t m_mainThreadId;
 
-    std::chrono::system_clock::time_point m_lastSampleTime; 
-    long m_cpuUsage;
+    // Previous counter values, only touched by the sampler thread.
+    Platform::SystemCpuCounters m_systemCounters;
+    uint64_t m_lastSampleTime;
+    uint64_t m_lastProcessTime;
+    float m_systemPercentage;
+    std::vector<float> m_corePercentages;
+    std::vector<Platform::ThreadTimes> m_threadTimes;
+    std::unordered_map<uint64_t, uint64_t> m_lastThreadTimes;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -481,6 +481,11 @@ void D3DClass::EndScene()
     return;
 }
 
+void D3DClass::SetVSync(bool enabled) noexcept
+{
+    m_vsync_enabled = enabled;
+}
+
 ID3D11Device* D3DClass::GetDevice() noexcept
 {
     return m_device;
@@ -21,6 +21,8 @@ public:
     void BeginScene(float, float, float, float);
     void EndScene();
 
+    void SetVSync(bool enabled) noexcept;
+
     ID3D11Device* GetDevice() noexcept;
     ID3D11DeviceContext* GetDeviceContext() noexcept;
 
@@ -1,12 +1,23 @@
 #include "DirectXUtils.h"
 
-HRESULT DirectXUtils::CreateStructuredBuffer(ID3D11Device* pDevice, UINT uElementSize, UINT uCount, void* pInitData, ID3D11Buffer** ppBufOut)
+#include <climits>
+#include <string>
+#include <vector>
+
+HRESULT DirectXUtils::CreateStructuredBuffer(ID3D11Device* pDevice, UINT uElementSize, size_t uCount, void* pInitData, ID3D11Buffer** ppBufOut)
 {
     *ppBufOut = nullptr;
 
+    // Size the buffer in 64 bits, a size that wraps around would create a smaller buffer.
+    const uint64_t byteWidth = uint64_t{ uElementSize } * uCount;
+    if (byteWidth > UINT_MAX)
+    {
+        return E_INVALIDARG;
+    }
+
     D3D11_BUFFER_DESC desc{};
     desc.BindFlags = D3D11_BIND_UNORDERED_ACCESS | D3D11_BIND_SHADER_RESOURCE;
-    desc.ByteWidth = uElementSize * uCount;
+    desc.ByteWidth = static_cast<UINT>(byteWidth);
     desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
     desc.StructureByteStride = uElementSize;
 
@@ -22,6 +33,61 @@ HRESULT DirectXUtils::CreateStructuredBuffer(ID3D11Device* pDevice, UINT uElemen
     }
 }
 
+void DirectXUtils::UpdateBufferRange(
+    ID3D11DeviceContext* pContext,
+    ID3D11Buffer* pBuffer,
+    UINT uElementSize,
+    size_t uFirst,
+    size_t uCount,
+    const void* pData)
+{
+    if (uCount == 0)
+    {
+        return;
+    }
+
+    // Buffers are addressed in bytes along the x axis of the box. The range lies in a buffer
+    // of at most 2 GB, so once computed in 64 bits it fits the UINT of the box.
+    const uint64_t left = uint64_t{ uElementSize } * uFirst;
+    const uint64_t right = left + uint64_t{ uElementSize } * uCount;
+
+    D3D11_BOX box{};
+    box.left = static_cast<UINT>(left);
+    box.right = static_cast<UINT>(right);
+    box.bottom = 1;
+    box.back = 1;
+
+    pContext->UpdateSubresource(pBuffer, 0, &box, pData, 0, 0);
+}
+
+uint64_t DirectXUtils::GetMaxBufferSize(ID3D11Device* pDevice)
+{
+    constexpr uint64_t megabyte = 1024 * 1024;
+    constexpr uint64_t minimumSize = D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_A_TERM * megabyte;
+    constexpr uint64_t maximumSize = D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_C_TERM * megabyte;
+
+    IDXGIDevice* dxgiDevice = nullptr;
+    IDXGIAdapter* adapter = nullptr;
+    DXGI_ADAPTER_DESC adapterDesc{};
+
+    // Without the adapter description only the guaranteed minimum is known.
+    if (SUCCEEDED(pDevice->QueryInterface(__uuidof(IDXGIDevice), reinterpret_cast<void**>(&dxgiDevice))) &&
+        SUCCEEDED(dxgiDevice->GetAdapter(&adapter)))
+    {
+        adapter->GetDesc(&adapterDesc);
+    }
+
+    SafeRelease(adapter);
+    SafeRelease(dxgiDevice);
+
+    // The resource size limit of D3D11: max(A, min(B * dedicated video memory, C)).
+    const auto dedicatedSize = static_cast<uint64_t>(
+        adapterDesc.DedicatedVideoMemory * D3D11_REQ_RESOURCE_SIZE_IN_MEGABYTES_EXPRESSION_B_TERM);
+    const uint64_t size = dedicatedSize < maximumSize ? dedicatedSize : maximumSize;
+
+    return size > minimumSize ? size : minimumSize;
+}
+
 HRESULT DirectXUtils::CreateDynamicConstantBuffer(ID3D11Device* pDevice, UINT uElementSize, ID3D11Buffer** ppBufOut)
 {
     D3D11_BUFFER_DESC desc{};
@@ -61,4 +127,73 @@ HRESULT DirectXUtils::CreateBufferUAV(ID3D11Device* pDevice, ID3D11Buffer* pBuff
     desc.Buffer.NumElements = descBuf.ByteWidth / descBuf.StructureByteStride;
 
     return pDevice->CreateUnorderedAccessView(pBuffer, &desc, ppUAVOut);
-}
\ No newline at end of file
+}
+
+HRESULT DirectXUtils::CompileShader(
+    ShaderCache& shaders,
+    std::wstring_view filename,
+    LPCSTR entryPoint,
+    LPCSTR target,
+    UINT flags,
+    ID3DBlob** ppCode,
+    ID3DBlob** ppErrors)
+{
+    std::vector<std::byte> bytecode;
+    std::string errors;
+    HRESULT result;
+
+    *ppCode = nullptr;
+    if (ppErrors)
+    {
+        *ppErrors = nullptr;
+    }
+
+    // Shader names are plain ASCII paths.
+    const std::string name(filename.begin(), filename.end());
+
+    if (!shaders.GetBytecode({ name, entryPoint, target, flags }, bytecode, errors))
+    {
+        if (errors.empty())
+        {
+            return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+        }
+
+        // Hand the errors over in a blob like D3DCompile does.
+        if (ppErrors && SUCCEEDED(D3DCreateBlob(errors.size() + 1, ppErrors)))
+        {
+            std::memcpy((*ppErrors)->GetBufferPointer(), errors.c_str(), errors.size() + 1);
+        }
+
+        return E_FAIL;
+    }
+
+    result = D3DCreateBlob(bytecode.size(), ppCode);
+    if (FAILED(result))
+    {
+        return result;
+    }
+
+    std::memcpy((*ppCode)->GetBufferPointer(), bytecode.data(), bytecode.size());
+
+    return S_OK;
+}
+
+void DirectXUtils::TrackBuffer(ID3D11Buffer* pBuffer, MemoryTracker::Tag tag)
+{
+    if (pBuffer)
+    {
+        D3D11_BUFFER_DESC desc;
+        pBuffer->GetDesc(&desc);
+        MemoryTracker::OnAllocate(tag, desc.ByteWidth);
+    }
+}
+
+void DirectXUtils::UntrackBuffer(ID3D11Buffer* pBuffer, MemoryTracker::Tag tag)
+{
+    if (pBuffer)
+    {
+        D3D11_BUFFER_DESC desc;
+        pBuffer->GetDesc(&desc);
+        MemoryTracker::OnFree(tag, desc.ByteWidth);
+    }
+}
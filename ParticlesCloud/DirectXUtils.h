@@ -2,20 +2,37 @@
 
 #include <windows.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
 #include <d3d11.h>
+#include <d3dcompiler.h>
+#include <directxtk/SimpleMath.h>
+
+#include "MathUtils.h"
+#include "MemoryTracker.h"
+#include "ShaderCache.h"
 
 namespace DirectXUtils
 {
     //--------------------------------------------------------------------------------------
-    // Create Structured Buffers
+    // Create Structured Buffers, fails with E_INVALIDARG when the size does not fit a UINT
     //--------------------------------------------------------------------------------------
     HRESULT CreateStructuredBuffer(
         _In_ ID3D11Device* pDevice,
         _In_ UINT uElementSize,
-        _In_ UINT uCount,
+        _In_ size_t uCount,
         _In_reads_(uElementSize* uCount) void* pInitData,
         _Outptr_ ID3D11Buffer** ppBufOut);
 
+    //--------------------------------------------------------------------------------------
+    // Largest buffer the device can create in bytes: a quarter of the dedicated video
+    // memory, at least 128 MB and at most 2 GB
+    //--------------------------------------------------------------------------------------
+    uint64_t GetMaxBufferSize(_In_ ID3D11Device* pDevice);
+
     //--------------------------------------------------------------------------------------
     // Create Dynamic Constant Buffer
     //--------------------------------------------------------------------------------------
@@ -34,6 +51,55 @@ namespace DirectXUtils
     //--------------------------------------------------------------------------------------
     HRESULT CreateBufferUAV(_In_ ID3D11Device* pDevice, _In_ ID3D11Buffer* pBuffer, _Outptr_ ID3D11UnorderedAccessView** pUAVOut);
 
+    //--------------------------------------------------------------------------------------
+    // Copy uCount elements into a default usage buffer, starting at element uFirst
+    //--------------------------------------------------------------------------------------
+    void UpdateBufferRange(
+        _In_ ID3D11DeviceContext* pContext,
+        _In_ ID3D11Buffer* pBuffer,
+        _In_ UINT uElementSize,
+        _In_ size_t uFirst,
+        _In_ size_t uCount,
+        _In_reads_(uElementSize* uCount) const void* pData);
+
+    //--------------------------------------------------------------------------------------
+    // Get the bytecode of a shader from the shader cache, compiled from its source in the
+    // asset pack on a miss. Fails without an error message when the pack has no such file.
+    //--------------------------------------------------------------------------------------
+    HRESULT CompileShader(
+        ShaderCache& shaders,
+        std::wstring_view filename,
+        _In_ LPCSTR entryPoint,
+        _In_ LPCSTR target,
+        UINT flags,
+        _Outptr_ ID3DBlob** ppCode,
+        _Outptr_opt_ ID3DBlob** ppErrors);
+
+    //--------------------------------------------------------------------------------------
+    // Report the size of a buffer to the memory tracker after creation and before release
+    //--------------------------------------------------------------------------------------
+    void TrackBuffer(_In_opt_ ID3D11Buffer* pBuffer, MemoryTracker::Tag tag);
+    void UntrackBuffer(_In_opt_ ID3D11Buffer* pBuffer, MemoryTracker::Tag tag);
+
+    //--------------------------------------------------------------------------------------
+    // Convert between the portable and the SimpleMath matrices, both are row major.
+    //--------------------------------------------------------------------------------------
+    inline DirectX::SimpleMath::Matrix ToMatrix(const MathUtils::Float4x4& matrix) noexcept
+    {
+        DirectX::SimpleMath::Matrix result;
+        static_assert(sizeof(result) == sizeof(matrix));
+        std::memcpy(&result, &matrix, sizeof(result));
+        return result;
+    }
+
+    inline MathUtils::Float4x4 ToFloat4x4(const DirectX::SimpleMath::Matrix& matrix) noexcept
+    {
+        MathUtils::Float4x4 result;
+        static_assert(sizeof(result) == sizeof(matrix));
+        std::memcpy(&result, &matrix, sizeof(result));
+        return result;
+    }
+
     //--------------------------------------------------------------------------------------
     // Release allocated resource.
     //--------------------------------------------------------------------------------------
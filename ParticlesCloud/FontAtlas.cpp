@@ -0,0 +1,230 @@
+#include "FontAtlas.h"
+
+#include <cstring>
+#include <fstream>
+#include <type_traits>
+
+// The glyph table is copied in and out of the file as raw bytes.
+static_assert(std::is_trivially_copyable_v<FontLayout::GlyphType>);
+static_assert(sizeof(FontLayout::GlyphType) % alignof(FontLayout::GlyphType) == 0);
+
+namespace
+{
+    uint64_t AlignSection(uint64_t offset) noexcept
+    {
+        return (offset + FontAtlas::s_SectionAlignment - 1) / FontAtlas::s_SectionAlignment * FontAtlas::s_SectionAlignment;
+    }
+}
+
+FontAtlas::FontAtlas()
+    : m_header{}
+{
+}
+
+bool FontAtlas::Load(std::string_view filename)
+{
+    m_errorMessage.clear();
+    Close();
+
+    // Map the whole file, the glyphs and the texels are used straight from the mapping.
+    if (!m_file.Open(filename))
+    {
+        m_errorMessage = "Could not open the font atlas file.";
+        return false;
+    }
+
+    return LoadData({ m_file.GetData(), m_file.GetSize() });
+}
+
+bool FontAtlas::Load(std::span<const std::byte> data)
+{
+    m_errorMessage.clear();
+    Close();
+
+    return LoadData(data);
+}
+
+void FontAtlas::Close() noexcept
+{
+    m_file.Close();
+    m_data = {};
+    m_header = {};
+}
+
+bool FontAtlas::Save(
+    std::string_view filename,
+    const FontLayout& layout,
+    uint32_t textureWidth,
+    uint32_t textureHeight,
+    std::span<const uint8_t> texels)
+{
+    const auto glyphs = layout.GetGlyphs();
+    FontAtlasHeader header{};
+
+    m_errorMessage.clear();
+
+    if (texels.size() != uint64_t{ textureWidth } * textureHeight * s_BytesPerTexel)
+    {
+        m_errorMessage = "The texels do not match the size of the font texture.";
+        return false;
+    }
+
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.GlyphCount = static_cast<uint32_t>(glyphs.size());
+    header.GlyphSize = sizeof(FontLayout::GlyphType);
+    header.LineHeight = layout.GetLineHeight();
+    header.TextureWidth = textureWidth;
+    header.TextureHeight = textureHeight;
+    header.TexturePitch = textureWidth * s_BytesPerTexel;
+    header.GlyphsOffset = AlignSection(sizeof(FontAtlasHeader));
+    header.TextureOffset = AlignSection(header.GlyphsOffset + glyphs.size_bytes());
+
+    std::ofstream fout{ std::string(filename), std::ios::binary };
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not create the font atlas file.";
+        return false;
+    }
+
+    // Pad every section to its aligned offset.
+    const char padding[s_SectionAlignment] = {};
+
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(padding, static_cast<std::streamsize>(header.GlyphsOffset - sizeof(header)));
+    fout.write(reinterpret_cast<const char*>(glyphs.data()), static_cast<std::streamsize>(glyphs.size_bytes()));
+    fout.write(padding, static_cast<std::streamsize>(header.TextureOffset - header.GlyphsOffset - glyphs.size_bytes()));
+    fout.write(reinterpret_cast<const char*>(texels.data()), static_cast<std::streamsize>(texels.size()));
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not write the font atlas file.";
+        return false;
+    }
+
+    return true;
+}
+
+std::span<const FontLayout::GlyphType> FontAtlas::GetGlyphs() const noexcept
+{
+    if (m_data.empty())
+    {
+        return {};
+    }
+
+    return { reinterpret_cast<const FontLayout::GlyphType*>(m_data.data() + m_header.GlyphsOffset), m_header.GlyphCount };
+}
+
+float FontAtlas::GetLineHeight() const noexcept
+{
+    return m_header.LineHeight;
+}
+
+uint32_t FontAtlas::GetTextureWidth() const noexcept
+{
+    return m_header.TextureWidth;
+}
+
+uint32_t FontAtlas::GetTextureHeight() const noexcept
+{
+    return m_header.TextureHeight;
+}
+
+uint32_t FontAtlas::GetTexturePitch() const noexcept
+{
+    return m_header.TexturePitch;
+}
+
+const std::byte* FontAtlas::GetTexels() const noexcept
+{
+    return m_data.empty() ? nullptr : m_data.data() + m_header.TextureOffset;
+}
+
+const std::string& FontAtlas::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
+
+bool FontAtlas::LoadData(std::span<const std::byte> data)
+{
+    FontAtlasHeader header;
+
+    if (data.size() < sizeof(FontAtlasHeader))
+    {
+        m_errorMessage = "The font atlas file is too small to hold a header.";
+        Close();
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(FontAtlasHeader));
+
+    // The glyph table is read in place, its entries hold floats.
+    if (reinterpret_cast<uintptr_t>(data.data()) % alignof(FontLayout::GlyphType) != 0)
+    {
+        m_errorMessage = "The font atlas data is misaligned.";
+        Close();
+        return false;
+    }
+
+    if (!ValidateHeader(header, data.size()))
+    {
+        Close();
+        return false;
+    }
+
+    m_data = data;
+    m_header = header;
+
+    return true;
+}
+
+bool FontAtlas::ValidateHeader(const FontAtlasHeader& header, size_t fileSize)
+{
+    if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0)
+    {
+        m_errorMessage = "The file is not a font atlas.";
+        return false;
+    }
+
+    if (header.Version != s_Version)
+    {
+        m_errorMessage = "Unsupported font atlas version.";
+        return false;
+    }
+
+    // The glyphs are used in place, so they must have been baked with the same glyph layout.
+    if (header.GlyphCount != FontLayout::s_GlyphTableSize || header.GlyphSize != sizeof(FontLayout::GlyphType))
+    {
+        m_errorMessage = "The font atlas was baked with a different glyph table.";
+        return false;
+    }
+
+    if (header.TextureWidth == 0 || header.TextureHeight == 0 ||
+        header.TexturePitch < uint64_t{ header.TextureWidth } * s_BytesPerTexel)
+    {
+        m_errorMessage = "The font atlas has an invalid texture size.";
+        return false;
+    }
+
+    bool result = ValidateSection(header.GlyphsOffset, uint64_t{ header.GlyphCount } * header.GlyphSize, fileSize);
+    result = result && ValidateSection(header.TextureOffset, uint64_t{ header.TextureHeight } * header.TexturePitch, fileSize);
+
+    return result;
+}
+
+bool FontAtlas::ValidateSection(uint64_t offset, uint64_t size, size_t fileSize)
+{
+    if (offset < sizeof(FontAtlasHeader) || offset % s_SectionAlignment != 0)
+    {
+        m_errorMessage = "The font atlas file has a misplaced section.";
+        return false;
+    }
+
+    if (offset > fileSize || size > fileSize - offset)
+    {
+        m_errorMessage = "The font atlas file is truncated.";
+        return false;
+    }
+
+    return true;
+}
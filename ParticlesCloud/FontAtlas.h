@@ -0,0 +1,90 @@
+#ifndef _FONTATLAS_H_
+#define _FONTATLAS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "FontLayout.h"
+#include "MappedFile.h"
+
+// A font baked offline into one file: the glyph table of FontLayout, with the quads relative to
+// the pen and the UVs already normalized, and the texels of the texture. Loading maps the file
+// and hands out pointers into the mapping, nothing is parsed or decoded.
+//
+// File layout (little endian, every section 16-byte aligned):
+//   FontAtlasHeader
+//   FontLayout::GlyphType[GlyphCount]       indexed by character code
+//   uint8_t[TextureHeight * TexturePitch]   RGBA8 texels, rows from top to bottom
+// Offsets in the header are measured from the beginning of the file.
+class FontAtlas
+{
+public:
+    static constexpr char s_Magic[4] = { 'P', 'C', 'F', 'A' };
+    static constexpr uint32_t s_Version = 1;
+    static constexpr uint32_t s_SectionAlignment = 16;
+    static constexpr uint32_t s_BytesPerTexel = 4;
+
+    struct FontAtlasHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t GlyphCount;
+        uint32_t GlyphSize;
+        float LineHeight;
+        uint32_t TextureWidth;
+        uint32_t TextureHeight;
+        uint32_t TexturePitch;
+        uint64_t GlyphsOffset;
+        uint64_t TextureOffset;
+    };
+
+public:
+    FontAtlas();
+
+    //--------------------------------------------------------------------------------------
+    // Map and validate a baked atlas. The glyphs and texels stay valid until Close or the
+    // next Load.
+    //--------------------------------------------------------------------------------------
+    bool Load(std::string_view filename);
+
+    //--------------------------------------------------------------------------------------
+    // Validate an atlas that is already in memory, for example in an asset pack. The glyphs
+    // and texels point into the data, which has to outlive their use.
+    //--------------------------------------------------------------------------------------
+    bool Load(std::span<const std::byte> data);
+    void Close() noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Bake the glyph table of a font and its RGBA8 texels into an atlas file.
+    //--------------------------------------------------------------------------------------
+    bool Save(
+        std::string_view filename,
+        const FontLayout& layout,
+        uint32_t textureWidth,
+        uint32_t textureHeight,
+        std::span<const uint8_t> texels);
+
+    std::span<const FontLayout::GlyphType> GetGlyphs() const noexcept;
+    float GetLineHeight() const noexcept;
+    uint32_t GetTextureWidth() const noexcept;
+    uint32_t GetTextureHeight() const noexcept;
+    uint32_t GetTexturePitch() const noexcept;
+    const std::byte* GetTexels() const noexcept;
+    const std::string& GetErrorMessage() const noexcept;
+
+private:
+    bool LoadData(std::span<const std::byte> data);
+    bool ValidateHeader(const FontAtlasHeader& header, size_t fileSize);
+    bool ValidateSection(uint64_t offset, uint64_t size, size_t fileSize);
+
+private:
+    MappedFile m_file;
+    std::span<const std::byte> m_data;
+    FontAtlasHeader m_header;
+    std::string m_errorMessage;
+};
+
+#endif
@@ -4,48 +4,37 @@
 #include <d3d11.h>
 #include <directxtk/SimpleMath.h>
 #include <memory>
-#include <vector>
 
+#include "AssetPack.h"
+#include "FontAtlas.h"
+#include "FontLayout.h"
 #include "TextureClass.h"
 
 using namespace DirectX::SimpleMath;
 
 class FontClass
 {
-private:
-    struct FontType
-    {
-        float left, right;
-        int size;
-    };
-
-    struct VertexType
-    {
-        Vector4 position;
-        Vector2 texture;
-    };
-
 public:
     FontClass();
     FontClass(const FontClass&);
     ~FontClass();
 
-    bool Initialize(ID3D11Device* device, std::string_view fontFilename, std::wstring_view textureFilename);
+    //--------------------------------------------------------------------------------------
+    // Load the glyphs and the texture from an atlas baked by particles_fontbake. The glyphs
+    // are read from the pack where they are, so the pack has to outlive the font.
+    //--------------------------------------------------------------------------------------
+    bool Initialize(ID3D11Device* device, const AssetPack& pack, std::string_view atlasName);
     void Shutdown();
 
     ID3D11ShaderResourceView* GetTexture() noexcept;
 
-    void BuildVertexArray(void* vertices, std::string_view sentence, float drawX, float drawY);
+    const FontLayout& GetLayout() const noexcept;
 
 private:
-    bool LoadFontData(std::string_view filename);
-    bool LoadTexture(ID3D11Device*, std::wstring_view);
+    bool LoadAtlas(ID3D11Device*, const AssetPack&, std::string_view);
 
 private:
-    static constexpr int s_FontBufferSize = 95;
-    float m_FontSize = 4.0;
-
-    std::vector<FontType> m_Font;
+    FontLayout m_Layout;
     std::unique_ptr<TextureClass> m_Texture;
 };
 
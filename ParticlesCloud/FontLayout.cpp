@@ -0,0 +1,243 @@
+#include "FontLayout.h"
+
+#include <cstring>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Corners of the glyph quads.
+    constexpr int s_TopLeft = 0;
+    constexpr int s_TopRight = 1;
+    constexpr int s_BottomLeft = 2;
+    constexpr int s_BottomRight = 3;
+
+    // The two triangles of a quad, clockwise like the rest of the scene.
+    constexpr int s_QuadTriangles[FontLayout::s_IndicesPerQuad] = {
+        s_TopLeft, s_BottomRight, s_BottomLeft, s_TopLeft, s_TopRight, s_BottomRight,
+    };
+
+    // The corners of an indexed quad in the order of the glyph.
+    constexpr int s_QuadCorners[FontLayout::s_VerticesPerQuad] = { s_TopLeft, s_TopRight, s_BottomLeft, s_BottomRight };
+
+    // Write the corners of a glyph quad in the given order, moved to the pen. On x86 every corner
+    // is one four wide add and three stores, elsewhere the fixed size loops are left to the
+    // compiler.
+    template<size_t N>
+    inline void WriteQuad(
+        FontLayout::VertexType* quad,
+        const FontLayout::CornerType* corners,
+        const int (&order)[N],
+        const float (&pen)[4],
+        const float (&color)[4]) noexcept
+    {
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128 penVector = _mm_loadu_ps(pen);
+        const __m128 colorVector = _mm_loadu_ps(color);
+
+        for (size_t j = 0; j < N; ++j)
+        {
+            const auto& corner = corners[order[j]];
+
+            _mm_storeu_ps(quad[j].position, _mm_add_ps(_mm_loadu_ps(corner.position), penVector));
+            std::memcpy(quad[j].texture, corner.texture, sizeof(corner.texture));
+            _mm_storeu_ps(quad[j].color, colorVector);
+        }
+#else
+        for (size_t j = 0; j < N; ++j)
+        {
+            const auto& corner = corners[order[j]];
+
+            for (int k = 0; k < 4; ++k)
+            {
+                quad[j].position[k] = corner.position[k] + pen[k];
+            }
+            for (int k = 0; k < 2; ++k)
+            {
+                quad[j].texture[k] = corner.texture[k];
+            }
+            for (int k = 0; k < 4; ++k)
+            {
+                quad[j].color[k] = color[k];
+            }
+        }
+#endif
+    }
+}
+
+FontLayout::FontLayout()
+    : m_lineHeight(16.0f * m_FontSize)
+    , m_glyphs{}
+    , m_loadedGlyphs(nullptr)
+{
+}
+
+bool FontLayout::LoadFontData(std::string_view filename)
+{
+    std::ifstream fin;
+    int i;
+    char temp;
+
+    // Read in the font size and spacing between chars.
+    fin.open(filename.data());
+    if (fin.fail())
+    {
+        return false;
+    }
+
+    constexpr int lineSize = 16;
+
+    m_lineHeight = lineSize * m_FontSize;
+    m_glyphs = {};
+    m_loadedGlyphs = nullptr;
+
+    // Read in the 95 used ascii characters for text.
+    for (i = 0; i < s_FontBufferSize; i++)
+    {
+        float left, right;
+        int size;
+
+        fin.get(temp);
+        while (temp != ' ')
+        {
+            fin.get(temp);
+        }
+        fin.get(temp);
+        while (temp != ' ')
+        {
+            fin.get(temp);
+        }
+
+        fin >> left;
+        fin >> right;
+        fin >> size;
+
+        // Normalize the position to range [0, 1].
+        left /= 0.583984f;
+        right /= 0.583984f;
+
+        // Precompute the quad of the glyph relative to the pen, the pen then moves by the size of
+        // the letter and one pixel. The space has no quad and moves the pen by three pixels.
+        auto& glyph = m_glyphs[s_FirstCharacter + i];
+        if (i == 0)
+        {
+            glyph.advance = 3.0f * m_FontSize;
+            continue;
+        }
+
+        const float width = size * m_FontSize;
+
+        glyph.corners[s_TopLeft] = { { 0.0f, 0.0f, 0.0f, 1.0f }, { left, 0.0f } };
+        glyph.corners[s_TopRight] = { { width, 0.0f, 0.0f, 1.0f }, { right, 0.0f } };
+        glyph.corners[s_BottomLeft] = { { 0.0f, -m_lineHeight, 0.0f, 1.0f }, { left, 1.0f } };
+        glyph.corners[s_BottomRight] = { { width, -m_lineHeight, 0.0f, 1.0f }, { right, 1.0f } };
+
+        glyph.advance = width + (1.0f * m_FontSize);
+    }
+
+    // Close the file.
+    fin.close();
+
+    return true;
+}
+
+bool FontLayout::LoadGlyphs(std::span<const GlyphType> glyphs, float lineHeight) noexcept
+{
+    if (glyphs.size() != m_glyphs.size())
+    {
+        return false;
+    }
+
+    m_loadedGlyphs = glyphs.data();
+    m_lineHeight = lineHeight;
+
+    return true;
+}
+
+size_t FontLayout::BuildVertexArray(
+    VertexType* vertices,
+    std::string_view sentence,
+    float drawX,
+    float drawY,
+    float red,
+    float green,
+    float blue) const noexcept
+{
+    const GlyphType* glyphs = m_loadedGlyphs ? m_loadedGlyphs : m_glyphs.data();
+    const float color[4] = { red, green, blue, 1.0f };
+    float pen[4] = { drawX, drawY, 0.0f, 0.0f };
+
+    // Every character gets a quad, so the loop body is the same for all of them and only the pen
+    // carries from one character to the next.
+    for (size_t i = 0; i < sentence.size(); ++i)
+    {
+        const auto character = static_cast<unsigned char>(sentence[i]);
+        const auto& glyph = glyphs[character < s_GlyphTableSize ? character : 0];
+        WriteQuad(vertices + s_IndicesPerQuad * i, glyph.corners, s_QuadTriangles, pen, color);
+
+        // A newline starts the next line below, everything else moves the pen to the right.
+        const bool newline = character == '\n';
+        pen[0] = newline ? drawX : pen[0] + glyph.advance;
+        pen[1] = newline ? pen[1] - m_lineHeight : pen[1];
+    }
+
+    return s_IndicesPerQuad * sentence.size();
+}
+
+size_t FontLayout::BuildQuadArray(
+    VertexType* vertices,
+    std::string_view sentence,
+    float drawX,
+    float drawY,
+    float red,
+    float green,
+    float blue) const noexcept
+{
+    const GlyphType* glyphs = m_loadedGlyphs ? m_loadedGlyphs : m_glyphs.data();
+    const float color[4] = { red, green, blue, 1.0f };
+    float pen[4] = { drawX, drawY, 0.0f, 0.0f };
+
+    for (size_t i = 0; i < sentence.size(); ++i)
+    {
+        const auto character = static_cast<unsigned char>(sentence[i]);
+        const auto& glyph = glyphs[character < s_GlyphTableSize ? character : 0];
+        WriteQuad(vertices + s_VerticesPerQuad * i, glyph.corners, s_QuadCorners, pen, color);
+
+        const bool newline = character == '\n';
+        pen[0] = newline ? drawX : pen[0] + glyph.advance;
+        pen[1] = newline ? pen[1] - m_lineHeight : pen[1];
+    }
+
+    return s_VerticesPerQuad * sentence.size();
+}
+
+void FontLayout::BuildQuadIndices(uint32_t* indices, size_t quadCount, uint32_t firstVertex) noexcept
+{
+    for (size_t i = 0; i < quadCount; ++i)
+    {
+        const uint32_t base = firstVertex + static_cast<uint32_t>(s_VerticesPerQuad * i);
+
+        for (size_t j = 0; j < s_IndicesPerQuad; ++j)
+        {
+            indices[s_IndicesPerQuad * i + j] = base + static_cast<uint32_t>(s_QuadTriangles[j]);
+        }
+    }
+}
+
+float FontLayout::GetLineHeight() const noexcept
+{
+    return m_lineHeight;
+}
+
+std::span<const FontLayout::GlyphType> FontLayout::GetGlyphs() const noexcept
+{
+    if (m_loadedGlyphs)
+    {
+        return { m_loadedGlyphs, s_GlyphTableSize };
+    }
+
+    return m_glyphs;
+}
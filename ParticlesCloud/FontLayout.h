@@ -0,0 +1,103 @@
+#ifndef _FONTLAYOUT_H_
+#define _FONTLAYOUT_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+// Platform independent part of the font: glyph metrics and the layout of strings into quads.
+class FontLayout
+{
+public:
+    // Corner of a ready-made glyph quad, shaped like the start of a vertex so it is moved to the
+    // pen with a single four wide add.
+    struct CornerType
+    {
+        float position[4];
+        float texture[2];
+    };
+
+    // Quad of a glyph with the pen at the origin: the top left, top right, bottom left and
+    // bottom right corners, and how far the glyph moves the pen.
+    struct GlyphType
+    {
+        CornerType corners[4];
+        float advance;
+    };
+
+    // Same memory layout as the position/texture/color vertex used by the font shader.
+    struct VertexType
+    {
+        float position[4];
+        float texture[2];
+        float color[4];
+    };
+
+    static constexpr size_t s_VerticesPerQuad = 4;
+    static constexpr size_t s_IndicesPerQuad = 6;
+    static constexpr size_t s_GlyphTableSize = 128;
+
+public:
+    FontLayout();
+
+    bool LoadFontData(std::string_view filename);
+
+    //--------------------------------------------------------------------------------------
+    // Use a glyph table built by LoadFontData, as baked into a font atlas, where it is. The
+    // table is not copied and has to outlive the layout or the next load. Returns false when
+    // the table does not have one glyph per character code.
+    //--------------------------------------------------------------------------------------
+    bool LoadGlyphs(std::span<const GlyphType> glyphs, float lineHeight) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Write six vertices (two triangles) per character of the sentence and return the number
+    // of vertices written. Spaces and characters without a glyph give empty quads, a newline
+    // moves the pen to the start of the next line.
+    //--------------------------------------------------------------------------------------
+    size_t BuildVertexArray(
+        VertexType* vertices,
+        std::string_view sentence,
+        float drawX,
+        float drawY,
+        float red,
+        float green,
+        float blue) const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Same layout as BuildVertexArray with four vertices per character, drawn with the indices
+    // of BuildQuadIndices.
+    //--------------------------------------------------------------------------------------
+    size_t BuildQuadArray(
+        VertexType* vertices,
+        std::string_view sentence,
+        float drawX,
+        float drawY,
+        float red,
+        float green,
+        float blue) const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Write the six indices of each of quadCount quads, the first one starting at vertex
+    // firstVertex.
+    //--------------------------------------------------------------------------------------
+    static void BuildQuadIndices(uint32_t* indices, size_t quadCount, uint32_t firstVertex = 0) noexcept;
+
+    float GetLineHeight() const noexcept;
+    std::span<const GlyphType> GetGlyphs() const noexcept;
+
+private:
+    static constexpr int s_FontBufferSize = 95;
+    static constexpr int s_FirstCharacter = 32;
+
+    float m_FontSize = 4.0;
+    float m_lineHeight;
+
+    // Indexed by the character code, every code without a glyph has an empty quad. The table
+    // read by LoadFontData is kept here, a loaded one is pointed at by m_loadedGlyphs.
+    std::array<GlyphType, s_GlyphTableSize> m_glyphs;
+    const GlyphType* m_loadedGlyphs;
+};
+
+#endif
@@ -10,7 +10,6 @@ FontShaderClass::FontShaderClass()
     , m_layout(nullptr)
     , m_constantBuffer(nullptr)
     , m_sampleState(nullptr)
-    , m_pixelBuffer(nullptr)
 {
 }
 
@@ -22,11 +21,11 @@ FontShaderClass::~FontShaderClass()
 {
 }
 
-bool FontShaderClass::Initialize(ID3D11Device* device, HWND hwnd)
+bool FontShaderClass::Initialize(ID3D11Device* device, HWND hwnd, ShaderCache& shaders)
 {
     bool result;
     // Initialize the vertex and pixel shaders.
-    result = InitializeShader(device, hwnd, PWSTR(L"./shaders/fontVS.hlsl"), PWSTR(L"./shaders/fontPS.hlsl"));
+    result = InitializeShader(device, hwnd, shaders, PWSTR(L"./shaders/fontVS.hlsl"), PWSTR(L"./shaders/fontPS.hlsl"));
     if (!result)
     {
         return false;
@@ -49,13 +48,12 @@ bool FontShaderClass::Render(
     Matrix worldMatrix,
     Matrix viewMatrix,
     Matrix projectionMatrix,
-    ID3D11ShaderResourceView* texture,
-    Vector4 pixelColor)
+    ID3D11ShaderResourceView* texture)
 {
     bool result;
 
     // Set the shader parameters that it will use for rendering.
-    result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, pixelColor);
+    result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture);
     if (!result)
     {
         return false;
@@ -67,17 +65,21 @@ bool FontShaderClass::Render(
     return true;
 }
 
-bool FontShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, std::wstring_view vsFilename, std::wstring_view psFilename)
+bool FontShaderClass::InitializeShader(
+    ID3D11Device* device,
+    HWND hwnd,
+    ShaderCache& shaders,
+    std::wstring_view vsFilename,
+    std::wstring_view psFilename)
 {
     HRESULT result;
     ID3D10Blob* errorMessage;
     ID3D10Blob* vertexShaderBuffer;
     ID3D10Blob* pixelShaderBuffer;
-    D3D11_INPUT_ELEMENT_DESC polygonLayout[2];
+    D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
     unsigned int numElements;
     D3D11_BUFFER_DESC constantBufferDesc;
     D3D11_SAMPLER_DESC samplerDesc;
-    D3D11_BUFFER_DESC pixelBufferDesc;
 
     // Initialize the pointers this function will use to null.
     errorMessage = nullptr;
@@ -91,16 +93,8 @@ bool FontShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, std::wst
 #endif
 
     // Compile the vertex shader code.
-    result = D3DCompileFromFile(
-        vsFilename.data(),
-        nullptr,
-        nullptr,
-        "FontVertexShader",
-        "vs_5_0",
-        dwShaderFlags,
-        0,
-        &vertexShaderBuffer,
-        &errorMessage);
+    result = DirectXUtils::CompileShader(
+        shaders, vsFilename, "FontVertexShader", "vs_5_0", dwShaderFlags, &vertexShaderBuffer, &errorMessage);
 
     if (FAILED(result))
     {
@@ -119,16 +113,8 @@ bool FontShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, std::wst
     }
 
     // Compile the pixel shader code.
-    result = D3DCompileFromFile(
-        psFilename.data(),
-        nullptr,
-        nullptr,
-        "FontPixelShader",
-        "ps_5_0",
-        dwShaderFlags,
-        0,
-        &pixelShaderBuffer,
-        &errorMessage);
+    result = DirectXUtils::CompileShader(
+        shaders, psFilename, "FontPixelShader", "ps_5_0", dwShaderFlags, &pixelShaderBuffer, &errorMessage);
     if (FAILED(result))
     {
         // If the shader failed to compile it should have writen something to the error message.
@@ -177,6 +163,14 @@ bool FontShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, std::wst
     polygonLayout[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
     polygonLayout[1].InstanceDataStepRate = 0;
 
+    polygonLayout[2].SemanticName = "COLOR";
+    polygonLayout[2].SemanticIndex = 0;
+    polygonLayout[2].Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+    polygonLayout[2].InputSlot = 0;
+    polygonLayout[2].AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
+    polygonLayout[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+    polygonLayout[2].InstanceDataStepRate = 0;
+
     // Get a count of the elements in the layout.
     numElements = sizeof(polygonLayout) / sizeof(polygonLayout[0]);
 
@@ -236,27 +230,11 @@ bool FontShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, std::wst
         return false;
     }
 
-    // Setup the description of the dynamic pixel constant buffer that is in the pixel shader.
-    pixelBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    pixelBufferDesc.ByteWidth = sizeof(PixelBufferType);
-    pixelBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
-    pixelBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    pixelBufferDesc.MiscFlags = 0;
-    pixelBufferDesc.StructureByteStride = 0;
-
-    // Create the pixel constant buffer pointer so we can access the pixel shader constant buffer from within this class.
-    result = device->CreateBuffer(&pixelBufferDesc, NULL, &m_pixelBuffer);
-    if (FAILED(result))
-    {
-        return false;
-    }
-
     return true;
 }
 
 void FontShaderClass::ShutdownShader()
 {
-    DirectXUtils::SafeRelease(m_pixelBuffer);
     DirectXUtils::SafeRelease(m_sampleState);
     DirectXUtils::SafeRelease(m_constantBuffer);
     DirectXUtils::SafeRelease(m_layout);
@@ -303,14 +281,12 @@ bool FontShaderClass::SetShaderParameters(
     Matrix worldMatrix,
     Matrix viewMatrix,
     Matrix projectionMatrix,
-    ID3D11ShaderResourceView* texture,
-    Vector4 pixelColor)
+    ID3D11ShaderResourceView* texture)
 {
     HRESULT result;
     D3D11_MAPPED_SUBRESOURCE mappedResource;
     ConstantBufferType* dataPtr;
     unsigned int bufferNumber;
-    PixelBufferType* dataPtr2;
 
     // Lock the constant buffer so it can be written to.
     result = deviceContext->Map(m_constantBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -343,27 +319,6 @@ bool FontShaderClass::SetShaderParameters(
 
     // Set shader texture resource in the pixel shader.
     deviceContext->PSSetShaderResources(0, 1, &texture);
-    // Lock the pixel constant buffer so it can be written to.
-    result = deviceContext->Map(m_pixelBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(result))
-    {
-        return false;
-    }
-
-    // Get a pointer to the data in the pixel constant buffer.
-    dataPtr2 = (PixelBufferType*)mappedResource.pData;
-
-    // Copy the pixel color into the pixel constant buffer.
-    dataPtr2->pixelColor = pixelColor;
-
-    // Unlock the pixel constant buffer.
-    deviceContext->Unmap(m_pixelBuffer, 0);
-
-    // Set the position of the pixel constant buffer in the pixel shader.
-    bufferNumber = 0;
-
-    // Now set the pixel constant buffer in the pixel shader with the updated value.
-    deviceContext->PSSetConstantBuffers(bufferNumber, 1, &m_pixelBuffer);
 
     return true;
 }
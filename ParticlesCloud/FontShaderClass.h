@@ -7,6 +7,8 @@
 #include <d3dcompiler.h>
 #include <directxtk/SimpleMath.h>
 
+#include "ShaderCache.h"
+
 using namespace DirectX::SimpleMath;
 
 class FontShaderClass
@@ -19,17 +21,12 @@ private:
         Matrix projection;
     };
 
-    struct PixelBufferType
-    {
-        Vector4 pixelColor;
-    };
-
 public:
     FontShaderClass();
     FontShaderClass(const FontShaderClass&);
     ~FontShaderClass();
 
-    bool Initialize(ID3D11Device* device, HWND hwnd);
+    bool Initialize(ID3D11Device* device, HWND hwnd, ShaderCache& shaders);
     void Shutdown();
     bool Render(
         ID3D11DeviceContext* deviceContext,
@@ -37,11 +34,15 @@ public:
         Matrix worldMatrix,
         Matrix viewMatrix,
         Matrix projectionMatrix,
-        ID3D11ShaderResourceView* texture,
-        Vector4 pixelColor);
+        ID3D11ShaderResourceView* texture);
 
 private:
-    bool InitializeShader(ID3D11Device* device, HWND hwnd, std::wstring_view vsFilename, std::wstring_view psFilename);
+    bool InitializeShader(
+        ID3D11Device* device,
+        HWND hwnd,
+        ShaderCache& shaders,
+        std::wstring_view vsFilename,
+        std::wstring_view psFilename);
     void ShutdownShader();
     void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, std::wstring_view shaderFilename);
 
@@ -50,8 +51,7 @@ private:
         Matrix worldMatrix,
         Matrix viewMatrix,
         Matrix projectionMatrix,
-        ID3D11ShaderResourceView* texture,
-        Vector4 pixelColor);
+        ID3D11ShaderResourceView* texture);
     void RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
 
 private:
@@ -60,7 +60,6 @@ private:
     ID3D11InputLayout* m_layout;
     ID3D11Buffer* m_constantBuffer;
     ID3D11SamplerState* m_sampleState;
-    ID3D11Buffer* m_pixelBuffer;
 };
 
 #endif
@@ -1,25 +1,100 @@
 #include "FpsClass.h"
 
+#include <algorithm>
+
+#include "Clock.h"
+
+namespace
+{
+    float ToMilliseconds(uint64_t microseconds) noexcept
+    {
+        return static_cast<float>(microseconds) / 1000.0f;
+    }
+}
+
 void FpsClass::Initialize() noexcept
 {
-    m_fps = 0;
-    m_count = 0;
-    m_startTime = std::chrono::system_clock::now();
+    m_histogram.Reset();
+    m_stats = FrameStats{};
+    m_windowPeak = FramePeak{};
+    m_timelineCount = 0;
+
+    m_initializeTime = Clock::Now();
+    m_windowStartTime = m_initializeTime;
+    m_lastFrameTime = m_initializeTime;
+    m_firstFrame = true;
 }
 
 void FpsClass::Frame() noexcept
 {
-    m_count++;
+    const uint64_t now = Clock::Now();
+    const uint64_t frameTime = now - m_lastFrameTime;
+    m_lastFrameTime = now;
+
+    // The first frame only ends the startup, which is not a frame time. The first window starts
+    // here instead.
+    if (m_firstFrame)
+    {
+        m_windowStartTime = now;
+        m_firstFrame = false;
+        return;
+    }
+
+    // Record the time since the previous frame, the histogram counts microseconds.
+    m_histogram.Record(frameTime / Clock::s_NanosecondsPerMicrosecond);
+
+    const float duration = Clock::ToMilliseconds(frameTime);
+    if (duration > m_windowPeak.Duration)
+    {
+        m_windowPeak.Time = static_cast<float>(Clock::ToSeconds(now - m_initializeTime));
+        m_windowPeak.Duration = duration;
+    }
 
-    if (std::chrono::system_clock::now() >= (m_startTime + std::chrono::seconds(1)))
+    if (now - m_windowStartTime < Clock::s_NanosecondsPerSecond)
     {
-        m_fps = m_count;
-        m_count = 0;
-        m_startTime = std::chrono::system_clock::now();
+        return;
     }
+
+    // Publish the statistics of the finished window.
+    const float windowSeconds = static_cast<float>(Clock::ToSeconds(now - m_windowStartTime));
+
+    m_stats.FrameCount = static_cast<uint32_t>(m_histogram.GetCount());
+    m_stats.Fps = static_cast<int>(static_cast<float>(m_stats.FrameCount) / windowSeconds + 0.5f);
+    m_stats.P50 = ToMilliseconds(m_histogram.GetPercentile(0.5));
+    m_stats.P90 = ToMilliseconds(m_histogram.GetPercentile(0.9));
+    m_stats.P99 = ToMilliseconds(m_histogram.GetPercentile(0.99));
+    m_stats.P999 = ToMilliseconds(m_histogram.GetPercentile(0.999));
+    m_stats.Max = ToMilliseconds(m_histogram.GetMax());
+
+    m_timeline[m_timelineCount % s_TimelineLength] = m_windowPeak;
+    m_timelineCount++;
+
+    // Start the next window.
+    m_histogram.Reset();
+    m_windowPeak = FramePeak{};
+    m_windowStartTime = now;
 }
 
 int FpsClass::GetFps() const noexcept
 {
-    return m_fps;
+    return m_stats.Fps;
+}
+
+const FrameStats& FpsClass::GetFrameStats() const noexcept
+{
+    return m_stats;
+}
+
+std::vector<FramePeak> FpsClass::GetLongestFrameTimeline() const
+{
+    std::vector<FramePeak> timeline;
+    const size_t count = std::min(m_timelineCount, s_TimelineLength);
+
+    timeline.reserve(count);
+    for (size_t i = m_timelineCount - count; i < m_timelineCount; ++i)
+    {
+        timeline.push_back(m_timeline[i % s_TimelineLength]);
+    }
+
+    return timeline;
 }
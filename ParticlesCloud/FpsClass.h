@@ -1,18 +1,60 @@
 #ifndef _FPSCLASS_H_
 #define _FPSCLASS_H_
 
-#include <chrono>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
+#include "FrameTimeHistogram.h"
+
+// Frame time statistics of the last completed one second window, in milliseconds.
+struct FrameStats
+{
+    int Fps = 0;
+    uint32_t FrameCount = 0;
+    float P50 = 0.0f;
+    float P90 = 0.0f;
+    float P99 = 0.0f;
+    float P999 = 0.0f;
+    float Max = 0.0f;
+};
+
+// The longest frame of a window and when it ended, in seconds since Initialize.
+struct FramePeak
+{
+    float Time = 0.0f;
+    float Duration = 0.0f;
+};
+
+// Measures the interval between consecutive Frame calls with Clock and reports the frame rate and
+// the frame time percentiles once per second.
 class FpsClass
 {
 public:
     void Initialize() noexcept;
     void Frame() noexcept;
+
     int GetFps() const noexcept;
+    const FrameStats& GetFrameStats() const noexcept;
+
+    // Longest frame of each of the last s_TimelineLength windows, oldest first.
+    std::vector<FramePeak> GetLongestFrameTimeline() const;
 
 private:
-    int m_fps, m_count;
-    std::chrono::system_clock::time_point m_startTime;
+    static constexpr size_t s_TimelineLength = 60;
+
+    FrameTimeHistogram m_histogram;
+    FrameStats m_stats;
+
+    uint64_t m_initializeTime;
+    uint64_t m_windowStartTime;
+    uint64_t m_lastFrameTime;
+    bool m_firstFrame;
+
+    FramePeak m_windowPeak;
+    std::array<FramePeak, s_TimelineLength> m_timeline;
+    size_t m_timelineCount;
 };
 
-#endif
\ No newline at end of file
+#endif
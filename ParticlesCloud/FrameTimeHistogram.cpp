@@ -0,0 +1,88 @@
+#include "FrameTimeHistogram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+FrameTimeHistogram::FrameTimeHistogram()
+    : m_counts()
+    , m_count(0)
+    , m_max(0)
+{
+}
+
+void FrameTimeHistogram::Record(uint64_t microseconds) noexcept
+{
+    m_counts[GetBucketIndex(microseconds)]++;
+    m_count++;
+    m_max = std::max(m_max, microseconds);
+}
+
+void FrameTimeHistogram::Reset() noexcept
+{
+    m_counts.fill(0);
+    m_count = 0;
+    m_max = 0;
+}
+
+uint64_t FrameTimeHistogram::GetCount() const noexcept
+{
+    return m_count;
+}
+
+uint64_t FrameTimeHistogram::GetMax() const noexcept
+{
+    return m_max;
+}
+
+uint64_t FrameTimeHistogram::GetPercentile(double fraction) const noexcept
+{
+    if (m_count == 0)
+    {
+        return 0;
+    }
+
+    // Rank of the value we are looking for, counted from one.
+    const auto rank = std::clamp<uint64_t>(static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(m_count))), 1, m_count);
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < s_BucketCount; ++i)
+    {
+        seen += m_counts[i];
+        if (seen >= rank)
+        {
+            // The bucket bound can overshoot the largest recorded value.
+            return std::min(GetBucketUpperBound(i), m_max);
+        }
+    }
+
+    return m_max;
+}
+
+size_t FrameTimeHistogram::GetBucketIndex(uint64_t value) noexcept
+{
+    // Values below the sub bucket count are stored exactly, larger ones keep their top bits.
+    const int magnitude = std::max(static_cast<int>(std::bit_width(value)) - s_SubBucketBits, 0);
+    const auto subBucket = static_cast<size_t>(value >> magnitude);
+
+    if (magnitude == 0)
+    {
+        return subBucket;
+    }
+
+    return s_SubBucketCount + static_cast<size_t>(magnitude - 1) * s_SubBucketHalf + (subBucket - s_SubBucketHalf);
+}
+
+uint64_t FrameTimeHistogram::GetBucketUpperBound(size_t index) noexcept
+{
+    if (index < s_SubBucketCount)
+    {
+        return index;
+    }
+
+    const auto offset = index - s_SubBucketCount;
+    const int magnitude = static_cast<int>(offset / s_SubBucketHalf) + 1;
+    const auto subBucket = offset % s_SubBucketHalf + s_SubBucketHalf;
+
+    return ((subBucket + 1) << magnitude) - 1;
+}
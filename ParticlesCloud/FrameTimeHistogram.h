@@ -0,0 +1,41 @@
+#ifndef _FRAMETIMEHISTOGRAM_H_
+#define _FRAMETIMEHISTOGRAM_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// High dynamic range histogram of durations in microseconds. Every power of two range is split
+// into 64 linear buckets, so any recorded value is reported within 1.6% from 1 us up to hours
+// with about 15KB of counters and no allocation when recording.
+class FrameTimeHistogram
+{
+public:
+    FrameTimeHistogram();
+
+    void Record(uint64_t microseconds) noexcept;
+    void Reset() noexcept;
+
+    uint64_t GetCount() const noexcept;
+    uint64_t GetMax() const noexcept;
+
+    // Smallest bucket bound that at least the given fraction (0..1] of the values do not exceed.
+    uint64_t GetPercentile(double fraction) const noexcept;
+
+private:
+    static constexpr int s_SubBucketBits = 7;
+    static constexpr uint64_t s_SubBucketCount = uint64_t{ 1 } << s_SubBucketBits;
+    static constexpr uint64_t s_SubBucketHalf = s_SubBucketCount / 2;
+    static constexpr int s_MaxMagnitude = 64 - s_SubBucketBits;
+    static constexpr size_t s_BucketCount = s_SubBucketCount + s_MaxMagnitude * s_SubBucketHalf;
+
+    static size_t GetBucketIndex(uint64_t value) noexcept;
+    static uint64_t GetBucketUpperBound(size_t index) noexcept;
+
+private:
+    std::array<uint32_t, s_BucketCount> m_counts;
+    uint64_t m_count;
+    uint64_t m_max;
+};
+
+#endif
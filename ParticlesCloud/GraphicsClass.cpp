@@ -1,70 +1,224 @@
 #include "GraphicsClass.h"
 
-GraphicsClass::GraphicsClass() = default;
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "Clock.h"
+#include "Platform.h"
+#include "StartupGraph.h"
+
+namespace
+{
+    // The viewer has no console, so the startup figures also go to a file a user can open.
+    // Like the trace export, a file that can not be written is not an error.
+    void WriteStartupLog(const std::string& filename, std::string_view text, bool append)
+    {
+        std::ofstream fout{ filename, append ? std::ios::app : std::ios::trunc };
+        fout << text;
+    }
+}
+
+GraphicsClass::GraphicsClass()
+    : m_hwnd(nullptr)
+    , m_cameraDrift(0.0f)
+    , m_startTime(0)
+    , m_firstFrameReported(false)
+{
+}
 
 GraphicsClass::~GraphicsClass()
 {
     Shutdown();
 }
 
-bool GraphicsClass::Initialize(const int screenWidth, const int screenHeight, HWND hwnd)
+bool GraphicsClass::Initialize(const int screenWidth, const int screenHeight, HWND hwnd, const SceneParameters& parameters)
 {
+    StartupGraph startup;
+    std::string assetDirectory = ".";
+    Matrix baseViewMatrix;
     bool result;
 
-    // Create the Direct3D object.
-    m_D3D = std::make_unique<D3DClass>();
-    if (!m_D3D)
-    {
-        return false;
-    }
-
-    // Initialize the Direct3D object.
-    result = m_D3D->Initialize(screenWidth, screenHeight, VSYNC_ENABLED, hwnd, FULL_SCREEN, SCREEN_DEPTH, SCREEN_NEAR);
-    if (!result)
-    {
-        MessageBox(hwnd, L"Could not initialize Direct3D", L"Error", MB_OK);
-        return false;
-    }
+    m_hwnd = hwnd;
+    m_cameraDrift = parameters.CameraDrift;
+    m_startTime = Clock::Now();
+    m_firstFrameReported = false;
+    m_startupLogFile = (std::filesystem::path(parameters.TraceFile).parent_path() / STARTUP_LOG).string();
 
-    // Create the camera object.
-    m_Camera = std::make_unique<CameraClass>();
-    if (!m_Camera)
+    // Create the particles shader object up front, its steps run on different threads.
+    m_ParticlesShader = std::make_unique<ParticlesShader>();
+    if (!m_ParticlesShader)
     {
         return false;
     }
 
-    // Initialize a base view matrix with the camera for 2D user interface rendering.
-    m_Camera->SetPosition(0.0f, 0.0f, -1.0f);
-    m_Camera->Render();
-    const Matrix& baseViewMatrix = m_Camera->GetViewMatrix();
-
-    // Create the text object.
-    m_Text = std::make_unique<TextClass>();
-    if (!m_Text)
-    {
-        return false;
-    }
+    // Steps off the window thread show their errors without an owner window, an owned message
+    // box would wait for the window thread while it waits for the steps.
+    const auto pack = startup.AddTask("Asset pack", [&]() {
+        // Create the asset pack object.
+        m_Pack = std::make_unique<AssetPack>();
+        if (!m_Pack)
+        {
+            return false;
+        }
+
+        // Map the pack deployed next to the executable, without one read the loose files from the
+        // working directory like during development.
+        const auto executableDirectory = Platform::GetExecutableDirectory();
+        if (!executableDirectory.empty() && m_Pack->Open(executableDirectory + "/" + std::string(ASSET_PACK)))
+        {
+            assetDirectory = executableDirectory;
+        }
+        else
+        {
+            m_Pack->OpenDirectory(assetDirectory);
+        }
+
+        return true;
+    });
+
+    const auto assets = startup.AddTask(
+        "Asset threads",
+        [&]() {
+            // Create the asset manager object.
+            m_Assets = std::make_unique<AssetManager>();
+            if (!m_Assets)
+            {
+                return false;
+            }
+
+            // Start the asset threads, images decode on them while the rest is initialized.
+            m_Assets->Initialize(ASSET_THREADS, m_Pack.get());
+
+            return true;
+        },
+        { pack });
+
+    const auto shaders = startup.AddTask(
+        "Shader cache",
+        [&]() {
+            // Create the shader cache object.
+            m_Shaders = std::make_unique<ShaderCache>();
+            if (!m_Shaders)
+            {
+                return false;
+            }
+
+            // Keep the shaders compiled on a miss next to the assets, in the same directory a pack holds
+            // its prebuilt ones, so the next launch loads them instead of compiling again.
+            m_Shaders->Initialize(
+                std::make_unique<D3DShaderCompiler>(), *m_Pack, assetDirectory + "/" + std::string(ShaderCache::s_PackDirectory));
+
+            return true;
+        },
+        { pack });
+
+    // The swap chain belongs to the window, so the device is created on the window thread.
+    const auto direct3D = startup.AddTask(
+        "Direct3D",
+        [&]() {
+            // Create the Direct3D object.
+            m_D3D = std::make_unique<D3DClass>();
+            if (!m_D3D)
+            {
+                return false;
+            }
+
+            // Initialize the Direct3D object.
+            return m_D3D->Initialize(
+                screenWidth,
+                screenHeight,
+                parameters.VSyncEnabled,
+                hwnd,
+                parameters.FullScreen,
+                SCREEN_DEPTH,
+                SCREEN_NEAR);
+        },
+        {},
+        StartupGraph::Affinity::CallingThread);
+
+    const auto camera = startup.AddTask(
+        "Camera",
+        [&]() {
+            // Create the camera object.
+            m_Camera = std::make_unique<CameraClass>();
+            if (!m_Camera)
+            {
+                return false;
+            }
+
+            // Initialize a base view matrix with the camera for 2D user interface rendering.
+            m_Camera->SetProjection(DirectXUtils::ToFloat4x4(m_D3D->GetProjectionMatrix()));
+            m_Camera->SetPosition(0.0f, 0.0f, -1.0f);
+            m_Camera->Render();
+            baseViewMatrix = DirectXUtils::ToMatrix(m_Camera->GetViewMatrix());
+
+            return true;
+        },
+        { direct3D });
+
+    startup.AddTask(
+        "Text",
+        [&]() {
+            // Create the text object.
+            m_Text = std::make_unique<TextClass>();
+            if (!m_Text)
+            {
+                return false;
+            }
+
+            // Initialize the text object.
+            return m_Text->Initialize(
+                m_D3D->GetDevice(), m_D3D->GetDeviceContext(), nullptr, screenWidth, screenHeight, baseViewMatrix, *m_Pack, *m_Shaders);
+        },
+        { camera, shaders });
+
+    // Generate the particles while the device is created and the shaders are compiled.
+    const auto particles = startup.AddTask(
+        "Particles",
+        [&]() { return m_ParticlesShader->LoadParticles(nullptr, parameters, *m_Assets); },
+        { assets });
+
+    startup.AddTask(
+        "Particle shaders",
+        [&]() { return m_ParticlesShader->CreateShaders(m_D3D->GetDevice(), nullptr, *m_Shaders); },
+        { direct3D, shaders });
+
+    startup.AddTask(
+        "Particle buffers",
+        [&]() { return m_ParticlesShader->CreateResources(m_D3D->GetDevice(), screenWidth, screenHeight); },
+        { direct3D, particles });
+
+    result = startup.Run(STARTUP_THREADS);
+
+    // Report the time of every step, a debugger shows it in its output window and the startup
+    // log next to the profiler trace keeps it.
+    const auto report = startup.FormatReport();
+    OutputDebugStringA(report.c_str());
+    WriteStartupLog(m_startupLogFile, report, false);
 
-    // Initialize the text object.
-    result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix);
     if (!result)
     {
-        MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
+        MessageBoxA(hwnd, ("Could not initialize: " + std::string(startup.GetFailedTask())).c_str(), "Error", MB_OK);
         return false;
     }
 
-    // Create the light shader object.
-    m_ParticlesShader = std::make_unique<ParticlesShader>();
-    if (!m_ParticlesShader)
-    {
-        return false;
-    }
+    return true;
+}
+
+bool GraphicsClass::ApplyParameters(const SceneParameters& parameters)
+{
+    bool result;
+
+    // Full screen mode is only chosen when the window is created, everything else applies right away.
+    m_D3D->SetVSync(parameters.VSyncEnabled);
+    m_cameraDrift = parameters.CameraDrift;
 
-    // Initialize the light shader object.
-    result = m_ParticlesShader->Initialize(m_D3D->GetDevice(), hwnd, screenWidth, screenHeight);
+    result = m_ParticlesShader->ApplyParameters(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), m_hwnd, parameters);
     if (!result)
     {
-        MessageBox(hwnd, L"Could not initialize the particles shader object.", L"Error", MB_OK);
+        MessageBox(m_hwnd, L"Could not apply the scene parameters to the particles shader.", L"Error", MB_OK);
         return false;
     }
 
@@ -95,32 +249,93 @@ void GraphicsClass::Shutdown()
         m_D3D->Shutdown();
         m_D3D.reset();
     }
+
+    // Release the shader cache object.
+    if (m_Shaders)
+    {
+        m_Shaders->Shutdown();
+        m_Shaders.reset();
+    }
+
+    // Stop the asset threads and release the cached images.
+    if (m_Assets)
+    {
+        m_Assets->Shutdown();
+        m_Assets.reset();
+    }
+
+    // Unmap the asset pack last, the asset threads read from it.
+    if (m_Pack)
+    {
+        m_Pack->Close();
+        m_Pack.reset();
+    }
     return;
 }
 
-bool GraphicsClass::Frame(int fps, int cpu, float frameTime, int mouseX, int mouseY)
+bool GraphicsClass::Frame(
+    const FrameStats& frameStats,
+    const CpuSnapshot& cpu,
+    const MemoryStats& memory,
+    const InputLatencyStats& inputLatency,
+    float frameTime,
+    const std::vector<CursorSample>& cursorPath)
 {
     bool result;
-    constexpr float deltaTime = 0.01f;
 
-    // Set the frames per second.
-     result = m_Text->SetFps(fps, m_D3D->GetDeviceContext());
-    if (!result)
     {
-        return false;
+        PROFILE_ZONE("HudText");
+
+        // Set the frames per second.
+        result = m_Text->SetFps(frameStats.Fps);
+        if (!result)
+        {
+            return false;
+        }
+
+        // Set the cpu usage.
+        result = m_Text->SetCpu(static_cast<int>(cpu.SystemPercentage + 0.5f), static_cast<int>(cpu.ProcessPercentage + 0.5f));
+        if (!result)
+        {
+            return false;
+        }
+
+        // Set the frame time percentiles.
+        result = m_Text->SetFrameTimes(frameStats);
+        if (!result)
+        {
+            return false;
+        }
+
+        // Set the process memory.
+        result = m_Text->SetMemory(memory);
+        if (!result)
+        {
+            return false;
+        }
+
+        // Set the input latency.
+        result = m_Text->SetInputLatency(inputLatency);
+        if (!result)
+        {
+            return false;
+        }
+
+        // Set the energy and the size of the particle cloud.
+        result = m_Text->SetCloudStats(m_ParticlesShader->GetCloudStats());
+        if (!result)
+        {
+            return false;
+        }
     }
 
-    // Set the cpu usage.
-     result = m_Text->SetCpu(cpu, m_D3D->GetDeviceContext());
-    if (!result)
-    {
-        return false;
-    }
+    const auto cameraPosition = m_Camera->GetPosition();
+    m_Camera->SetPosition(cameraPosition.x + m_cameraDrift, 0.0, -70.0);
 
-    Vector3 cameraPosition = m_Camera->GetPosition();
-    m_Camera->SetPosition(cameraPosition.x + deltaTime, 0.0, -70.0);
-
-    m_ParticlesShader->SetMousePosition(Vector2(mouseX, mouseY));
+    // Hand the frame time and the whole cursor path of the frame over, the particles follow
+    // every point of it.
+    m_ParticlesShader->SetFrameTime(frameTime);
+    m_ParticlesShader->AddCursorPath(cursorPath);
 
     // Render the graphics scene.
     result = Render();
@@ -129,9 +344,33 @@ bool GraphicsClass::Frame(int fps, int cpu, float frameTime, int mouseX, int mou
         return false;
     }
 
+    // Time to the first frame, the figure the startup steps are budgeted against.
+    if (!m_firstFrameReported)
+    {
+        char message[96];
+        std::snprintf(
+            message,
+            sizeof(message),
+            "First frame presented %.2f ms after the graphics started initializing.\n",
+            static_cast<double>(Clock::Now() - m_startTime) / Clock::s_NanosecondsPerMillisecond);
+        OutputDebugStringA(message);
+        WriteStartupLog(m_startupLogFile, message, true);
+        m_firstFrameReported = true;
+    }
+
     return true;
 }
 
+uint64_t GraphicsClass::GetPresentedInputTime() const noexcept
+{
+    return m_ParticlesShader->GetPresentedInputTime();
+}
+
+const ParticlesSimulation::CloudStats& GraphicsClass::GetCloudStats() const noexcept
+{
+    return m_ParticlesShader->GetCloudStats();
+}
+
 bool GraphicsClass::Render()
 {
     Matrix projectionMatrix;
@@ -140,17 +379,19 @@ bool GraphicsClass::Render()
     // Clear the buffers to begin the scene.
     m_D3D->BeginScene(0.0f, 0.0f, 0.0f, 1.0f);
 
-    // Generate the view matrix based on the camera's position.
+    // Update the cached camera matrices, only when the camera moved.
     m_Camera->Render();
 
     // Render the particles.
-    result = m_ParticlesShader->Render(m_D3D->GetDeviceContext(), 0, m_Camera->GetViewMatrix(), m_D3D->GetProjectionMatrix());
+    {
+        PROFILE_ZONE("Particles");
+        result = m_ParticlesShader->Render(m_D3D->GetDeviceContext(), 0, *m_Camera);
+    }
     if (!result)
     {
         return false;
     }
 
-    const auto& viewMatrix = m_Camera->GetViewMatrix();
     const auto& worldMatrix = m_D3D->GetWorldMatrix();
     // const auto projectionMatrix = m_D3D->GetProjectionMatrix();
     const auto& orthoMatrix = m_D3D->GetOrthoMatrix();
@@ -162,7 +403,10 @@ bool GraphicsClass::Render()
     m_D3D->TurnOnAlphaBlending();
 
     // Render the text strings.
-    result = m_Text->Render(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);
+    {
+        PROFILE_ZONE("HudRender");
+        result = m_Text->Render(m_D3D->GetDeviceContext(), worldMatrix, orthoMatrix);
+    }
     if (!result)
     {
         return false;
@@ -175,7 +419,10 @@ bool GraphicsClass::Render()
     m_D3D->TurnZBufferOn();
 
     // Present the rendered scene to the screen.
-    m_D3D->EndScene();
+    {
+        PROFILE_ZONE("Present");
+        m_D3D->EndScene();
+    }
 
     return true;
 }
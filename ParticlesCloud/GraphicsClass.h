@@ -1,19 +1,34 @@
 #ifndef _GRAPHICSCLASS_H_
 #define _GRAPHICSCLASS_H_
 
+#include <cstdint>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <windows.h>
 
+#include "AssetManager.h"
+#include "AssetPack.h"
 #include "CameraClass.h"
+#include "CpuClass.h"
 #include "D3DClass.h"
+#include "InputEvents.h"
+#include "InputLatencyClass.h"
+#include "MemoryClass.h"
 #include "ParticlesShader.h"
+#include "Profiler.h"
+#include "SceneConfigClass.h"
+#include "ShaderCache.h"
 #include "TextClass.h"
 
-constexpr bool FULL_SCREEN = true;
-constexpr bool VSYNC_ENABLED = false;
 constexpr float SCREEN_DEPTH = 1000.0f;
 constexpr float SCREEN_NEAR = 0.1f;
+constexpr size_t ASSET_THREADS = 2;
+constexpr size_t STARTUP_THREADS = 3;
+constexpr std::string_view ASSET_PACK = "ParticlesCloud.pack";
+constexpr std::string_view STARTUP_LOG = "startup.log";
 
 class GraphicsClass
 {
@@ -21,18 +36,39 @@ public:
     GraphicsClass();
     ~GraphicsClass();
 
-    bool Initialize(const int screenWidth, const int screenHeight, HWND hwnd);
+    bool Initialize(const int screenWidth, const int screenHeight, HWND hwnd, const SceneParameters& parameters);
+    bool ApplyParameters(const SceneParameters& parameters);
     void Shutdown();
-    bool Frame(int fps, int cpu, float frameTime, int mouseX, int mouseY);
+    bool Frame(
+        const FrameStats& frameStats,
+        const CpuSnapshot& cpu,
+        const MemoryStats& memory,
+        const InputLatencyStats& inputLatency,
+        float frameTime,
+        const std::vector<CursorSample>& cursorPath);
+
+    // Time of the newest input event the particles of the last presented frame reflect.
+    uint64_t GetPresentedInputTime() const noexcept;
+
+    // Statistics of the particle cloud of the last presented frame.
+    const ParticlesSimulation::CloudStats& GetCloudStats() const noexcept;
 
 private:
     bool Render();
 
 private:
+    std::unique_ptr<AssetPack> m_Pack;
+    std::unique_ptr<AssetManager> m_Assets;
+    std::unique_ptr<ShaderCache> m_Shaders;
     std::unique_ptr<D3DClass> m_D3D;
     std::unique_ptr<CameraClass> m_Camera;
     std::unique_ptr<ParticlesShader> m_ParticlesShader;
     std::unique_ptr<TextClass> m_Text;
+    HWND m_hwnd;
+    float m_cameraDrift;
+    uint64_t m_startTime;
+    bool m_firstFrameReported;
+    std::string m_startupLogFile;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,335 @@
+#include "ImageDecoder.h"
+
+#include <cstring>
+
+namespace
+{
+    // Reads the bytes of a GIF file front to back, every read past the end fails the decode.
+    class GifReader
+    {
+    public:
+        explicit GifReader(std::span<const std::byte> data)
+            : m_data(data)
+            , m_position(0)
+            , m_failed(false)
+        {
+        }
+
+        uint8_t ReadByte() noexcept
+        {
+            if (m_position >= m_data.size())
+            {
+                m_failed = true;
+                return 0;
+            }
+
+            return std::to_integer<uint8_t>(m_data[m_position++]);
+        }
+
+        uint16_t ReadWord() noexcept
+        {
+            const uint16_t low = ReadByte();
+            return static_cast<uint16_t>(low | (ReadByte() << 8));
+        }
+
+        const uint8_t* Read(size_t count) noexcept
+        {
+            if (count > m_data.size() - m_position)
+            {
+                m_failed = true;
+                return nullptr;
+            }
+
+            const auto* result = reinterpret_cast<const uint8_t*>(m_data.data()) + m_position;
+            m_position += count;
+            return result;
+        }
+
+        // Concatenate a chain of data sub-blocks, ended by a block of size zero.
+        void ReadSubBlocks(std::vector<uint8_t>* output) noexcept
+        {
+            for (uint8_t size = ReadByte(); size != 0 && !m_failed; size = ReadByte())
+            {
+                const uint8_t* block = Read(size);
+                if (block && output)
+                {
+                    output->insert(output->end(), block, block + size);
+                }
+            }
+        }
+
+        bool Failed() const noexcept
+        {
+            return m_failed;
+        }
+
+    private:
+        std::span<const std::byte> m_data;
+        size_t m_position;
+        bool m_failed;
+    };
+
+    // Decode the LZW code stream of a GIF image into one palette index per pixel.
+    bool DecodeLzw(const std::vector<uint8_t>& codes, int minimumCodeSize, size_t pixelCount, std::vector<uint8_t>& indices)
+    {
+        constexpr int maximumCodeSize = 12;
+        constexpr int tableSize = 1 << maximumCodeSize;
+
+        if (minimumCodeSize < 2 || minimumCodeSize > 8)
+        {
+            return false;
+        }
+
+        // Every code is a prefix code and the last byte of its string, the strings are written
+        // backwards into the stack before they are copied out.
+        std::vector<uint16_t> prefix(tableSize);
+        std::vector<uint8_t> suffix(tableSize);
+        std::vector<uint8_t> stack(tableSize);
+
+        const int clearCode = 1 << minimumCodeSize;
+        const int endCode = clearCode + 1;
+        int codeSize = minimumCodeSize + 1;
+        int nextCode = endCode + 1;
+        int previousCode = -1;
+        uint8_t firstByte = 0;
+
+        for (int code = 0; code < clearCode; ++code)
+        {
+            suffix[code] = static_cast<uint8_t>(code);
+        }
+
+        indices.clear();
+        indices.reserve(pixelCount);
+
+        uint32_t bitBuffer = 0;
+        int bitCount = 0;
+        size_t position = 0;
+
+        while (indices.size() < pixelCount)
+        {
+            while (bitCount < codeSize)
+            {
+                if (position >= codes.size())
+                {
+                    return false;
+                }
+                bitBuffer |= static_cast<uint32_t>(codes[position++]) << bitCount;
+                bitCount += 8;
+            }
+
+            const int code = static_cast<int>(bitBuffer & ((1u << codeSize) - 1));
+            bitBuffer >>= codeSize;
+            bitCount -= codeSize;
+
+            if (code == clearCode)
+            {
+                codeSize = minimumCodeSize + 1;
+                nextCode = endCode + 1;
+                previousCode = -1;
+                continue;
+            }
+            if (code == endCode)
+            {
+                break;
+            }
+
+            if (previousCode < 0)
+            {
+                if (code >= clearCode)
+                {
+                    return false;
+                }
+                firstByte = static_cast<uint8_t>(code);
+                indices.push_back(firstByte);
+                previousCode = code;
+                continue;
+            }
+
+            if (code > nextCode)
+            {
+                return false;
+            }
+
+            // A code that is not in the table yet is the previous string and its own first byte.
+            int current = code;
+            size_t top = 0;
+            if (code == nextCode)
+            {
+                stack[top++] = firstByte;
+                current = previousCode;
+            }
+            while (current >= clearCode)
+            {
+                stack[top++] = suffix[current];
+                current = prefix[current];
+            }
+            stack[top++] = suffix[current];
+            firstByte = suffix[current];
+
+            while (top > 0 && indices.size() < pixelCount)
+            {
+                indices.push_back(stack[--top]);
+            }
+
+            if (nextCode < tableSize)
+            {
+                prefix[nextCode] = static_cast<uint16_t>(previousCode);
+                suffix[nextCode] = firstByte;
+                ++nextCode;
+
+                if (nextCode == (1 << codeSize) && codeSize < maximumCodeSize)
+                {
+                    ++codeSize;
+                }
+            }
+
+            previousCode = code;
+        }
+
+        return indices.size() == pixelCount;
+    }
+}
+
+bool ImageDecoder::DecodeGif(std::span<const std::byte> data, ImageData& image, std::string& errorMessage)
+{
+    GifReader reader{ data };
+    std::vector<uint8_t> palette;
+    int transparentIndex = -1;
+
+    const uint8_t* signature = reader.Read(6);
+    if (!signature || (std::memcmp(signature, "GIF87a", 6) != 0 && std::memcmp(signature, "GIF89a", 6) != 0))
+    {
+        errorMessage = "The file is not a GIF image.";
+        return false;
+    }
+
+    image.Width = reader.ReadWord();
+    image.Height = reader.ReadWord();
+    image.Pitch = image.Width * ImageData::s_BytesPerTexel;
+    const uint8_t flags = reader.ReadByte();
+    reader.ReadByte();
+    reader.ReadByte();
+
+    if (flags & 0x80)
+    {
+        const size_t size = 3 * (size_t{ 2 } << (flags & 0x07));
+        const uint8_t* table = reader.Read(size);
+        if (table)
+        {
+            palette.assign(table, table + size);
+        }
+    }
+
+    while (!reader.Failed())
+    {
+        const uint8_t introducer = reader.ReadByte();
+
+        if (introducer == '!')
+        {
+            // Only the graphic control extension matters, for its transparent color.
+            const uint8_t label = reader.ReadByte();
+            if (label == 0xF9)
+            {
+                std::vector<uint8_t> control;
+                reader.ReadSubBlocks(&control);
+                if (control.size() >= 4 && (control[0] & 0x01))
+                {
+                    transparentIndex = control[3];
+                }
+            }
+            else
+            {
+                reader.ReadSubBlocks(nullptr);
+            }
+        }
+        else if (introducer == ',')
+        {
+            const uint16_t left = reader.ReadWord();
+            const uint16_t top = reader.ReadWord();
+            const uint16_t width = reader.ReadWord();
+            const uint16_t height = reader.ReadWord();
+            const uint8_t imageFlags = reader.ReadByte();
+
+            if (imageFlags & 0x80)
+            {
+                const size_t size = 3 * (size_t{ 2 } << (imageFlags & 0x07));
+                const uint8_t* table = reader.Read(size);
+                if (table)
+                {
+                    palette.assign(table, table + size);
+                }
+            }
+
+            const int minimumCodeSize = reader.ReadByte();
+            std::vector<uint8_t> codes;
+            reader.ReadSubBlocks(&codes);
+
+            std::vector<uint8_t> indices;
+            if (reader.Failed() || !DecodeLzw(codes, minimumCodeSize, size_t{ width } * height, indices))
+            {
+                errorMessage = "The GIF image data is corrupted.";
+                return false;
+            }
+
+            if (palette.empty() || left + width > image.Width || top + height > image.Height)
+            {
+                errorMessage = "The GIF image does not fit its screen or has no palette.";
+                return false;
+            }
+
+            // Interlaced images store every eighth row first, then the rows in between.
+            std::vector<uint32_t> rows(height);
+            if (imageFlags & 0x40)
+            {
+                constexpr uint32_t passStart[4] = { 0, 4, 2, 1 };
+                constexpr uint32_t passStep[4] = { 8, 8, 4, 2 };
+                uint32_t row = 0;
+                for (int pass = 0; pass < 4; ++pass)
+                {
+                    for (uint32_t y = passStart[pass]; y < height; y += passStep[pass])
+                    {
+                        rows[row++] = y;
+                    }
+                }
+            }
+            else
+            {
+                for (uint32_t y = 0; y < height; ++y)
+                {
+                    rows[y] = y;
+                }
+            }
+
+            image.Texels.assign(size_t{ image.Width } * image.Height * ImageData::s_BytesPerTexel, 0);
+
+            for (uint32_t row = 0; row < height; ++row)
+            {
+                uint8_t* texel = image.Texels.data() +
+                    ((size_t{ top } + rows[row]) * image.Width + left) * ImageData::s_BytesPerTexel;
+
+                for (uint32_t x = 0; x < width; ++x, texel += ImageData::s_BytesPerTexel)
+                {
+                    const size_t index = indices[size_t{ row } * width + x];
+                    if (3 * index + 2 >= palette.size())
+                    {
+                        continue;
+                    }
+
+                    texel[0] = palette[3 * index + 0];
+                    texel[1] = palette[3 * index + 1];
+                    texel[2] = palette[3 * index + 2];
+                    texel[3] = static_cast<int>(index) == transparentIndex ? 0 : 255;
+                }
+            }
+
+            return true;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    errorMessage = "The GIF file has no image.";
+    return false;
+}
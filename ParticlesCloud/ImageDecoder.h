@@ -0,0 +1,41 @@
+#ifndef _IMAGEDECODER_H_
+#define _IMAGEDECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// Decoded image, RGBA8 texels with rows from top to bottom, ready to be uploaded as a texture.
+struct ImageData
+{
+    static constexpr uint32_t s_BytesPerTexel = 4;
+
+    uint32_t Width = 0;
+    uint32_t Height = 0;
+    uint32_t Pitch = 0;
+    std::vector<uint8_t> Texels;
+};
+
+// Image decoders turning the bytes of a file into RGBA8 texels. They only touch their arguments,
+// so any number of them can run at once on different threads.
+namespace ImageDecoder
+{
+    using DecodeFunction = bool (*)(std::span<const std::byte> data, ImageData& image, std::string& errorMessage);
+
+    //--------------------------------------------------------------------------------------
+    // Software decoder of the first image of a GIF file. The transparent color gets an alpha
+    // of zero, everything else is opaque.
+    //--------------------------------------------------------------------------------------
+    bool DecodeGif(std::span<const std::byte> data, ImageData& image, std::string& errorMessage);
+
+#ifdef _WIN32
+    //--------------------------------------------------------------------------------------
+    // Decoder of the Windows imaging component, for JPEG, PNG, BMP and TIFF files.
+    //--------------------------------------------------------------------------------------
+    bool DecodeWic(std::span<const std::byte> data, ImageData& image, std::string& errorMessage);
+#endif
+};
+
+#endif
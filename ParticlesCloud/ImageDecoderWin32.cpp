@@ -0,0 +1,101 @@
+#ifdef _WIN32
+
+#include "ImageDecoder.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <objbase.h>
+#include <wincodec.h>
+
+namespace
+{
+    template<typename T>
+    void Release(T*& object) noexcept
+    {
+        if (object)
+        {
+            object->Release();
+            object = nullptr;
+        }
+    }
+}
+
+bool ImageDecoder::DecodeWic(std::span<const std::byte> data, ImageData& image, std::string& errorMessage)
+{
+    IWICImagingFactory* factory = nullptr;
+    IWICStream* stream = nullptr;
+    IWICBitmapDecoder* decoder = nullptr;
+    IWICBitmapFrameDecode* frame = nullptr;
+    IWICFormatConverter* converter = nullptr;
+    UINT width = 0;
+    UINT height = 0;
+    HRESULT result;
+
+    // Decoders run on worker threads that never initialized COM, join the multithreaded apartment
+    // for the decode. A thread already in another apartment keeps it.
+    const HRESULT initialized = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+
+    // Decode the first frame from memory and convert it to RGBA8.
+    result = CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+    if (SUCCEEDED(result))
+    {
+        result = factory->CreateStream(&stream);
+    }
+    if (SUCCEEDED(result))
+    {
+        result = stream->InitializeFromMemory(
+            reinterpret_cast<BYTE*>(const_cast<std::byte*>(data.data())), static_cast<DWORD>(data.size()));
+    }
+    if (SUCCEEDED(result))
+    {
+        result = factory->CreateDecoderFromStream(stream, nullptr, WICDecodeMetadataCacheOnDemand, &decoder);
+    }
+    if (SUCCEEDED(result))
+    {
+        result = decoder->GetFrame(0, &frame);
+    }
+    if (SUCCEEDED(result))
+    {
+        result = factory->CreateFormatConverter(&converter);
+    }
+    if (SUCCEEDED(result))
+    {
+        result = converter->Initialize(
+            frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+    }
+    if (SUCCEEDED(result))
+    {
+        result = converter->GetSize(&width, &height);
+    }
+    if (SUCCEEDED(result))
+    {
+        image.Width = width;
+        image.Height = height;
+        image.Pitch = width * ImageData::s_BytesPerTexel;
+        image.Texels.resize(size_t{ image.Pitch } * height);
+
+        result = converter->CopyPixels(nullptr, image.Pitch, static_cast<UINT>(image.Texels.size()), image.Texels.data());
+    }
+
+    Release(converter);
+    Release(frame);
+    Release(decoder);
+    Release(stream);
+    Release(factory);
+
+    if (SUCCEEDED(initialized))
+    {
+        CoUninitialize();
+    }
+
+    if (FAILED(result))
+    {
+        errorMessage = "The Windows imaging component could not decode the image.";
+        return false;
+    }
+
+    return true;
+}
+
+#endif
@@ -1,18 +1,36 @@
 #include "InputClass.h"
 
+#include "Clock.h"
 #include "DirectXUtils.h"
+#include "Profiler.h"
+
+namespace
+{
+    // Size the buffer DirectInput keeps the device changes in between two reads.
+    HRESULT SetBufferSize(IDirectInputDevice8* device, DWORD size)
+    {
+        DIPROPDWORD property{};
+
+        property.diph.dwSize = sizeof(DIPROPDWORD);
+        property.diph.dwHeaderSize = sizeof(DIPROPHEADER);
+        property.diph.dwObj = 0;
+        property.diph.dwHow = DIPH_DEVICE;
+        property.dwData = size;
+
+        return device->SetProperty(DIPROP_BUFFERSIZE, &property.diph);
+    }
+}
 
 InputClass::InputClass()
     : m_directInput(nullptr)
     , m_keyboard(nullptr)
     , m_mouse(nullptr)
-    , m_mouseX(0)
-    , m_mouseY(0)
-    , m_screenHeight(0)
-    , m_screenWidth(0)
-    , m_mouseState(DIMOUSESTATE{})
+    , m_keyboardEvent(nullptr)
+    , m_mouseEvent(nullptr)
+    , m_stopEvent(nullptr)
+    , m_droppedEvents(0)
+    , m_failed(false)
 {
-    m_keyboardState.fill(0);
 }
 
 InputClass::InputClass(const InputClass& other)
@@ -28,12 +46,7 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
     HRESULT result;
 
     // Store the screen size which will be used for positioning the mouse cursor.
-    m_screenWidth = screenWidth;
-    m_screenHeight = screenHeight;
-
-    // Initialize the location of the mouse on the screen.
-    m_mouseX = 0;
-    m_mouseY = 0;
+    m_state.Initialize(screenWidth, screenHeight);
 
     // Initialize the main direct input interface.
     result = DirectInput8Create(hinstance, DIRECTINPUT_VERSION, IID_IDirectInput8, reinterpret_cast<void**>(&m_directInput), nullptr);
@@ -63,6 +76,25 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
         return false;
     }
 
+    // Buffer the key changes and signal the input thread when there are new ones.
+    result = SetBufferSize(m_keyboard, s_DeviceBufferSize);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    m_keyboardEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_keyboardEvent)
+    {
+        return false;
+    }
+
+    result = m_keyboard->SetEventNotification(m_keyboardEvent);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
     // Now acquire the keyboard.
     result = m_keyboard->Acquire();
     if (FAILED(result))
@@ -91,6 +123,25 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
         return false;
     }
 
+    // Buffer every mouse movement and signal the input thread when there are new ones.
+    result = SetBufferSize(m_mouse, s_DeviceBufferSize);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
+    m_mouseEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (!m_mouseEvent)
+    {
+        return false;
+    }
+
+    result = m_mouse->SetEventNotification(m_mouseEvent);
+    if (FAILED(result))
+    {
+        return false;
+    }
+
     // Acquire the mouse.
     result = m_mouse->Acquire();
     if (FAILED(result))
@@ -98,11 +149,27 @@ bool InputClass::Initialize(HINSTANCE hinstance, HWND hwnd, int screenWidth, int
         return false;
     }
 
+    // Start reading the devices on the input thread.
+    m_stopEvent = CreateEvent(nullptr, TRUE, FALSE, nullptr);
+    if (!m_stopEvent)
+    {
+        return false;
+    }
+
+    m_thread = std::thread(&InputClass::InputThread, this);
+
     return true;
 }
 
 void InputClass::Shutdown()
 {
+    // Stop the input thread before the devices it reads go away.
+    if (m_thread.joinable())
+    {
+        SetEvent(m_stopEvent);
+        m_thread.join();
+    }
+
     // Release the mouse.
     if (m_mouse)
     {
@@ -120,99 +187,235 @@ void InputClass::Shutdown()
     // Release the main interface to direct input.
     DirectXUtils::SafeRelease(m_directInput);
 
+    m_mouse = nullptr;
+    m_keyboard = nullptr;
+    m_directInput = nullptr;
+
+    // Close the notification events.
+    for (HANDLE* handle : { &m_keyboardEvent, &m_mouseEvent, &m_stopEvent })
+    {
+        if (*handle)
+        {
+            CloseHandle(*handle);
+            *handle = nullptr;
+        }
+    }
+
     return;
 }
 
 bool InputClass::Frame()
+{
+    return ReadEvents(false);
+}
+
+bool InputClass::Frame(const std::vector<InputEvent>& playbackEvents)
 {
     bool result;
 
-    // Read the current state of the keyboard.
-    result = ReadKeyboard();
+    result = ReadEvents(true);
     if (!result)
     {
         return false;
     }
 
-    // Read the current state of the mouse.
-    result = ReadMouse();
-    if (!result)
+    // Apply the recorded events of the frame as if they were read now.
+    for (const auto& event : playbackEvents)
+    {
+        ProcessEvent(event);
+    }
+
+    return true;
+}
+
+bool InputClass::ReadEvents(bool playback)
+{
+    InputEvent event;
+
+    // A device error on the input thread ends the application like it did when polled here.
+    if (m_failed.load(std::memory_order_relaxed))
     {
         return false;
     }
 
-    // Process the changes in the mouse and keyboard.
-    ProcessInput();
+    m_state.BeginFrame();
+    m_frameEvents.clear();
+
+    // Apply every event read since the previous frame, in order. During playback only Escape and
+    // F12 still come from the live keyboard.
+    while (m_events.Pop(event))
+    {
+        if (!playback || event.Key == DIK_ESCAPE || event.Key == DIK_F12)
+        {
+            ProcessEvent(event);
+        }
+    }
 
     return true;
 }
 
+void InputClass::InputThread()
+{
+    const HANDLE handles[3] = { m_stopEvent, m_keyboardEvent, m_mouseEvent };
+
+    Profiler::SetThreadName("Input");
+
+    while (true)
+    {
+        // Wake up as soon as a device has new data, and every few milliseconds to acquire a
+        // device again that lost the focus.
+        const DWORD wait = WaitForMultipleObjects(3, handles, FALSE, 10);
+        if (wait == WAIT_OBJECT_0 || wait == WAIT_FAILED)
+        {
+            break;
+        }
+
+        // Read the changes of the keyboard and the mouse.
+        if (!ReadKeyboard() || !ReadMouse())
+        {
+            m_failed.store(true, std::memory_order_relaxed);
+            break;
+        }
+    }
+}
+
 bool InputClass::ReadKeyboard()
 {
+    std::array<DIDEVICEOBJECTDATA, s_DeviceBufferSize> data;
+    DWORD count = s_DeviceBufferSize;
     HRESULT result;
 
-    // Read the keyboard device.
-    result = m_keyboard->GetDeviceState(sizeof(m_keyboardState), reinterpret_cast<LPVOID>(&m_keyboardState));
+    // Read the buffered key changes of the keyboard device.
+    result = m_keyboard->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data.data(), &count, 0);
     if (FAILED(result))
     {
         // If the keyboard lost focus or was not acquired then try to get control back.
         if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
         {
             m_keyboard->Acquire();
+            return true;
         }
-        else
-        {
-            return false;
-        }
+
+        return false;
+    }
+
+    // The thread wakes up with the device notification, so the read time stands for the time
+    // the change arrived.
+    const uint64_t now = Clock::Now();
+
+    for (DWORD i = 0; i < count; ++i)
+    {
+        PushEvent(InputEvent{ now, 0, 0, static_cast<uint16_t>(data[i].dwOfs), (data[i].dwData & 0x80) != 0 });
     }
 
     return true;
 }
+
 bool InputClass::ReadMouse()
 {
+    std::array<DIDEVICEOBJECTDATA, s_DeviceBufferSize> data;
+    DWORD count = s_DeviceBufferSize;
     HRESULT result;
 
-    // Read the mouse device.
-    result = m_mouse->GetDeviceState(sizeof(DIMOUSESTATE), reinterpret_cast<LPVOID>(&m_mouseState));
+    // Read the buffered movements of the mouse device.
+    result = m_mouse->GetDeviceData(sizeof(DIDEVICEOBJECTDATA), data.data(), &count, 0);
     if (FAILED(result))
     {
         // If the mouse lost focus or was not acquired then try to get control back.
         if ((result == DIERR_INPUTLOST) || (result == DIERR_NOTACQUIRED))
         {
             m_mouse->Acquire();
+            return true;
+        }
+
+        return false;
+    }
+
+    const uint64_t now = Clock::Now();
+    InputEvent motion{};
+    DWORD sequence = 0;
+    bool pending = false;
+
+    for (DWORD i = 0; i < count; ++i)
+    {
+        const auto& item = data[i];
+        if (item.dwOfs != DIMOFS_X && item.dwOfs != DIMOFS_Y)
+        {
+            continue;
+        }
+
+        // The x and y change of one movement share a sequence number and become one event.
+        if (pending && item.dwSequence != sequence)
+        {
+            PushEvent(motion);
+            pending = false;
+        }
+
+        if (!pending)
+        {
+            motion = InputEvent{ now, 0, 0, 0, false };
+            sequence = item.dwSequence;
+            pending = true;
+        }
+
+        if (item.dwOfs == DIMOFS_X)
+        {
+            motion.MouseDeltaX += static_cast<int32_t>(item.dwData);
         }
         else
         {
-            return false;
+            motion.MouseDeltaY += static_cast<int32_t>(item.dwData);
         }
     }
 
+    if (pending)
+    {
+        PushEvent(motion);
+    }
+
     return true;
 }
 
-void InputClass::ProcessInput() noexcept
+void InputClass::PushEvent(const InputEvent& event) noexcept
 {
-    // Update the location of the mouse cursor based on the change of the mouse location during the frame.
-    m_mouseX += m_mouseState.lX;
-    m_mouseY += m_mouseState.lY;
+    if (!m_events.Push(event))
+    {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
-    // Ensure the mouse location doesn't exceed the screen width or height.
-    m_mouseX = min(max(0, m_mouseX), m_screenWidth);
-    m_mouseY = min(max(0, m_mouseY), m_screenHeight);
+void InputClass::ProcessEvent(const InputEvent& event)
+{
+    m_state.Apply(event);
+    m_frameEvents.push_back(event);
 }
 
 bool InputClass::IsEscapePressed() const noexcept
 {
-    // Do a bitwise and on the keyboard state to check if the escape key is currently being pressed.
-    if (m_keyboardState[DIK_ESCAPE] & 0x80)
-    {
-        return true;
-    }
+    return m_state.IsKeyDown(DIK_ESCAPE);
+}
 
-    return false;
+bool InputClass::IsF12Pressed() const noexcept
+{
+    return m_state.IsKeyDown(DIK_F12);
 }
+
 void InputClass::GetMouseLocation(int& mouseX, int& mouseY) const noexcept
 {
-    mouseX = m_mouseX;
-    mouseY = m_mouseY;
+    m_state.GetMouseLocation(mouseX, mouseY);
 }
+
+const std::vector<CursorSample>& InputClass::GetCursorPath() const noexcept
+{
+    return m_state.GetCursorPath();
+}
+
+const std::vector<InputEvent>& InputClass::GetFrameEvents() const noexcept
+{
+    return m_frameEvents;
+}
+
+uint64_t InputClass::GetDroppedEventCount() const noexcept
+{
+    return m_droppedEvents.load(std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -7,9 +7,21 @@
 #define DIRECTINPUT_VERSION 0x0800
 
 #include <array>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
 
 #include <dinput.h>
 
+#include "InputEvents.h"
+#include "InputState.h"
+#include "SpscQueue.h"
+
+// Reads the keyboard and the mouse on an input thread as soon as DirectInput signals new data, and
+// hands the timestamped events to the main thread through a lock-free queue. Frame turns the
+// events of the frame into the key states and the path the cursor took, instead of only the
+// position it ended at. During playback recorded events take the place of the live ones.
 class InputClass
 {
 public:
@@ -20,25 +32,49 @@ public:
     bool Initialize(HINSTANCE, HWND, int, int);
     void Shutdown();
     bool Frame();
+    bool Frame(const std::vector<InputEvent>& playbackEvents);
 
     bool IsEscapePressed() const noexcept;
+    bool IsF12Pressed() const noexcept;
     void GetMouseLocation(int& mouseX, int& mouseY) const noexcept;
 
+    // Cursor positions after every mouse event read by the last Frame, oldest first.
+    const std::vector<CursorSample>& GetCursorPath() const noexcept;
+
+    // Events applied by the last Frame, in order, for recording the session.
+    const std::vector<InputEvent>& GetFrameEvents() const noexcept;
+
+    // Events lost because the main thread did not keep up with the input thread.
+    uint64_t GetDroppedEventCount() const noexcept;
+
 private:
+    void InputThread();
     bool ReadKeyboard();
     bool ReadMouse();
-    void ProcessInput() noexcept;
+    void PushEvent(const InputEvent& event) noexcept;
+    void ProcessEvent(const InputEvent& event);
+    bool ReadEvents(bool playback);
 
 private:
+    static constexpr DWORD s_DeviceBufferSize = 256;
+    static constexpr size_t s_QueueCapacity = 4096;
+
     IDirectInput8* m_directInput;
     IDirectInputDevice8* m_keyboard;
     IDirectInputDevice8* m_mouse;
 
-    std::array<unsigned char, 256> m_keyboardState;
-    DIMOUSESTATE m_mouseState;
+    // Signaled by DirectInput when a device has new data, and by Shutdown to stop the thread.
+    HANDLE m_keyboardEvent;
+    HANDLE m_mouseEvent;
+    HANDLE m_stopEvent;
+    std::thread m_thread;
+
+    SpscQueue<InputEvent, s_QueueCapacity> m_events;
+    std::atomic<uint64_t> m_droppedEvents;
+    std::atomic<bool> m_failed;
 
-    int m_screenWidth, m_screenHeight;
-    int m_mouseX, m_mouseY;
+    InputState m_state;
+    std::vector<InputEvent> m_frameEvents;
 };
 
-#endif
\ No newline at end of file
+#endif
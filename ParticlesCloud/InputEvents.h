@@ -0,0 +1,26 @@
+#ifndef _INPUTEVENTS_H_
+#define _INPUTEVENTS_H_
+
+#include <cstdint>
+
+// One change of an input device as read by the input thread, stamped with Clock::Now() when it
+// was read. Key is 0 for mouse motion, otherwise the scan code that went up or down.
+struct InputEvent
+{
+    uint64_t Time;
+    int32_t MouseDeltaX;
+    int32_t MouseDeltaY;
+    uint16_t Key;
+    bool KeyDown;
+};
+
+// Cursor position in screen pixels after a mouse event, the motion path of a frame is the
+// sequence of these.
+struct CursorSample
+{
+    uint64_t Time;
+    int32_t X;
+    int32_t Y;
+};
+
+#endif
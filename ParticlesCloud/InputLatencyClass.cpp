@@ -0,0 +1,65 @@
+#include "InputLatencyClass.h"
+
+#include "Clock.h"
+
+namespace
+{
+    float ToMilliseconds(uint64_t microseconds) noexcept
+    {
+        return static_cast<float>(microseconds) / 1000.0f;
+    }
+}
+
+void InputLatencyClass::Initialize() noexcept
+{
+    m_histogram.Reset();
+    m_stats = InputLatencyStats{};
+    m_pendingEvents.clear();
+    m_windowStartTime = Clock::Now();
+}
+
+void InputLatencyClass::Frame(const std::vector<CursorSample>& cursorPath, uint64_t presentedInputTime)
+{
+    const uint64_t now = Clock::Now();
+
+    for (const auto& sample : cursorPath)
+    {
+        m_pendingEvents.push_back(sample.Time);
+    }
+
+    while (m_pendingEvents.size() > s_MaxPendingEvents)
+    {
+        m_pendingEvents.pop_front();
+    }
+
+    // Every event up to the presented input time reached the screen with this frame.
+    while (!m_pendingEvents.empty() && m_pendingEvents.front() <= presentedInputTime)
+    {
+        const uint64_t eventTime = m_pendingEvents.front();
+        m_pendingEvents.pop_front();
+
+        m_histogram.Record(now > eventTime ? (now - eventTime) / Clock::s_NanosecondsPerMicrosecond : 0);
+    }
+
+    if (now - m_windowStartTime < Clock::s_NanosecondsPerSecond)
+    {
+        return;
+    }
+
+    // Publish the statistics of the finished window, an idle mouse keeps the last ones.
+    if (m_histogram.GetCount() > 0)
+    {
+        m_stats.EventCount = static_cast<uint32_t>(m_histogram.GetCount());
+        m_stats.P50 = ToMilliseconds(m_histogram.GetPercentile(0.5));
+        m_stats.P99 = ToMilliseconds(m_histogram.GetPercentile(0.99));
+        m_stats.Max = ToMilliseconds(m_histogram.GetMax());
+    }
+
+    m_histogram.Reset();
+    m_windowStartTime = now;
+}
+
+const InputLatencyStats& InputLatencyClass::GetStats() const noexcept
+{
+    return m_stats;
+}
@@ -0,0 +1,46 @@
+#ifndef _INPUTLATENCYCLASS_H_
+#define _INPUTLATENCYCLASS_H_
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "FrameTimeHistogram.h"
+#include "InputEvents.h"
+
+// Input to present latency of the last completed one second window, in milliseconds.
+struct InputLatencyStats
+{
+    uint32_t EventCount = 0;
+    float P50 = 0.0f;
+    float P99 = 0.0f;
+    float Max = 0.0f;
+};
+
+// Measures the time from every cursor event to the end of the Present call of the first frame that
+// draws particles stepped with it. Events wait until the frame reports an input time at or past
+// theirs, so a simulation running one or more steps behind the input is accounted for.
+class InputLatencyClass
+{
+public:
+    void Initialize() noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Called after Present with the cursor path read this frame and the time of the newest
+    // input the presented particles reflect.
+    //--------------------------------------------------------------------------------------
+    void Frame(const std::vector<CursorSample>& cursorPath, uint64_t presentedInputTime);
+
+    const InputLatencyStats& GetStats() const noexcept;
+
+private:
+    // Events of a stalled simulation are dropped past this, they would only be late anyway.
+    static constexpr size_t s_MaxPendingEvents = 4096;
+
+    FrameTimeHistogram m_histogram;
+    InputLatencyStats m_stats;
+    std::deque<uint64_t> m_pendingEvents;
+    uint64_t m_windowStartTime;
+};
+
+#endif
@@ -0,0 +1,218 @@
+#include "InputRecording.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+#include "Clock.h"
+#include "MappedFile.h"
+
+namespace
+{
+    template<typename T>
+    T Saturate(uint64_t value) noexcept
+    {
+        return static_cast<T>(std::min<uint64_t>(value, std::numeric_limits<T>::max()));
+    }
+
+    int16_t Saturate16(int32_t value) noexcept
+    {
+        return static_cast<int16_t>(std::clamp<int32_t>(value, INT16_MIN, INT16_MAX));
+    }
+}
+
+InputRecording::InputRecording()
+    : m_screenWidth(0)
+    , m_screenHeight(0)
+    , m_nextFrame(0)
+    , m_nextEvent(0)
+{
+}
+
+void InputRecording::BeginRecording(int screenWidth, int screenHeight)
+{
+    m_frames.clear();
+    m_events.clear();
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_nextFrame = 0;
+    m_nextEvent = 0;
+}
+
+void InputRecording::RecordFrame(uint64_t frameNanoseconds, uint64_t frameTime, const std::vector<InputEvent>& events)
+{
+    m_frames.push_back(RecordedFrame{
+        Saturate<uint32_t>(frameNanoseconds / Clock::s_NanosecondsPerMicrosecond),
+        static_cast<uint32_t>(events.size()),
+    });
+
+    for (const auto& event : events)
+    {
+        const uint64_t age = frameTime > event.Time ? frameTime - event.Time : 0;
+
+        m_events.push_back(RecordedEvent{
+            Saturate<uint32_t>(age / Clock::s_NanosecondsPerMicrosecond),
+            Saturate16(event.MouseDeltaX),
+            Saturate16(event.MouseDeltaY),
+            event.Key,
+            static_cast<uint8_t>(event.KeyDown ? 1 : 0),
+            0,
+        });
+    }
+}
+
+bool InputRecording::Save(std::string_view filename)
+{
+    std::ofstream fout{ std::string(filename), std::ios::binary };
+    InputRecordingHeader header{};
+
+    m_errorMessage.clear();
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not create the input recording file.";
+        return false;
+    }
+
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.ScreenWidth = static_cast<uint32_t>(m_screenWidth);
+    header.ScreenHeight = static_cast<uint32_t>(m_screenHeight);
+    header.FrameCount = m_frames.size();
+    header.EventCount = m_events.size();
+
+    fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    fout.write(reinterpret_cast<const char*>(m_frames.data()), m_frames.size() * sizeof(RecordedFrame));
+    fout.write(reinterpret_cast<const char*>(m_events.data()), m_events.size() * sizeof(RecordedEvent));
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not write the input recording file.";
+        return false;
+    }
+
+    return true;
+}
+
+bool InputRecording::Load(std::string_view filename)
+{
+    MappedFile file;
+    InputRecordingHeader header;
+
+    m_errorMessage.clear();
+
+    if (!file.Open(filename))
+    {
+        m_errorMessage = "Could not open the input recording file.";
+        return false;
+    }
+
+    if (file.GetSize() < sizeof(InputRecordingHeader))
+    {
+        m_errorMessage = "The input recording file is too small to hold a header.";
+        return false;
+    }
+
+    std::memcpy(&header, file.GetData(), sizeof(InputRecordingHeader));
+
+    if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0)
+    {
+        m_errorMessage = "The file is not an input recording.";
+        return false;
+    }
+
+    if (header.Version != s_Version)
+    {
+        m_errorMessage = "Unsupported input recording version.";
+        return false;
+    }
+
+    // Check the counts against the file size before multiplying them.
+    const size_t available = file.GetSize() - sizeof(InputRecordingHeader);
+    if (header.FrameCount > available / sizeof(RecordedFrame) || header.EventCount > available / sizeof(RecordedEvent) ||
+        header.FrameCount * sizeof(RecordedFrame) + header.EventCount * sizeof(RecordedEvent) > available)
+    {
+        m_errorMessage = "The input recording file is truncated.";
+        return false;
+    }
+
+    const std::byte* frames = file.GetData() + sizeof(InputRecordingHeader);
+    const std::byte* events = frames + header.FrameCount * sizeof(RecordedFrame);
+
+    m_frames.resize(static_cast<size_t>(header.FrameCount));
+    m_events.resize(static_cast<size_t>(header.EventCount));
+    std::memcpy(m_frames.data(), frames, m_frames.size() * sizeof(RecordedFrame));
+    std::memcpy(m_events.data(), events, m_events.size() * sizeof(RecordedEvent));
+
+    // The frames must account for exactly the recorded events.
+    uint64_t eventCount = 0;
+    for (const auto& frame : m_frames)
+    {
+        eventCount += frame.EventCount;
+    }
+
+    if (eventCount != header.EventCount)
+    {
+        m_errorMessage = "The input recording frames do not match its events.";
+        m_frames.clear();
+        m_events.clear();
+        return false;
+    }
+
+    m_screenWidth = static_cast<int>(header.ScreenWidth);
+    m_screenHeight = static_cast<int>(header.ScreenHeight);
+    m_nextFrame = 0;
+    m_nextEvent = 0;
+
+    return true;
+}
+
+bool InputRecording::PlayFrame(uint64_t frameTime, uint64_t& frameNanoseconds, std::vector<InputEvent>& events)
+{
+    events.clear();
+
+    if (m_nextFrame >= m_frames.size())
+    {
+        return false;
+    }
+
+    const auto& frame = m_frames[m_nextFrame++];
+    frameNanoseconds = uint64_t{ frame.FrameMicroseconds } * Clock::s_NanosecondsPerMicrosecond;
+
+    for (uint32_t i = 0; i < frame.EventCount; ++i)
+    {
+        const auto& event = m_events[m_nextEvent++];
+        const uint64_t age = uint64_t{ event.AgeMicroseconds } * Clock::s_NanosecondsPerMicrosecond;
+
+        events.push_back(InputEvent{
+            frameTime > age ? frameTime - age : 0,
+            event.MouseDeltaX,
+            event.MouseDeltaY,
+            event.Key,
+            event.KeyDown != 0,
+        });
+    }
+
+    return true;
+}
+
+size_t InputRecording::GetFrameCount() const noexcept
+{
+    return m_frames.size();
+}
+
+int InputRecording::GetScreenWidth() const noexcept
+{
+    return m_screenWidth;
+}
+
+int InputRecording::GetScreenHeight() const noexcept
+{
+    return m_screenHeight;
+}
+
+const std::string& InputRecording::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
@@ -0,0 +1,85 @@
+#ifndef _INPUTRECORDING_H_
+#define _INPUTRECORDING_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "InputEvents.h"
+
+// Records the input events and frame times of a session and plays them back frame by frame, so a
+// session replays in the viewer or the headless runner as a fixed workload.
+//
+// File layout (little endian):
+//   InputRecordingHeader
+//   RecordedFrame[FrameCount]
+//   RecordedEvent[EventCount]  the events of all frames in order
+class InputRecording
+{
+public:
+    static constexpr char s_Magic[4] = { 'P', 'C', 'I', 'R' };
+    static constexpr uint32_t s_Version = 1;
+
+    struct InputRecordingHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint32_t ScreenWidth;
+        uint32_t ScreenHeight;
+        uint64_t FrameCount;
+        uint64_t EventCount;
+    };
+
+    // Frame time and the number of events applied in the frame.
+    struct RecordedFrame
+    {
+        uint32_t FrameMicroseconds;
+        uint32_t EventCount;
+    };
+
+    // An event with its age when the frame applied it, instead of an absolute time.
+    struct RecordedEvent
+    {
+        uint32_t AgeMicroseconds;
+        int16_t MouseDeltaX;
+        int16_t MouseDeltaY;
+        uint16_t Key;
+        uint8_t KeyDown;
+        uint8_t Reserved;
+    };
+
+public:
+    InputRecording();
+
+    //--------------------------------------------------------------------------------------
+    // Recording. frameTime is the time the frame applied the events at.
+    //--------------------------------------------------------------------------------------
+    void BeginRecording(int screenWidth, int screenHeight);
+    void RecordFrame(uint64_t frameNanoseconds, uint64_t frameTime, const std::vector<InputEvent>& events);
+    bool Save(std::string_view filename);
+
+    //--------------------------------------------------------------------------------------
+    // Playback. PlayFrame returns false once every frame was played, the events are stamped
+    // relative to frameTime.
+    //--------------------------------------------------------------------------------------
+    bool Load(std::string_view filename);
+    bool PlayFrame(uint64_t frameTime, uint64_t& frameNanoseconds, std::vector<InputEvent>& events);
+
+    size_t GetFrameCount() const noexcept;
+    int GetScreenWidth() const noexcept;
+    int GetScreenHeight() const noexcept;
+    const std::string& GetErrorMessage() const noexcept;
+
+private:
+    std::vector<RecordedFrame> m_frames;
+    std::vector<RecordedEvent> m_events;
+    int m_screenWidth, m_screenHeight;
+
+    size_t m_nextFrame;
+    size_t m_nextEvent;
+    std::string m_errorMessage;
+};
+
+#endif
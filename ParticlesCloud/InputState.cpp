@@ -0,0 +1,68 @@
+#include "InputState.h"
+
+#include <algorithm>
+
+InputState::InputState()
+    : m_screenWidth(0)
+    , m_screenHeight(0)
+    , m_mouseX(0)
+    , m_mouseY(0)
+{
+    m_keyboardState.fill(0);
+}
+
+void InputState::Initialize(int screenWidth, int screenHeight) noexcept
+{
+    // Store the screen size which will be used for positioning the mouse cursor.
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+
+    // Initialize the location of the mouse on the screen.
+    m_mouseX = 0;
+    m_mouseY = 0;
+
+    m_keyboardState.fill(0);
+    m_cursorPath.clear();
+}
+
+void InputState::BeginFrame() noexcept
+{
+    m_cursorPath.clear();
+}
+
+void InputState::Apply(const InputEvent& event)
+{
+    // Keep the state of every key like the immediate keyboard state did.
+    if (event.Key != 0)
+    {
+        m_keyboardState[event.Key & 0xFF] = event.KeyDown ? 0x80 : 0x00;
+        return;
+    }
+
+    // Update the location of the mouse cursor based on the change of the mouse location.
+    m_mouseX += event.MouseDeltaX;
+    m_mouseY += event.MouseDeltaY;
+
+    // Ensure the mouse location doesn't exceed the screen width or height.
+    m_mouseX = std::clamp(m_mouseX, 0, m_screenWidth);
+    m_mouseY = std::clamp(m_mouseY, 0, m_screenHeight);
+
+    m_cursorPath.push_back(CursorSample{ event.Time, m_mouseX, m_mouseY });
+}
+
+bool InputState::IsKeyDown(uint16_t key) const noexcept
+{
+    // Do a bitwise and on the keyboard state to check if the key is currently being pressed.
+    return (m_keyboardState[key & 0xFF] & 0x80) != 0;
+}
+
+void InputState::GetMouseLocation(int& mouseX, int& mouseY) const noexcept
+{
+    mouseX = m_mouseX;
+    mouseY = m_mouseY;
+}
+
+const std::vector<CursorSample>& InputState::GetCursorPath() const noexcept
+{
+    return m_cursorPath;
+}
@@ -0,0 +1,35 @@
+#ifndef _INPUTSTATE_H_
+#define _INPUTSTATE_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "InputEvents.h"
+
+// Key states, cursor position and cursor path built from a sequence of input events. The viewer
+// feeds it live or recorded events, the headless runner recorded ones, so both see the same input.
+class InputState
+{
+public:
+    InputState();
+
+    void Initialize(int screenWidth, int screenHeight) noexcept;
+
+    // Starts a frame, the cursor path then only holds the events applied after this call.
+    void BeginFrame() noexcept;
+    void Apply(const InputEvent& event);
+
+    bool IsKeyDown(uint16_t key) const noexcept;
+    void GetMouseLocation(int& mouseX, int& mouseY) const noexcept;
+    const std::vector<CursorSample>& GetCursorPath() const noexcept;
+
+private:
+    std::array<unsigned char, 256> m_keyboardState;
+    std::vector<CursorSample> m_cursorPath;
+
+    int m_screenWidth, m_screenHeight;
+    int m_mouseX, m_mouseY;
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "MathUtils.h"
+
+#include <cmath>
+
+float MathUtils::Dot(const Float3& a, const Float3& b) noexcept
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+MathUtils::Float3 MathUtils::Cross(const Float3& a, const Float3& b) noexcept
+{
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+MathUtils::Float3 MathUtils::Normalize(const Float3& v) noexcept
+{
+    const float length = std::sqrt(Dot(v, v));
+    if (length == 0.0f)
+    {
+        return v;
+    }
+
+    return { v.x / length, v.y / length, v.z / length };
+}
+
+MathUtils::Float4x4 MathUtils::Identity() noexcept
+{
+    return Float4x4{ { { 1.0f, 0.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } } };
+}
+
+MathUtils::Float4x4 MathUtils::Multiply(const Float4x4& a, const Float4x4& b) noexcept
+{
+    Float4x4 result{};
+
+    for (int row = 0; row < 4; ++row)
+    {
+        for (int column = 0; column < 4; ++column)
+        {
+            result.m[row][column] = a.m[row][0] * b.m[0][column] + a.m[row][1] * b.m[1][column] + a.m[row][2] * b.m[2][column] +
+                                    a.m[row][3] * b.m[3][column];
+        }
+    }
+
+    return result;
+}
+
+MathUtils::Float4 MathUtils::Transform(const Float4& v, const Float4x4& matrix) noexcept
+{
+    const auto& m = matrix.m;
+
+    return Float4{
+        v.x * m[0][0] + v.y * m[1][0] + v.z * m[2][0] + v.w * m[3][0],
+        v.x * m[0][1] + v.y * m[1][1] + v.z * m[2][1] + v.w * m[3][1],
+        v.x * m[0][2] + v.y * m[1][2] + v.z * m[2][2] + v.w * m[3][2],
+        v.x * m[0][3] + v.y * m[1][3] + v.z * m[2][3] + v.w * m[3][3],
+    };
+}
+
+MathUtils::Float3 MathUtils::TransformCoord(const Float3& v, const Float4x4& matrix) noexcept
+{
+    const Float4 result = Transform({ v.x, v.y, v.z, 1.0f }, matrix);
+
+    return { result.x / result.w, result.y / result.w, result.z / result.w };
+}
+
+MathUtils::Float4x4 MathUtils::RotationRollPitchYaw(float pitch, float yaw, float roll) noexcept
+{
+    Float4x4 rotationX = Identity(), rotationY = Identity(), rotationZ = Identity();
+
+    rotationX.m[1][1] = std::cos(pitch);
+    rotationX.m[1][2] = std::sin(pitch);
+    rotationX.m[2][1] = -std::sin(pitch);
+    rotationX.m[2][2] = std::cos(pitch);
+
+    rotationY.m[0][0] = std::cos(yaw);
+    rotationY.m[0][2] = -std::sin(yaw);
+    rotationY.m[2][0] = std::sin(yaw);
+    rotationY.m[2][2] = std::cos(yaw);
+
+    rotationZ.m[0][0] = std::cos(roll);
+    rotationZ.m[0][1] = std::sin(roll);
+    rotationZ.m[1][0] = -std::sin(roll);
+    rotationZ.m[1][1] = std::cos(roll);
+
+    // Roll first, then pitch, then yaw.
+    return Multiply(Multiply(rotationZ, rotationX), rotationY);
+}
+
+MathUtils::Float4x4 MathUtils::LookAtLH(const Float3& position, const Float3& lookAt, const Float3& up) noexcept
+{
+    const Float3 zAxis = Normalize({ lookAt.x - position.x, lookAt.y - position.y, lookAt.z - position.z });
+    const Float3 xAxis = Normalize(Cross(up, zAxis));
+    const Float3 yAxis = Cross(zAxis, xAxis);
+
+    return Float4x4{ {
+        { xAxis.x, yAxis.x, zAxis.x, 0.0f },
+        { xAxis.y, yAxis.y, zAxis.y, 0.0f },
+        { xAxis.z, yAxis.z, zAxis.z, 0.0f },
+        { -Dot(xAxis, position), -Dot(yAxis, position), -Dot(zAxis, position), 1.0f },
+    } };
+}
+
+MathUtils::Float4x4 MathUtils::PerspectiveFovLH(float fieldOfView, float aspectRatio, float nearZ, float farZ) noexcept
+{
+    const float yScale = 1.0f / std::tan(fieldOfView / 2.0f);
+    const float range = farZ / (farZ - nearZ);
+
+    return Float4x4{ {
+        { yScale / aspectRatio, 0.0f, 0.0f, 0.0f },
+        { 0.0f, yScale, 0.0f, 0.0f },
+        { 0.0f, 0.0f, range, 1.0f },
+        { 0.0f, 0.0f, -range * nearZ, 0.0f },
+    } };
+}
+
+bool MathUtils::Invert(const Float4x4& matrix, Float4x4& result) noexcept
+{
+    const auto& m = matrix.m;
+
+    // 2x2 sub-determinants of the upper and lower halves.
+    const float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1];
+    const float s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    const float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3];
+    const float s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    const float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3];
+    const float s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+
+    const float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3];
+    const float c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    const float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2];
+    const float c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    const float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2];
+    const float c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    const float determinant = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if (determinant == 0.0f || !std::isfinite(determinant))
+    {
+        return false;
+    }
+
+    const float inverse = 1.0f / determinant;
+    auto& r = result.m;
+
+    r[0][0] = (m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * inverse;
+    r[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * inverse;
+    r[0][2] = (m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * inverse;
+    r[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * inverse;
+
+    r[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * inverse;
+    r[1][1] = (m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * inverse;
+    r[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * inverse;
+    r[1][3] = (m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * inverse;
+
+    r[2][0] = (m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * inverse;
+    r[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * inverse;
+    r[2][2] = (m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * inverse;
+    r[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * inverse;
+
+    r[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * inverse;
+    r[3][1] = (m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * inverse;
+    r[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * inverse;
+    r[3][3] = (m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * inverse;
+
+    return true;
+}
+
+MathUtils::Float3 MathUtils::UnprojectToWorldPlaneXY(const Float4x4& view, const Float4x4& projection, float ndcX, float ndcY) noexcept
+{
+    Float4x4 projectionInv = Identity();
+    Float4x4 viewInv = Identity();
+
+    Invert(projection, projectionInv);
+    Invert(view, viewInv);
+
+    // 3 coordinates that defines XY-plane (in camera coordinates).
+    const Float4 worldOInCamera = Transform({ 0.0f, 0.0f, 0.0f, 1.0f }, view);
+    const Float4 worldXInCamera = Transform({ 1.0f, 0.0f, 0.0f, 1.0f }, view);
+    const Float4 worldYInCamera = Transform({ 0.0f, 1.0f, 0.0f, 1.0f }, view);
+
+    // Unproject point (in camera coordinates).
+    const Float4 unprojected = Transform({ ndcX, ndcY, 0.0f, 1.0f }, projectionInv);
+
+    // Define equation Ax = b to calculate the intersection of the unprojected direction and XY world plane.
+    Float4x4 A = Identity();
+    A.m[0][0] = worldXInCamera.x - worldOInCamera.x;
+    A.m[0][1] = worldXInCamera.y - worldOInCamera.y;
+    A.m[0][2] = worldXInCamera.z - worldOInCamera.z;
+    A.m[1][0] = worldYInCamera.x - worldOInCamera.x;
+    A.m[1][1] = worldYInCamera.y - worldOInCamera.y;
+    A.m[1][2] = worldYInCamera.z - worldOInCamera.z;
+    A.m[2][0] = -unprojected.x;
+    A.m[2][1] = -unprojected.y;
+    A.m[2][2] = -unprojected.z;
+
+    // The camera sits at the origin of camera coordinates.
+    const Float4 b = { -worldOInCamera.x, -worldOInCamera.y, -worldOInCamera.z, 1.0f };
+
+    // Calculate solution for x.
+    Float4x4 AInv = Identity();
+    Invert(A, AInv);
+    const Float4 solution = Transform(b, AInv);
+
+    const Float4 resultPositionInCamera = { unprojected.x * solution.z, unprojected.y * solution.z, unprojected.z * solution.z, 1.0f };
+    const Float4 resultPositionInWorld = Transform(resultPositionInCamera, viewInv);
+
+    return { resultPositionInWorld.x, resultPositionInWorld.y, resultPositionInWorld.z };
+}
@@ -0,0 +1,69 @@
+#ifndef _MATHUTILS_H_
+#define _MATHUTILS_H_
+
+// Minimal vector and matrix math for the platform independent code. Matrices are row major and
+// vectors are rows multiplied from the left, the same conventions and memory layout as
+// DirectX::SimpleMath, so matrices can be copied between the two.
+namespace MathUtils
+{
+    struct Float2
+    {
+        float x, y;
+    };
+
+    struct Float3
+    {
+        float x, y, z;
+    };
+
+    struct Float4
+    {
+        float x, y, z, w;
+    };
+
+    struct Float4x4
+    {
+        float m[4][4];
+    };
+
+    constexpr float s_Pi = 3.141592654f;
+
+    constexpr float ToRadians(float degrees) noexcept
+    {
+        return degrees * (s_Pi / 180.0f);
+    }
+
+    float Dot(const Float3& a, const Float3& b) noexcept;
+    Float3 Cross(const Float3& a, const Float3& b) noexcept;
+    Float3 Normalize(const Float3& v) noexcept;
+
+    Float4x4 Identity() noexcept;
+    Float4x4 Multiply(const Float4x4& a, const Float4x4& b) noexcept;
+    Float4 Transform(const Float4& v, const Float4x4& matrix) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Transform a point (w = 1) and divide the result by w.
+    //--------------------------------------------------------------------------------------
+    Float3 TransformCoord(const Float3& v, const Float4x4& matrix) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Matrix builders matching XMMatrixRotationRollPitchYaw, XMMatrixLookAtLH and
+    // XMMatrixPerspectiveFovLH. Angles are in radians.
+    //--------------------------------------------------------------------------------------
+    Float4x4 RotationRollPitchYaw(float pitch, float yaw, float roll) noexcept;
+    Float4x4 LookAtLH(const Float3& position, const Float3& lookAt, const Float3& up) noexcept;
+    Float4x4 PerspectiveFovLH(float fieldOfView, float aspectRatio, float nearZ, float farZ) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // General 4x4 inverse. Returns false and leaves result untouched for singular matrices.
+    //--------------------------------------------------------------------------------------
+    bool Invert(const Float4x4& matrix, Float4x4& result) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Intersect the ray through a point in normalized device coordinates with the world XY
+    // plane (z = 0), following the camera described by the view and projection matrices.
+    //--------------------------------------------------------------------------------------
+    Float3 UnprojectToWorldPlaneXY(const Float4x4& view, const Float4x4& projection, float ndcX, float ndcY) noexcept;
+};
+
+#endif
@@ -0,0 +1,51 @@
+#include "MemoryClass.h"
+
+#include "Clock.h"
+#include "Platform.h"
+
+void MemoryClass::Initialize()
+{
+    m_stats = MemoryStats{};
+
+    for (size_t i = 0; i < MemoryTracker::s_TagCount; ++i)
+    {
+        m_stats.Tags[i].Totals = MemoryTracker::GetTagStats(static_cast<MemoryTracker::Tag>(i));
+    }
+
+    UpdateResidentSize();
+
+    return;
+}
+
+void MemoryClass::Frame()
+{
+    // Count the allocations made since the previous frame.
+    for (size_t i = 0; i < MemoryTracker::s_TagCount; ++i)
+    {
+        auto& usage = m_stats.Tags[i];
+        const auto totals = MemoryTracker::GetTagStats(static_cast<MemoryTracker::Tag>(i));
+
+        usage.AllocationsPerFrame = totals.Allocations - usage.Totals.Allocations;
+        usage.Totals = totals;
+    }
+
+    if (Clock::Now() - m_lastSampleTime >= Clock::s_NanosecondsPerSecond)
+    {
+        UpdateResidentSize();
+    }
+
+    return;
+}
+
+const MemoryStats& MemoryClass::GetMemoryStats() const noexcept
+{
+    return m_stats;
+}
+
+void MemoryClass::UpdateResidentSize()
+{
+    m_lastSampleTime = Clock::Now();
+
+    // Keep the previous figures if the process counters cannot be read.
+    Platform::GetProcessMemory(m_stats.ResidentBytes, m_stats.PeakResidentBytes);
+}
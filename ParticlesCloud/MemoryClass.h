@@ -0,0 +1,40 @@
+#ifndef _MEMORYCLASS_H_
+#define _MEMORYCLASS_H_
+
+#include <array>
+#include <cstdint>
+
+#include "MemoryTracker.h"
+
+struct MemoryTagUsage
+{
+    MemoryTracker::TagStats Totals;
+    uint64_t AllocationsPerFrame = 0;
+};
+
+struct MemoryStats
+{
+    uint64_t ResidentBytes = 0;
+    uint64_t PeakResidentBytes = 0;
+    std::array<MemoryTagUsage, MemoryTracker::s_TagCount> Tags = {};
+};
+
+// Collects the tagged allocation counters every frame and the process resident set size once per
+// second, reading it is a system call.
+class MemoryClass
+{
+public:
+    void Initialize();
+    void Frame();
+
+    const MemoryStats& GetMemoryStats() const noexcept;
+
+private:
+    void UpdateResidentSize();
+
+private:
+    MemoryStats m_stats;
+    uint64_t m_lastSampleTime = 0;
+};
+
+#endif
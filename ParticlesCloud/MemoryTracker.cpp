@@ -0,0 +1,81 @@
+#include "MemoryTracker.h"
+
+#include <array>
+#include <atomic>
+
+namespace
+{
+    struct TagCounters
+    {
+        std::atomic<uint64_t> CurrentBytes{ 0 };
+        std::atomic<uint64_t> PeakBytes{ 0 };
+        std::atomic<uint64_t> Allocations{ 0 };
+        std::atomic<uint64_t> Frees{ 0 };
+    };
+
+    std::array<TagCounters, MemoryTracker::s_TagCount> s_Counters;
+
+    TagCounters& GetCounters(MemoryTracker::Tag tag) noexcept
+    {
+        return s_Counters[static_cast<size_t>(tag)];
+    }
+}
+
+std::string_view MemoryTracker::GetTagName(Tag tag) noexcept
+{
+    switch (tag)
+    {
+        case Tag::ParticlesStore:
+            return "particles_store";
+        case Tag::ParticlesUpload:
+            return "particles_upload";
+        case Tag::ParticlesStates:
+            return "particles_states";
+        case Tag::ParticlesIndices:
+            return "particles_indices";
+        case Tag::GpuParticles:
+            return "gpu_particles";
+        case Tag::GpuIndices:
+            return "gpu_indices";
+        case Tag::Text:
+            return "text";
+        case Tag::GpuText:
+            return "gpu_text";
+        default:
+            return "unknown";
+    }
+}
+
+void MemoryTracker::OnAllocate(Tag tag, size_t bytes) noexcept
+{
+    auto& counters = GetCounters(tag);
+
+    counters.Allocations.fetch_add(1, std::memory_order_relaxed);
+    const auto current = counters.CurrentBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    // Raise the peak unless another thread already raised it further.
+    auto peak = counters.PeakBytes.load(std::memory_order_relaxed);
+    while (current > peak && !counters.PeakBytes.compare_exchange_weak(peak, current, std::memory_order_relaxed))
+    {
+    }
+}
+
+void MemoryTracker::OnFree(Tag tag, size_t bytes) noexcept
+{
+    auto& counters = GetCounters(tag);
+
+    counters.Frees.fetch_add(1, std::memory_order_relaxed);
+    counters.CurrentBytes.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+MemoryTracker::TagStats MemoryTracker::GetTagStats(Tag tag) noexcept
+{
+    const auto& counters = GetCounters(tag);
+
+    return TagStats{
+        counters.CurrentBytes.load(std::memory_order_relaxed),
+        counters.PeakBytes.load(std::memory_order_relaxed),
+        counters.Allocations.load(std::memory_order_relaxed),
+        counters.Frees.load(std::memory_order_relaxed),
+    };
+}
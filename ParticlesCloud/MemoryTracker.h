@@ -0,0 +1,106 @@
+#ifndef _MEMORYTRACKER_H_
+#define _MEMORYTRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string_view>
+#include <vector>
+
+// Byte and allocation counters per subsystem. CPU containers are tracked through Allocator,
+// GPU buffers are reported with OnAllocate/OnFree when they are created and released.
+namespace MemoryTracker
+{
+    enum class Tag : uint32_t
+    {
+        ParticlesStore,
+        ParticlesUpload,
+        ParticlesStates,
+        ParticlesIndices,
+        GpuParticles,
+        GpuIndices,
+        Text,
+        GpuText,
+        Count
+    };
+
+    constexpr size_t s_TagCount = static_cast<size_t>(Tag::Count);
+
+    struct TagStats
+    {
+        uint64_t CurrentBytes = 0;
+        uint64_t PeakBytes = 0;
+        uint64_t Allocations = 0;
+        uint64_t Frees = 0;
+    };
+
+    std::string_view GetTagName(Tag tag) noexcept;
+
+    void OnAllocate(Tag tag, size_t bytes) noexcept;
+    void OnFree(Tag tag, size_t bytes) noexcept;
+    TagStats GetTagStats(Tag tag) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Standard allocator that reports every allocation under the given tag.
+    //--------------------------------------------------------------------------------------
+    template<typename T, Tag tag>
+    class Allocator
+    {
+    public:
+        using value_type = T;
+
+        template<typename U>
+        struct rebind
+        {
+            using other = Allocator<U, tag>;
+        };
+
+        Allocator() noexcept = default;
+
+        template<typename U>
+        Allocator(const Allocator<U, tag>&) noexcept
+        {
+        }
+
+        T* allocate(size_t count)
+        {
+            void* pointer;
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                pointer = ::operator new(count * sizeof(T), std::align_val_t{ alignof(T) });
+            }
+            else
+            {
+                pointer = ::operator new(count * sizeof(T));
+            }
+
+            OnAllocate(tag, count * sizeof(T));
+            return static_cast<T*>(pointer);
+        }
+
+        void deallocate(T* pointer, size_t count) noexcept
+        {
+            OnFree(tag, count * sizeof(T));
+
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            {
+                ::operator delete(pointer, std::align_val_t{ alignof(T) });
+            }
+            else
+            {
+                ::operator delete(pointer);
+            }
+        }
+
+        template<typename U>
+        bool operator==(const Allocator<U, tag>&) const noexcept
+        {
+            return true;
+        }
+    };
+
+    template<typename T, Tag tag>
+    using Vector = std::vector<T, Allocator<T, tag>>;
+};
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef _PARALLELUTILS_H_
+#define _PARALLELUTILS_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ParallelUtils
+{
+    //--------------------------------------------------------------------------------------
+    // Number of worker threads to use when the caller does not ask for a specific count.
+    //--------------------------------------------------------------------------------------
+    inline size_t GetDefaultThreadCount() noexcept
+    {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Split [0, count) into contiguous chunks and call function(begin, end, chunkIndex) for
+    // each chunk on its own thread. The calling thread processes the first chunk.
+    //--------------------------------------------------------------------------------------
+    template<typename Function>
+    void ParallelFor(size_t count, size_t threadCount, Function&& function)
+    {
+        threadCount = std::clamp<size_t>(threadCount, 1, std::max<size_t>(count, 1));
+        const size_t chunkSize = (count + threadCount - 1) / threadCount;
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+
+        for (size_t chunk = 1; chunk < threadCount; ++chunk)
+        {
+            const size_t begin = std::min(chunk * chunkSize, count);
+            const size_t end = std::min(begin + chunkSize, count);
+            workers.emplace_back([&function, begin, end, chunk]() { function(begin, end, chunk); });
+        }
+
+        function(size_t{ 0 }, std::min(chunkSize, count), size_t{ 0 });
+
+        for (auto& worker : workers)
+        {
+            worker.join();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "ParticlesGenerator.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+#include "WorkerPool.h"
+
+ParticlesGenerator::ParticlesGenerator()
+    : m_count(0)
+    , m_taken(0)
+    , m_generated(0)
+    , m_stop(false)
+{
+}
+
+ParticlesGenerator::~ParticlesGenerator()
+{
+    Stop();
+}
+
+void ParticlesGenerator::Start(size_t count, float extent, size_t threadCount)
+{
+    Stop();
+
+    m_count = count;
+    m_taken = 0;
+
+    // The first chunk is ready at once, so the first frame already has particles to show.
+    const size_t first = std::min(count, s_ChunkSize);
+    m_ready.push_back(Generate(0, first, extent));
+    m_generated = first;
+    m_stop = false;
+
+    // A wave never holds more chunks than may wait to be taken, otherwise there is never room
+    // for the next one.
+    if (m_generated < m_count)
+    {
+        m_thread = std::thread(
+            &ParticlesGenerator::GeneratorThread, this, extent, std::clamp<size_t>(threadCount, 1, s_MaxReadyChunks));
+    }
+}
+
+void ParticlesGenerator::Start(ParticlesStore&& particles)
+{
+    Stop();
+
+    m_count = particles.Size();
+    m_taken = 0;
+
+    auto& chunk = m_ready.emplace_back();
+    chunk.Particles = std::move(particles);
+    m_generated = m_count;
+    m_stop = false;
+}
+
+void ParticlesGenerator::Stop()
+{
+    if (m_thread.joinable())
+    {
+        {
+            std::lock_guard lock{ m_mutex };
+            m_stop = true;
+        }
+        m_changed.notify_all();
+
+        m_thread.join();
+    }
+
+    m_ready.clear();
+    m_count = 0;
+    m_taken = 0;
+    m_generated = 0;
+}
+
+bool ParticlesGenerator::TryTake(Chunk& chunk)
+{
+    {
+        std::lock_guard lock{ m_mutex };
+        if (m_ready.empty())
+        {
+            return false;
+        }
+
+        chunk = std::move(m_ready.front());
+        m_ready.pop_front();
+    }
+    m_changed.notify_all();
+
+    m_taken += chunk.Particles.Size();
+
+    return true;
+}
+
+size_t ParticlesGenerator::GetCount() const noexcept
+{
+    return m_count;
+}
+
+size_t ParticlesGenerator::GetTaken() const noexcept
+{
+    return m_taken;
+}
+
+void ParticlesGenerator::GeneratorThread(float extent, size_t threadCount)
+{
+    std::vector<Chunk> wave(threadCount);
+    WorkerPool workers;
+
+    Profiler::SetThreadName("Generator");
+
+    // The workers are started once for all waves.
+    workers.Initialize(threadCount, "GeneratorWorker");
+
+    for (;;)
+    {
+        size_t begin = 0;
+        size_t chunks = 0;
+
+        // Wait for room for a whole wave, so the workers are not started for one chunk at a time.
+        {
+            std::unique_lock lock{ m_mutex };
+            m_changed.wait(lock, [&]() { return m_stop || m_ready.size() + threadCount <= s_MaxReadyChunks; });
+            if (m_stop || m_generated == m_count)
+            {
+                return;
+            }
+
+            begin = m_generated;
+            chunks = std::min(threadCount, (m_count - begin + s_ChunkSize - 1) / s_ChunkSize);
+        }
+
+        workers.ParallelFor(chunks, [&](size_t first, size_t last, size_t) {
+            PROFILE_ZONE("GenerateParticles");
+            for (size_t i = first; i < last; ++i)
+            {
+                const size_t chunkBegin = begin + i * s_ChunkSize;
+                wave[i] = Generate(chunkBegin, std::min(s_ChunkSize, m_count - chunkBegin), extent);
+            }
+        });
+
+        {
+            std::lock_guard lock{ m_mutex };
+            for (size_t i = 0; i < chunks; ++i)
+            {
+                m_generated += wave[i].Particles.Size();
+                m_ready.push_back(std::move(wave[i]));
+            }
+        }
+    }
+}
+
+ParticlesGenerator::Chunk ParticlesGenerator::Generate(size_t begin, size_t count, float extent)
+{
+    Chunk chunk;
+
+    chunk.Begin = begin;
+    chunk.Particles.GenerateUniformCube(count, extent, begin);
+
+    return chunk;
+}
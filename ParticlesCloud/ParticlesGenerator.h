@@ -0,0 +1,80 @@
+#ifndef _PARTICLESGENERATOR_H_
+#define _PARTICLESGENERATOR_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "ParticlesStore.h"
+
+// Generates the particle cloud in chunks on a background thread, so rendering can start with the
+// first chunk while the rest is still being made. Chunks are handed out in order. At most
+// s_MaxReadyChunks wait to be taken, so the generator never runs far ahead of the consumer and
+// the memory of the cloud is not held twice.
+class ParticlesGenerator
+{
+public:
+    static constexpr size_t s_ChunkSize = ParticlesStore::s_GenerationBlock;
+    static constexpr size_t s_MaxReadyChunks = 64;
+
+    struct Chunk
+    {
+        // Index of the first particle of the chunk in the cloud.
+        size_t Begin = 0;
+        ParticlesStore Particles;
+    };
+
+public:
+    ParticlesGenerator();
+    ParticlesGenerator(const ParticlesGenerator&) = delete;
+    ParticlesGenerator& operator=(const ParticlesGenerator&) = delete;
+    ~ParticlesGenerator();
+
+    //--------------------------------------------------------------------------------------
+    // Generate the uniform cube of count particles. The first chunk is made before Start
+    // returns, the others on the background thread with threadCount workers.
+    //--------------------------------------------------------------------------------------
+    void Start(size_t count, float extent, size_t threadCount);
+
+    //--------------------------------------------------------------------------------------
+    // Hand out particles that are already loaded, as one chunk.
+    //--------------------------------------------------------------------------------------
+    void Start(ParticlesStore&& particles);
+
+    //--------------------------------------------------------------------------------------
+    // Stop the background thread after the chunks it is generating, and drop the chunks
+    // that were not taken.
+    //--------------------------------------------------------------------------------------
+    void Stop();
+
+    //--------------------------------------------------------------------------------------
+    // Take the next chunk in order. Returns false when it is not ready yet or every chunk
+    // was taken. Never blocks on the generation.
+    //--------------------------------------------------------------------------------------
+    bool TryTake(Chunk& chunk);
+
+    // Particles of the whole cloud and the ones handed out so far, for the thread that takes
+    // the chunks.
+    size_t GetCount() const noexcept;
+    size_t GetTaken() const noexcept;
+
+private:
+    void GeneratorThread(float extent, size_t threadCount);
+    static Chunk Generate(size_t begin, size_t count, float extent);
+
+private:
+    size_t m_count;
+    size_t m_taken;
+    std::thread m_thread;
+
+    // Guards everything below.
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::deque<Chunk> m_ready;
+    size_t m_generated;
+    bool m_stop;
+};
+
+#endif
@@ -0,0 +1,28 @@
+#include "ParticlesGeometry.h"
+
+ParticlesGeometry::IndexBuffer ParticlesGeometry::GenerateIndexBuffer(size_t particlesNumber)
+{
+    IndexBuffer indecies;
+    GenerateIndexRange(indecies, 0, particlesNumber);
+
+    return indecies;
+}
+
+void ParticlesGeometry::GenerateIndexRange(IndexBuffer& indices, size_t begin, size_t end)
+{
+    indices.clear();
+    indices.reserve((end - begin) * s_IndicesPerParticle);
+
+    for (auto i = static_cast<uint32_t>(begin); i < end; ++i)
+    {
+        // First triangle.
+        indices.push_back(i * 4 + 0);
+        indices.push_back(i * 4 + 1);
+        indices.push_back(i * 4 + 2);
+
+        // Second triangle.
+        indices.push_back(i * 4 + 0);
+        indices.push_back(i * 4 + 2);
+        indices.push_back(i * 4 + 3);
+    }
+}
@@ -0,0 +1,28 @@
+#ifndef _PARTICLESGEOMETRY_H_
+#define _PARTICLESGEOMETRY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MemoryTracker.h"
+
+namespace ParticlesGeometry
+{
+    constexpr size_t s_VerticesPerParticle = 4;
+    constexpr size_t s_IndicesPerParticle = 6;
+
+    using IndexBuffer = MemoryTracker::Vector<uint32_t, MemoryTracker::Tag::ParticlesIndices>;
+
+    //--------------------------------------------------------------------------------------
+    // Two triangles per particle quad, vertices 0-1-2 and 0-2-3 of every group of four.
+    //--------------------------------------------------------------------------------------
+    IndexBuffer GenerateIndexBuffer(size_t particlesNumber);
+
+    //--------------------------------------------------------------------------------------
+    // Replace the indices with the ones of particles [begin, end), to upload a range of the
+    // index buffer.
+    //--------------------------------------------------------------------------------------
+    void GenerateIndexRange(IndexBuffer& indices, size_t begin, size_t end);
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "ParticlesLoader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+#include "ParallelUtils.h"
+#include "Profiler.h"
+
+bool ParticlesLoader::Load(std::string_view filename, ParticlesStore& store)
+{
+    MappedFile file;
+    ParticlesFileHeader header;
+
+    m_errorMessage.clear();
+
+    // Map the whole file, the sections are consumed straight from the mapping.
+    if (!file.Open(filename))
+    {
+        m_errorMessage = "Could not open the particles file.";
+        return false;
+    }
+
+    if (file.GetSize() < sizeof(ParticlesFileHeader))
+    {
+        m_errorMessage = "The particles file is too small to hold a header.";
+        return false;
+    }
+
+    std::memcpy(&header, file.GetData(), sizeof(ParticlesFileHeader));
+
+    if (!ValidateHeader(header, file.GetSize()))
+    {
+        return false;
+    }
+
+    const size_t count = static_cast<size_t>(header.Count);
+    const bool hasMass = (header.Flags & ParticlesFileHasMass) != 0;
+
+    const auto* positions = reinterpret_cast<const float*>(file.GetData() + header.PositionsOffset);
+    const auto* velocities = reinterpret_cast<const float*>(file.GetData() + header.VelocitiesOffset);
+    const auto* masses = hasMass ? reinterpret_cast<const float*>(file.GetData() + header.MassOffset) : nullptr;
+
+    store.Clear();
+    store.Resize(count);
+
+    // Every chunk de-interleaves its own range and reports whether it met a value the simulation can not use.
+    const size_t threadCount = ParallelUtils::GetDefaultThreadCount();
+    std::vector<uint8_t> chunkValid(threadCount, 1);
+
+    ParallelUtils::ParallelFor(count, threadCount, [&](size_t begin, size_t end, size_t chunk) {
+        PROFILE_ZONE("LoadParticles");
+        bool valid = true;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            const float* position = positions + i * 3;
+            const float* velocity = velocities + i * 3;
+
+            store.PositionX[i] = position[0];
+            store.PositionY[i] = position[1];
+            store.PositionZ[i] = position[2];
+
+            store.VelocityX[i] = velocity[0];
+            store.VelocityY[i] = velocity[1];
+            store.VelocityZ[i] = velocity[2];
+
+            valid &= std::isfinite(position[0]) && std::isfinite(position[1]) && std::isfinite(position[2]);
+            valid &= std::isfinite(velocity[0]) && std::isfinite(velocity[1]) && std::isfinite(velocity[2]);
+        }
+
+        if (masses)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                store.Mass[i] = masses[i];
+                valid &= std::isfinite(masses[i]) && masses[i] > 0.0f;
+            }
+        }
+
+        chunkValid[chunk] = valid;
+    });
+
+    for (const auto valid : chunkValid)
+    {
+        if (!valid)
+        {
+            m_errorMessage = "The particles file contains non-finite values or non-positive masses.";
+            store.Clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ParticlesLoader::Save(std::string_view filename, const ParticlesStore& store)
+{
+    std::ofstream fout{ std::string(filename), std::ios::binary };
+    ParticlesFileHeader header{};
+
+    m_errorMessage.clear();
+
+    if (store.Size() == 0)
+    {
+        m_errorMessage = "There are no particles to save.";
+        return false;
+    }
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not create the particles file.";
+        return false;
+    }
+
+    const auto align = [](uint64_t offset) { return (offset + s_SectionAlignment - 1) / s_SectionAlignment * s_SectionAlignment; };
+    const uint64_t count = store.Size();
+
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.Count = count;
+    header.Flags = ParticlesFileHasMass;
+    header.PositionsOffset = align(sizeof(ParticlesFileHeader));
+    header.VelocitiesOffset = align(header.PositionsOffset + count * sizeof(float) * 3);
+    header.MassOffset = align(header.VelocitiesOffset + count * sizeof(float) * 3);
+
+    const char padding[s_SectionAlignment] = {};
+    uint64_t written = 0;
+    const auto write = [&](const void* data, uint64_t size) {
+        fout.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        written += size;
+    };
+    const auto pad = [&](uint64_t offset) { write(padding, offset - written); };
+
+    // The components are interleaved again through a small buffer, one piece of the cloud at a time.
+    std::vector<float> interleaved;
+    const auto writeVectors = [&](const ParticlesStore::Array<float>& x,
+                                  const ParticlesStore::Array<float>& y,
+                                  const ParticlesStore::Array<float>& z) {
+        for (size_t begin = 0; begin < count; begin += ParticlesStore::s_GenerationBlock)
+        {
+            const size_t end = std::min<size_t>(begin + ParticlesStore::s_GenerationBlock, count);
+
+            interleaved.resize((end - begin) * 3);
+            for (size_t i = begin; i < end; ++i)
+            {
+                interleaved[(i - begin) * 3 + 0] = x[i];
+                interleaved[(i - begin) * 3 + 1] = y[i];
+                interleaved[(i - begin) * 3 + 2] = z[i];
+            }
+            write(interleaved.data(), interleaved.size() * sizeof(float));
+        }
+    };
+
+    write(&header, sizeof(header));
+    pad(header.PositionsOffset);
+    writeVectors(store.PositionX, store.PositionY, store.PositionZ);
+    pad(header.VelocitiesOffset);
+    writeVectors(store.VelocityX, store.VelocityY, store.VelocityZ);
+    pad(header.MassOffset);
+    write(store.Mass.data(), count * sizeof(float));
+
+    if (fout.fail())
+    {
+        m_errorMessage = "Could not write the particles file.";
+        return false;
+    }
+
+    return true;
+}
+
+const std::string& ParticlesLoader::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
+
+bool ParticlesLoader::ValidateHeader(const ParticlesFileHeader& header, size_t fileSize)
+{
+    if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0)
+    {
+        m_errorMessage = "The file is not a particles file.";
+        return false;
+    }
+
+    if (header.Version != s_Version)
+    {
+        m_errorMessage = "Unsupported particles file version.";
+        return false;
+    }
+
+    if ((header.Flags & ~static_cast<uint32_t>(ParticlesFileHasMass)) != 0)
+    {
+        m_errorMessage = "The particles file uses unknown flags.";
+        return false;
+    }
+
+    if (header.Count == 0)
+    {
+        m_errorMessage = "The particles file is empty.";
+        return false;
+    }
+
+    // Reject sizes that would overflow the section bounds checks below.
+    if (header.Count > fileSize / (sizeof(float) * 6))
+    {
+        m_errorMessage = "The particles file is truncated.";
+        return false;
+    }
+
+    bool result = ValidateSection(header.PositionsOffset, sizeof(float) * 3, header.Count, fileSize);
+    result = result && ValidateSection(header.VelocitiesOffset, sizeof(float) * 3, header.Count, fileSize);
+
+    if (result && (header.Flags & ParticlesFileHasMass))
+    {
+        result = ValidateSection(header.MassOffset, sizeof(float), header.Count, fileSize);
+    }
+
+    return result;
+}
+
+bool ParticlesLoader::ValidateSection(uint64_t offset, uint64_t elementSize, uint64_t count, size_t fileSize)
+{
+    if (offset < sizeof(ParticlesFileHeader) || offset % s_SectionAlignment != 0)
+    {
+        m_errorMessage = "The particles file has a misplaced section.";
+        return false;
+    }
+
+    if (offset > fileSize || elementSize * count > fileSize - offset)
+    {
+        m_errorMessage = "The particles file is truncated.";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,60 @@
+#ifndef _PARTICLESLOADER_H_
+#define _PARTICLESLOADER_H_
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "ParticlesStore.h"
+
+// Loads an externally generated initial condition into a ParticlesStore, and saves a store in the
+// same format.
+//
+// File layout (little endian, every section 16-byte aligned):
+//   ParticlesFileHeader
+//   float[Count * 3]  positions   (x, y, z per particle)
+//   float[Count * 3]  velocities  (x, y, z per particle)
+//   float[Count]      masses      (only if ParticlesFileHasMass is set)
+// Offsets in the header are measured from the beginning of the file.
+class ParticlesLoader
+{
+public:
+    static constexpr char s_Magic[4] = { 'P', 'C', 'L', 'D' };
+    static constexpr uint32_t s_Version = 1;
+    static constexpr uint32_t s_SectionAlignment = 16;
+
+    enum ParticlesFileFlags : uint32_t
+    {
+        ParticlesFileHasMass = 1u << 0,
+    };
+
+    struct ParticlesFileHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Count;
+        uint32_t Flags;
+        uint32_t Reserved;
+        uint64_t PositionsOffset;
+        uint64_t VelocitiesOffset;
+        uint64_t MassOffset;
+    };
+
+public:
+    bool Load(std::string_view filename, ParticlesStore& store);
+
+    //--------------------------------------------------------------------------------------
+    // Write the positions, velocities and masses of the store, for Load and the viewer.
+    //--------------------------------------------------------------------------------------
+    bool Save(std::string_view filename, const ParticlesStore& store);
+    const std::string& GetErrorMessage() const noexcept;
+
+private:
+    bool ValidateHeader(const ParticlesFileHeader& header, size_t fileSize);
+    bool ValidateSection(uint64_t offset, uint64_t elementSize, uint64_t count, size_t fileSize);
+
+private:
+    std::string m_errorMessage;
+};
+
+#endif
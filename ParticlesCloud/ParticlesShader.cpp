@@ -3,42 +3,44 @@
 #include "ParticlesShader.h"
 
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
-#include <random>
 
 #include "DirectXUtils.h"
+#include "MathUtils.h"
+#include "ParticlesGeometry.h"
+#include "ParallelUtils.h"
+#include "ParticlesLoader.h"
+#include "Profiler.h"
+#include "WellPath.h"
+
+using ParticlesGeometry::s_IndicesPerParticle;
+using ParticlesGeometry::s_VerticesPerParticle;
 
 ParticlesShader::ParticlesShader()
     : m_vertexShader(nullptr)
     , m_pixelShader(nullptr)
     , m_computeShader(nullptr)
-    , m_sampleState(nullptr)
+    , m_projectShader(nullptr)
     , m_csParametersBuffer(nullptr)
     , m_particlesBuffer(nullptr)
+    , m_indexBuffer(nullptr)
+    , m_statesBuffers{}
     , m_particlesUAV(nullptr)
     , m_particlesSRV(nullptr)
+    , m_statesSRVs{}
+    , m_particlesCapacity(0)
+    , m_particlesNumber(0)
+    , m_currentStates(0)
+    , m_simulationAccumulator(0.0f)
+    , m_sampleState(nullptr)
+    , m_stepInputTime(0)
+    , m_presentedInputTime(0)
     , m_ScreenWidth(0)
     , m_ScreenHeight(0)
-    , m_lastSampleTime(std::chrono::high_resolution_clock::time_point::max())
-    , m_indexDataBuffer(GenerateIndexBuffer(s_ParticlesNumber))
+    , m_frameMilliseconds(0.0f)
 {
-    std::uniform_real_distribution<float> positionDistribution(-25.5f, 25.5f);
-    std::default_random_engine generator;
-
-    m_particlesDataBuffer.reserve(s_VerticesNumber);
-     for (int i = 0; i < s_ParticlesNumber; ++i)
-    {
-        const auto particle = ParticleDataType{
-            Vector4{ positionDistribution(generator), positionDistribution(generator), positionDistribution(generator), 1.0f },
-            Vector4{ 0.0f, 0.0f, 0.0f, 0.0f },
-            Vector3{ 0.0f, 0.0f, 0.0f },
-            0.0f
-        };
-        m_particlesDataBuffer.push_back(particle);
-        m_particlesDataBuffer.push_back(particle);
-        m_particlesDataBuffer.push_back(particle);
-        m_particlesDataBuffer.push_back(particle);
-    }
 }
 
 ParticlesShader::~ParticlesShader()
@@ -46,24 +48,75 @@ ParticlesShader::~ParticlesShader()
     Shutdown();
 }
 
-bool ParticlesShader::Initialize(ID3D11Device* device, HWND hwnd, const int screenWidth, const int screenHeight)
+bool ParticlesShader::Initialize(
+    ID3D11Device* device,
+    HWND hwnd,
+    const int screenWidth,
+    const int screenHeight,
+    const SceneParameters& parameters,
+    ShaderCache& shaders,
+    AssetManager& assets)
 {
     bool result;
 
-    // Initialize the vertex and pixel shaders.
-    result = InitializeShader(
+    // Start making the particles and decoding the texture.
+    result = LoadParticles(hwnd, parameters, assets);
+    if (!result)
+    {
+        return false;
+    }
+
+    // Initialize the vertex, pixel and compute shaders.
+    result = CreateShaders(device, hwnd, shaders);
+    if (!result)
+    {
+        return false;
+    }
+
+    // Create the GPU side buffers and the texture.
+    return CreateResources(device, screenWidth, screenHeight);
+}
+
+bool ParticlesShader::LoadParticles(HWND hwnd, const SceneParameters& parameters, AssetManager& assets)
+{
+    m_parameters = parameters;
+
+    // Start decoding the billboards texture, it loads while the particles and shaders are set up.
+    m_textureAsset = assets.Load("./assets/blue_texture.jpg");
+
+    // Start generating the particles or load them from the file.
+    return InitializeParticles(hwnd);
+}
+
+bool ParticlesShader::CreateShaders(ID3D11Device* device, HWND hwnd, ShaderCache& shaders)
+{
+    return InitializeShader(
         device,
         hwnd,
+        shaders,
         PWSTR(L"./shaders/particlesVS.hlsl"),
         PWSTR(L"./shaders/particlesPS.hlsl"),
         PWSTR(L"./shaders/particlesCS.hlsl"));
+}
+
+bool ParticlesShader::CreateResources(ID3D11Device* device, const int screenWidth, const int screenHeight)
+{
+    bool result;
+
+    // Create the GPU side particle and index buffers.
+    result = InitializeBuffers(device);
     if (!result)
     {
         return false;
     }
 
-    // Initialize billboards texture.
-    result = InitializeTexture(device, PWSTR(L"./assets/blue_texture.jpg"));
+    // Initialize billboards texture, the decoded image is not needed after the upload.
+    result = m_textureAsset && InitializeTexture(device, *m_textureAsset);
+    m_textureAsset.reset();
+    if (!result)
+    {
+        return false;
+    }
 
     m_ScreenWidth = screenWidth;
     m_ScreenHeight = screenHeight;
@@ -71,28 +124,86 @@ bool ParticlesShader::Initialize(ID3D11Device* device, HWND hwnd, const int scre
     return true;
 }
 
+bool ParticlesShader::ApplyParameters(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, const SceneParameters& parameters)
+{
+    const bool reloadParticles = parameters.ParticlesNumber != m_parameters.ParticlesNumber ||
+                                 parameters.SpawnExtent != m_parameters.SpawnExtent || parameters.ParticlesFile != m_parameters.ParticlesFile ||
+                                 parameters.SimulationThread != m_parameters.SimulationThread;
+    const bool recreateBuffers = parameters.SimulationThread != m_parameters.SimulationThread;
+
+    // Time scale, billboard size and orbit radius are read every frame, just take the new values.
+    m_parameters = parameters;
+
+    if (!reloadParticles)
+    {
+        return true;
+    }
+
+    const auto previousCapacity = m_particlesCapacity;
+
+    if (!InitializeParticles(hwnd))
+    {
+        return false;
+    }
+
+    // Keep the existing GPU buffers when the capacity did not change, the new particles join
+    // them from the start like at startup.
+    if (m_particlesCapacity == previousCapacity && !recreateBuffers)
+    {
+        return true;
+    }
+
+    ShutdownBuffers();
+
+    return InitializeBuffers(device);
+}
+
 void ParticlesShader::Shutdown()
 {
+    // Stop the generator and the simulation thread before the buffers they fill go away.
+    m_Generator.reset();
+    m_Simulation.reset();
+
+    ShutdownBuffers();
     ShutdownShader();
 }
 
-bool ParticlesShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, const Matrix& viewMatrix, const Matrix& projectionMatrix)
+bool ParticlesShader::Render(ID3D11DeviceContext* deviceContext, int indexCount, const CameraClass& camera)
 {
     bool result;
 
+    // Upload the particles the generator made since the previous frame.
+    JoinParticles(deviceContext);
+
     result = UpdateFrameDeltaTime();
     if (!result)
     {
         return false;
     }
 
-    result = UpdateGravityFieldPosition(viewMatrix, projectionMatrix);
+    result = UpdateGravityFieldPosition(camera);
     if (!result)
     {
         return false;
     }
 
-    result = UpdateTransformationMatrices(viewMatrix, projectionMatrix);
+    // Start the next step with the well of this frame and place the particles between the
+    // states of the previous ones.
+    if (m_Simulation)
+    {
+        UpdateSimulation(deviceContext);
+    }
+    else
+    {
+        // The compute shader steps the particles right before they are drawn.
+        WellPath::SetDeltaTime(m_CSParameters.DeltaTime, m_substeps);
+        ConsumeCursorPath();
+        m_presentedInputTime = m_stepInputTime;
+    }
+
+    // After the step, which may have added particles to the ones to draw.
+    result = UpdateTransformationMatrices(
+        DirectXUtils::ToMatrix(camera.GetViewMatrix()), DirectXUtils::ToMatrix(camera.GetProjectionMatrix()));
     if (!result)
     {
         return false;
@@ -106,14 +217,135 @@ bool ParticlesShader::Render(ID3D11DeviceContext* deviceContext, int indexCount,
     }
 
     // Now render the prepared buffers with the shader.
-    RenderShader(deviceContext, indexCount);
+    return RenderShader(deviceContext, indexCount);
+}
+
+bool ParticlesShader::InitializeParticles(HWND hwnd)
+{
+    // Create the particles generator object.
+    if (!m_Generator)
+    {
+        m_Generator = std::make_unique<ParticlesGenerator>();
+        if (!m_Generator)
+        {
+            return false;
+        }
+    }
+
+    // Either load an externally generated cloud or generate the uniform cube. The cube is made in
+    // chunks in the background and the first frames already draw the chunks that are ready.
+    if (m_parameters.ParticlesFile.empty())
+    {
+        // Leave the other cores to the render and simulation threads.
+        const size_t generatorThreads = std::max<size_t>(ParallelUtils::GetDefaultThreadCount() / 2, 1);
+        m_Generator->Start(m_parameters.ParticlesNumber, m_parameters.SpawnExtent, generatorThreads);
+    }
+    else
+    {
+        ParticlesLoader loader;
+        ParticlesStore particles;
+
+        if (!loader.Load(m_parameters.ParticlesFile, particles))
+        {
+            MessageBoxA(hwnd, loader.GetErrorMessage().c_str(), "Could not load the particles file", MB_OK);
+            return false;
+        }
+
+        m_Generator->Start(std::move(particles));
+    }
+
+    m_particlesCapacity = m_Generator->GetCount();
+    m_particlesNumber = 0;
+
+    // The particles join the simulation thread as they come, the compute shader only expands them.
+    if (!m_parameters.SimulationThread)
+    {
+        m_Simulation.reset();
+        return true;
+    }
+
+    if (!m_Simulation)
+    {
+        m_Simulation = std::make_unique<ParticlesSimulationThread>();
+        if (!m_Simulation)
+        {
+            return false;
+        }
+    }
+
+    // Leave a core to the render thread.
+    const size_t simulationThreads = std::max<size_t>(ParallelUtils::GetDefaultThreadCount() - 1, 1);
+    m_Simulation->Initialize(ParticlesStore{}, ParticlesSimulation::Kernel::Fast, simulationThreads, m_particlesCapacity);
+    m_simulationAccumulator = 0.0f;
 
     return true;
 }
 
+void ParticlesShader::JoinParticles(ID3D11DeviceContext* deviceContext)
+{
+    ParticlesGenerator::Chunk chunk;
+
+    // Particles handed to the simulation thread join at its next swap, take more after that.
+    if (m_Simulation && m_Simulation->HasPendingParticles())
+    {
+        return;
+    }
+
+    for (size_t taken = 0; taken < s_MaxChunksPerFrame && m_Generator->TryTake(chunk); ++taken)
+    {
+        PROFILE_ZONE("JoinParticles");
+
+        const size_t begin = chunk.Begin;
+        const size_t count = chunk.Particles.Size();
+
+        // Only the particles that joined are drawn, so the indices can go in ahead of them.
+        ParticlesGeometry::GenerateIndexRange(m_indexDataBuffer, begin, begin + count);
+        DirectXUtils::UpdateBufferRange(
+            deviceContext,
+            m_indexBuffer,
+            sizeof(uint32_t),
+            begin * s_IndicesPerParticle,
+            m_indexDataBuffer.size(),
+            m_indexDataBuffer.data());
+
+        // The simulation thread writes the states of the particles, UpdateSimulation uploads them.
+        if (m_Simulation)
+        {
+            m_Simulation->AddParticles(std::move(chunk.Particles));
+            continue;
+        }
+
+        // Every particle is drawn as a quad, so each one is replicated into four vertices. The mass
+        // travels in the w component of the world position.
+        const auto& particles = chunk.Particles;
+        m_particlesDataBuffer.resize(count * s_VerticesPerParticle);
+        for (size_t i = 0; i < count; ++i)
+        {
+            const auto particle = ParticleDataType{
+                Vector4{ particles.PositionX[i], particles.PositionY[i], particles.PositionZ[i], particles.Mass[i] },
+                Vector4{ 0.0f, 0.0f, 0.0f, 0.0f },
+                Vector3{ particles.VelocityX[i], particles.VelocityY[i], particles.VelocityZ[i] },
+                0.0f
+            };
+            std::fill_n(m_particlesDataBuffer.begin() + i * s_VerticesPerParticle, s_VerticesPerParticle, particle);
+        }
+
+        DirectXUtils::UpdateBufferRange(
+            deviceContext,
+            m_particlesBuffer,
+            sizeof(ParticleDataType),
+            begin * s_VerticesPerParticle,
+            m_particlesDataBuffer.size(),
+            m_particlesDataBuffer.data());
+
+        m_particlesNumber = begin + count;
+    }
+}
+
 bool ParticlesShader::InitializeShader(
     ID3D11Device* device,
     HWND hwnd,
+    ShaderCache& shaders,
     std::wstring_view vsFilename,
     std::wstring_view psFilename,
     std::wstring_view csFilename)
@@ -137,8 +369,7 @@ bool ParticlesShader::InitializeShader(
 #endif
 
     // Compile the vertex shader code.
-    result =
-        D3DCompileFromFile(vsFilename.data(), nullptr, nullptr, "ParticleVS", "vs_5_0", dwShaderFlags, 0, &vertexShaderBuffer, &errorMessage);
+    result = DirectXUtils::CompileShader(shaders, vsFilename, "ParticleVS", "vs_5_0", dwShaderFlags, &vertexShaderBuffer, &errorMessage);
     if (FAILED(result))
     {
         // If the shader failed to compile it should have writen something to the
@@ -158,8 +389,7 @@ bool ParticlesShader::InitializeShader(
     }
 
     // Compile the pixel shader code.
-    result =
-        D3DCompileFromFile(psFilename.data(), nullptr, nullptr, "ParticlePS", "ps_5_0", dwShaderFlags, 0, &pixelShaderBuffer, &errorMessage);
+    result = DirectXUtils::CompileShader(shaders, psFilename, "ParticlePS", "ps_5_0", dwShaderFlags, &pixelShaderBuffer, &errorMessage);
     if (FAILED(result))
     {
         // If the shader failed to compile it should have writen something to the
@@ -203,39 +433,85 @@ bool ParticlesShader::InitializeShader(
         return false;
     }
 
+    // The full step runs in the compute shader unless the simulation thread does it.
+    if (!InitializeComputeShader(device, hwnd, shaders, csFilename, "DefaultCS", &m_computeShader))
+    {
+        return false;
+    }
+
+    if (!InitializeComputeShader(device, hwnd, shaders, csFilename, "ProjectCS", &m_projectShader))
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool ParticlesShader::InitializeBuffers(ID3D11Device* device)
+{
+    HRESULT result;
+
+    // The buffers are made for every particle up front. D3D11 limits the size of each one, so
+    // a cloud too large for the device is refused here instead of getting truncated buffers.
+    // The particle buffer is the largest of them.
+    static_assert(sizeof(ParticleDataType) * s_VerticesPerParticle >= sizeof(uint32_t) * s_IndicesPerParticle);
+    static_assert(sizeof(ParticleDataType) * s_VerticesPerParticle >= sizeof(ParticleState));
+
+    const uint64_t particleSize = uint64_t{ sizeof(ParticleDataType) } * s_VerticesPerParticle;
+    const uint64_t particlesSize = particleSize * m_particlesCapacity;
+    const uint64_t indicesSize = uint64_t{ sizeof(uint32_t) } * s_IndicesPerParticle * m_particlesCapacity;
+    const uint64_t maxBufferSize = DirectXUtils::GetMaxBufferSize(device);
+
+    if (particlesSize > maxBufferSize)
+    {
+        constexpr uint64_t megabyte = 1024 * 1024;
+
+        char message[256];
+        std::snprintf(
+            message,
+            sizeof(message),
+            "The cloud of %llu particles needs a %llu MB particle buffer, but this device allows at most %llu MB per "
+            "buffer, enough for %llu particles.",
+            static_cast<unsigned long long>(m_particlesCapacity),
+            static_cast<unsigned long long>(particlesSize / megabyte),
+            static_cast<unsigned long long>(maxBufferSize / megabyte),
+            static_cast<unsigned long long>(maxBufferSize / particleSize));
+        MessageBoxA(nullptr, message, "Too many particles", MB_OK);
+        return false;
+    }
+
+    // The buffers are filled as the particles join.
     result = DirectXUtils::CreateStructuredBuffer(
         device,
         sizeof(ParticleDataType),
-        m_particlesDataBuffer.size(),
-        m_particlesDataBuffer.data(),
+        m_particlesCapacity * s_VerticesPerParticle,
+        nullptr,
         &m_particlesBuffer);
     if (FAILED(result))
     {
         return false;
     }
 
-    // Set up the description of the static index buffer.
+    DirectXUtils::TrackBuffer(m_particlesBuffer, MemoryTracker::Tag::GpuParticles);
+
+    // Set up the description of the index buffer.
     D3D11_BUFFER_DESC indexBufferDesc;
-    D3D11_SUBRESOURCE_DATA indexData;
     indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(unsigned long) * s_VertixIndeciesNumber;
+    indexBufferDesc.ByteWidth = static_cast<UINT>(indicesSize);
     indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
     indexBufferDesc.CPUAccessFlags = 0;
     indexBufferDesc.MiscFlags = 0;
     indexBufferDesc.StructureByteStride = 0;
 
-    // Give the subresource structure a pointer to the index data.
-    indexData.pSysMem = m_indexDataBuffer.data();
-    indexData.SysMemPitch = 0;
-    indexData.SysMemSlicePitch = 0;
-
     // Create the index buffer.
-    result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+    result = device->CreateBuffer(&indexBufferDesc, nullptr, &m_indexBuffer);
     if (FAILED(result))
     {
         return false;
     }
 
+    DirectXUtils::TrackBuffer(m_indexBuffer, MemoryTracker::Tag::GpuIndices);
+
     result = DirectXUtils::CreateBufferUAV(device, m_particlesBuffer, &m_particlesUAV);
     if (FAILED(result))
     {
@@ -248,20 +524,79 @@ bool ParticlesShader::InitializeShader(
         return false;
     }
 
-    const auto computeShaderInitResult = InitializeComputeShader(device, hwnd, csFilename);
+    if (!m_Simulation)
+    {
+        return true;
+    }
+
+    // Create the two buffers the states of the simulation thread are uploaded to in turn, the
+    // last step and the one before it.
+    m_currentStates = 0;
 
-    if (!computeShaderInitResult)
+    for (size_t i = 0; i < m_statesBuffers.size(); ++i)
     {
-        return false;
+        result = DirectXUtils::CreateStructuredBuffer(
+            device,
+            sizeof(ParticleState),
+            m_particlesCapacity,
+            nullptr,
+            &m_statesBuffers[i]);
+        if (FAILED(result))
+        {
+            return false;
+        }
+
+        DirectXUtils::TrackBuffer(m_statesBuffers[i], MemoryTracker::Tag::GpuParticles);
+
+        result = DirectXUtils::CreateBufferSRV(device, m_statesBuffers[i], &m_statesSRVs[i]);
+        if (FAILED(result))
+        {
+            return false;
+        }
     }
 
     return true;
 }
 
-bool ParticlesShader::InitializeTexture(ID3D11Device* device, std::wstring_view textureFilename)
+void ParticlesShader::ShutdownBuffers()
+{
+    DirectXUtils::UntrackBuffer(m_indexBuffer, MemoryTracker::Tag::GpuIndices);
+    DirectXUtils::UntrackBuffer(m_particlesBuffer, MemoryTracker::Tag::GpuParticles);
+
+    for (size_t i = 0; i < m_statesBuffers.size(); ++i)
+    {
+        DirectXUtils::UntrackBuffer(m_statesBuffers[i], MemoryTracker::Tag::GpuParticles);
+
+        DirectXUtils::SafeRelease(m_statesSRVs[i]);
+        DirectXUtils::SafeRelease(m_statesBuffers[i]);
+
+        m_statesSRVs[i] = nullptr;
+        m_statesBuffers[i] = nullptr;
+    }
+
+    DirectXUtils::SafeRelease(m_particlesSRV);
+    DirectXUtils::SafeRelease(m_particlesUAV);
+    DirectXUtils::SafeRelease(m_indexBuffer);
+    DirectXUtils::SafeRelease(m_particlesBuffer);
+
+    m_particlesSRV = nullptr;
+    m_particlesUAV = nullptr;
+    m_indexBuffer = nullptr;
+    m_particlesBuffer = nullptr;
+}
+
+bool ParticlesShader::InitializeTexture(ID3D11Device* device, const AssetManager::ImageAsset& texture)
 {
     bool result;
 
+    // Wait for the image, usually it was decoded in the meantime.
+    if (texture.Wait() != AssetManager::State::Ready)
+    {
+        return false;
+    }
+
+    const auto& image = texture.GetImage();
+
     // Create the texture object.
     m_Texture = std::make_unique<TextureClass>();
     if (!m_Texture)
@@ -270,7 +605,7 @@ bool ParticlesShader::InitializeTexture(ID3D11Device* device, std::wstring_view
     }
 
     // Initialize the texture object.
-    result = m_Texture->Initialize(device, textureFilename.data());
+    result = m_Texture->Initialize(device, image.Width, image.Height, image.Texels.data(), image.Pitch);
     if (!result)
     {
         return false;
@@ -311,14 +646,12 @@ void ParticlesShader::ShutdownShader()
         m_Texture.reset();
     }
 
-    DirectXUtils::SafeRelease(m_particlesBuffer);
     DirectXUtils::SafeRelease(m_csParametersBuffer);
     DirectXUtils::SafeRelease(m_sampleState);
     DirectXUtils::SafeRelease(m_pixelShader);
     DirectXUtils::SafeRelease(m_vertexShader);
     DirectXUtils::SafeRelease(m_computeShader);
-    DirectXUtils::SafeRelease(m_particlesUAV);
-    DirectXUtils::SafeRelease(m_particlesSRV);
+    DirectXUtils::SafeRelease(m_projectShader);
 }
 
 void ParticlesShader::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, std::wstring_view shaderFilename)
@@ -353,6 +686,26 @@ void ParticlesShader::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hw
 }
 
 bool ParticlesShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture)
+{
+    bool result;
+
+    // Write the compute shader parameters.
+    result = WriteCSParameters(deviceContext);
+    if (!result)
+    {
+        return false;
+    }
+
+    // Now set the constant buffer in the compute shader with the updated values.
+    deviceContext->CSSetConstantBuffers(0, 1, &m_csParametersBuffer);
+
+    // Set shader texture resource in the pixel shader.
+    deviceContext->PSSetShaderResources(0, 1, &texture);
+
+    return true;
+}
+
+bool ParticlesShader::WriteCSParameters(ID3D11DeviceContext* deviceContext)
 {
     HRESULT result;
     D3D11_MAPPED_SUBRESOURCE mappedResource;
@@ -373,18 +726,24 @@ bool ParticlesShader::SetShaderParameters(ID3D11DeviceContext* deviceContext, ID
     // Unlock the constant buffer.
     deviceContext->Unmap(m_csParametersBuffer, 0);
 
-    // Now set the constant buffer in the compute shader with the updated values.
-    deviceContext->CSSetConstantBuffers(0, 1, &m_csParametersBuffer);
-
-    // Set shader texture resource in the pixel shader.
-    deviceContext->PSSetShaderResources(0, 1, &texture);
-
     return true;
 }
 
-void ParticlesShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+bool ParticlesShader::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
 {
-    RunComputeShader(deviceContext);
+    bool result;
+
+    // Before the first particles joined there is nothing to step or draw.
+    if (m_particlesNumber == 0)
+    {
+        return true;
+    }
+
+    result = RunComputeShader(deviceContext);
+    if (!result)
+    {
+        return false;
+    }
 
     unsigned int stride;
     unsigned int offset;
@@ -410,12 +769,20 @@ void ParticlesShader::RenderShader(ID3D11DeviceContext* deviceContext, int index
     deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 
     // Render the triangles.
-    deviceContext->DrawIndexed(s_VertixIndeciesNumber, 0, 0);
+    deviceContext->DrawIndexed(static_cast<UINT>(m_particlesNumber * s_IndicesPerParticle), 0, 0);
+
+    return true;
 }
 
-bool ParticlesShader::InitializeComputeShader(ID3D11Device* device, HWND hwnd, std::wstring_view filename)
+bool ParticlesShader::InitializeComputeShader(
+    ID3D11Device* device,
+    HWND hwnd,
+    ShaderCache& shaders,
+    std::wstring_view filename,
+    const char* entryPoint,
+    ID3D11ComputeShader** computeShader)
 {
-    if (!device || !hwnd)
+    if (!device)
     {
         return false;
     }
@@ -434,16 +801,7 @@ bool ParticlesShader::InitializeComputeShader(ID3D11Device* device, HWND hwnd, s
     ID3D10Blob* errorMessage = nullptr;
     ID3D10Blob* computeShaderBuffer = nullptr;
 
-    result = D3DCompileFromFile(
-        filename.data(),
-        nullptr,
-        D3D_COMPILE_STANDARD_FILE_INCLUDE,
-        "DefaultCS",
-        pProfile,
-        dwShaderFlags,
-        0,
-        &computeShaderBuffer,
-        &errorMessage);
+    result = DirectXUtils::CompileShader(shaders, filename, entryPoint, pProfile, dwShaderFlags, &computeShaderBuffer, &errorMessage);
 
     if (FAILED(result))
     {
@@ -466,7 +824,7 @@ bool ParticlesShader::InitializeComputeShader(ID3D11Device* device, HWND hwnd, s
         computeShaderBuffer->GetBufferPointer(),
         computeShaderBuffer->GetBufferSize(),
         nullptr,
-        &m_computeShader);
+        computeShader);
 
     DirectXUtils::SafeRelease(computeShaderBuffer);
     DirectXUtils::SafeRelease(errorMessage);
@@ -474,133 +832,229 @@ bool ParticlesShader::InitializeComputeShader(ID3D11Device* device, HWND hwnd, s
     return true;
 }
 
-void ParticlesShader::RunComputeShader(ID3D11DeviceContext* deviceContext)
+bool ParticlesShader::RunComputeShader(ID3D11DeviceContext* deviceContext)
 {
-    deviceContext->CSSetShader(m_computeShader, nullptr, 0);
+    bool result = true;
+
+    // Either only expand the states of the simulation thread or step the particles as well.
+    if (m_Simulation)
+    {
+        ID3D11ShaderResourceView* states[2] = { m_statesSRVs[m_currentStates], m_statesSRVs[m_currentStates ^ 1] };
+
+        deviceContext->CSSetShader(m_projectShader, nullptr, 0);
+        deviceContext->CSSetShaderResources(0, 2, states);
+    }
+    else
+    {
+        deviceContext->CSSetShader(m_computeShader, nullptr, 0);
+    }
+
     ID3D11UnorderedAccessView* views[1] = { m_particlesUAV };
     deviceContext->CSSetUnorderedAccessViews(0, 1, views, nullptr);
 
     constexpr size_t threadGroupSize = 1024;
-    const auto numGroups =
-        (s_ParticlesNumber % threadGroupSize != 0) ? ((s_ParticlesNumber / threadGroupSize) + 1) : (s_ParticlesNumber / threadGroupSize);
-    const auto secondRoot = std::ceil(std::sqrt(static_cast<double>(numGroups)));
-    const auto groupSizeX = static_cast<int>(secondRoot);
-    const auto groupSizeY = static_cast<int>(secondRoot);
+    const auto numGroups = (m_particlesNumber + threadGroupSize - 1) / threadGroupSize;
+    const auto groupSizeX = m_CSParameters.DispatchGroupsX;
+    const auto groupSizeY = static_cast<UINT>((numGroups + groupSizeX - 1) / groupSizeX);
 
-    deviceContext->Dispatch(groupSizeX, groupSizeY, 1);
+    if (m_Simulation)
+    {
+        deviceContext->Dispatch(groupSizeX, groupSizeY, 1);
+    }
+    else
+    {
+        // Step once per substep, each with its own well and share of the frame time.
+        for (const auto& substep : m_substeps)
+        {
+            const auto& well = substep.GravityFieldPosition;
+            m_CSParameters.GravityFieldPosition = Vector3(well[0], well[1], well[2]);
+            m_CSParameters.DeltaTime = substep.DeltaTime;
+
+            result = WriteCSParameters(deviceContext);
+            if (!result)
+            {
+                break;
+            }
+
+            deviceContext->Dispatch(groupSizeX, groupSizeY, 1);
+        }
+    }
 
     deviceContext->CSSetShader(nullptr, nullptr, 0);
 
     ID3D11UnorderedAccessView* ppUAViewnullptr[1] = { nullptr };
     deviceContext->CSSetUnorderedAccessViews(0, 1, ppUAViewnullptr, nullptr);
+
+    ID3D11ShaderResourceView* ppSRViewnullptr[2] = { nullptr, nullptr };
+    deviceContext->CSSetShaderResources(0, 2, ppSRViewnullptr);
+
+    return result;
 }
 
-bool ParticlesShader::UpdateGravityFieldPosition(const Matrix& viewMatrix, const Matrix& projectionMatrix)
+bool ParticlesShader::UpdateGravityFieldPosition(const CameraClass& camera)
 {
-    constexpr float circleRadius = 0.5f;
     static float rotation = 0.0f;
     static float positionX = 0.0f;
 
-    Matrix projectionInv = projectionMatrix.Invert();
-    Matrix viewInv = viewMatrix.Invert();
-
-    // 3 coordinates that defines XY-plane (in world coordinates).
-    Vector4 worldO = { 0, 0, 0, 1 };
-    Vector4 worldX = { 1, 0, 0, 1 };
-    Vector4 worldY = { 0, 1, 0, 1 };
-
-    // 3 coordinates that defines XY-plane (in camera coordinates).
-    Vector4 worldOInCamera = Vector4::Transform(worldO, viewMatrix);
-    Vector4 worldXInCamera = Vector4::Transform(worldX, viewMatrix);
-    Vector4 worldYInCamera = Vector4::Transform(worldY, viewMatrix);
-
-    // Camera position (in camera coordinates).
-    Vector4 cO = { 0, 0, 0, 1 };
-
-    // Normalize mouse position to range [-1, 1].
-    Vector4 mousePositionNormalize = Vector4(
-        (m_MousePosition.x / static_cast<float>(m_ScreenWidth)) * 2.0f - 1.0,
-        1.0 - (m_MousePosition.y / static_cast<float>(m_ScreenHeight)) * 2.0f,
-        0,
-        1);
-
-    // Unproject point (in camera coordinates).
-    Vector3 unprojectedDirection = Vector3(Vector4::Transform(mousePositionNormalize, projectionInv));
-
-    // Define equation Ax = b to calculate the intersection of "unprojectedDirection" and XY world plane.
-    Matrix A = Matrix{
-        Vector3{ worldXInCamera - worldOInCamera },
-        Vector3{ worldYInCamera - worldOInCamera },
-        -unprojectedDirection,
-    };
-    Vector3 b = Vector3(cO - worldOInCamera);
-
-    // Calculate solution for x.
-    Vector3 solution = Vector3::Transform(b, A.Invert());
-
-    Vector3 resultPositionInCamera = cO + unprojectedDirection * solution.z;
-    Vector4 resultPositionInWorld =
-        Vector4::Transform(Vector4(resultPositionInCamera.x, resultPositionInCamera.y, resultPositionInCamera.z, 1.0f), viewInv);
-
-    // Add circular rotation.
+    // Add circular rotation, the substeps spread it over the frame.
+    const float rotationBegin = rotation;
     positionX += m_CSParameters.DeltaTime;
     rotation += 1.f * m_CSParameters.DeltaTime;
-    const auto theta = DirectX::XMConvertToRadians(rotation);
 
-    m_CSParameters.GravityFieldPosition = Vector3(
-        resultPositionInWorld.x,
-        resultPositionInWorld.y + circleRadius * std::cos(theta),
-        resultPositionInWorld.z + circleRadius * std::sin(theta));
+    // Follow the cursor path since the previous step with one well per substep.
+    const WellPath::Parameters wellParameters = {
+        m_ScreenWidth,
+        m_ScreenHeight,
+        m_parameters.WellOrbitRadius,
+        rotationBegin,
+        rotation,
+        std::min(m_parameters.InputSubsteps, ParticlesSimulationThread::s_MaxSubsteps),
+    };
+
+    WellPath::BuildSubsteps(
+        camera,
+        wellParameters,
+        m_cursorPath,
+        static_cast<int>(m_MousePosition.x),
+        static_cast<int>(m_MousePosition.y),
+        m_substeps);
+
+    // The last substep leaves the well where the frame ends.
+    const auto& well = m_substeps.back().GravityFieldPosition;
+    m_CSParameters.GravityFieldPosition = Vector3(well[0], well[1], well[2]);
 
     return true;
 }
 
-void ParticlesShader::SetMousePosition(const Vector2& mousePosition) noexcept
+void ParticlesShader::AddCursorPath(const std::vector<CursorSample>& cursorPath)
 {
-    m_MousePosition = mousePosition;
+    if (cursorPath.empty())
+    {
+        return;
+    }
+
+    m_cursorPath.insert(m_cursorPath.end(), cursorPath.begin(), cursorPath.end());
+    m_MousePosition = Vector2(static_cast<float>(cursorPath.back().X), static_cast<float>(cursorPath.back().Y));
+
+    // A simulation that falls far behind only follows the most recent part of the path.
+    if (m_cursorPath.size() > s_MaxCursorPath)
+    {
+        m_cursorPath.erase(m_cursorPath.begin(), m_cursorPath.end() - s_MaxCursorPath);
+    }
 }
 
-bool ParticlesShader::UpdateFrameDeltaTime() noexcept
+void ParticlesShader::SetFrameTime(float milliseconds) noexcept
 {
-    const auto now = std::chrono::high_resolution_clock::now();
-    const auto deltaTimeInMilliseconds =
-        std::max(std::chrono::duration_cast<std::chrono::milliseconds>(now - m_lastSampleTime).count(), 0LL);
+    m_frameMilliseconds = milliseconds;
+}
 
-    // Set delta time.
-    constexpr auto timeScale = 1.f / 15.f;
-    m_CSParameters.DeltaTime = static_cast<float>(deltaTimeInMilliseconds) * timeScale;
+uint64_t ParticlesShader::GetPresentedInputTime() const noexcept
+{
+    return m_presentedInputTime;
+}
 
-    m_lastSampleTime = now;
+const ParticlesSimulation::CloudStats& ParticlesShader::GetCloudStats() const noexcept
+{
+    static const ParticlesSimulation::CloudStats s_NoStats;
 
-    return true;
+    return m_Simulation ? m_Simulation->GetCloudStats() : s_NoStats;
 }
 
-bool ParticlesShader::UpdateTransformationMatrices(const Matrix& viewMatrix, const Matrix& projectionMatrix) noexcept
+bool ParticlesShader::UpdateFrameDeltaTime() noexcept
 {
-    // Transpose the matrices to prepare them for the shader. Copy the matrices into the constant buffer.
-    m_CSParameters.View = viewMatrix.Transpose();
-    m_CSParameters.Projection = projectionMatrix.Transpose();
+    // Set delta time from the frame time handed in, measured or played back.
+    m_CSParameters.DeltaTime = m_frameMilliseconds * m_parameters.TimeScale;
 
     return true;
 }
 
-std::vector<unsigned long> ParticlesShader::GenerateIndexBuffer(const unsigned long number) noexcept
+void ParticlesShader::UpdateSimulation(ID3D11DeviceContext* deviceContext)
 {
-    std::vector<unsigned long> indecies;
-    indecies.reserve(number * 6UL);
+    bool swapped;
+
+    if (m_parameters.SimulationRate <= 0.0f)
+    {
+        // Without a fixed rate every frame waits for one step and shows it.
+        WellPath::SetDeltaTime(m_CSParameters.DeltaTime, m_substeps);
+        m_Simulation->Swap(m_substeps);
+        m_CSParameters.Interpolation = 1.0f;
+        swapped = true;
+    }
+    else
+    {
+        const float stepMilliseconds = 1000.0f / m_parameters.SimulationRate;
+
+        // Start the next step once a step worth of time went by. While the step in flight is not
+        // done the particles are extrapolated past the last step, at most by one more step.
+        m_simulationAccumulator += m_frameMilliseconds;
+        WellPath::SetDeltaTime(stepMilliseconds * m_parameters.TimeScale, m_substeps);
+        swapped = m_simulationAccumulator >= stepMilliseconds && m_Simulation->TrySwap(m_substeps);
+        if (swapped)
+        {
+            m_simulationAccumulator -= stepMilliseconds;
+        }
+
+        m_simulationAccumulator = std::min(m_simulationAccumulator, 2.0f * stepMilliseconds);
+        m_CSParameters.Interpolation = m_simulationAccumulator / stepMilliseconds;
+    }
 
-    for (unsigned long i = 0; i < number; ++i)
+    if (!swapped)
     {
-        // First triangle.
-        indecies.push_back(i * 4 + 0);
-        indecies.push_back(i * 4 + 1);
-        indecies.push_back(i * 4 + 2);
+        return;
+    }
+
+    // The step that just became the front one was started with the input of the previous swap.
+    m_presentedInputTime = m_stepInputTime;
+    ConsumeCursorPath();
+
+    // Upload the new front states over the older GPU copy, the other one keeps the previous step.
+    // The front states stay untouched until the next swap and the copy is made right away.
+    PROFILE_ZONE("UploadStates");
+    const auto& front = m_Simulation->GetFrontStates();
+    m_currentStates ^= 1;
+    DirectXUtils::UpdateBufferRange(
+        deviceContext, m_statesBuffers[m_currentStates], sizeof(ParticleState), 0, front.size(), front.data());
+
+    // Particles that joined with this step have no states in the other copy yet, it gets their
+    // previous ones.
+    if (front.size() > m_particlesNumber)
+    {
+        const auto& previous = m_Simulation->GetPreviousStates();
+
+        DirectXUtils::UpdateBufferRange(
+            deviceContext,
+            m_statesBuffers[m_currentStates ^ 1],
+            sizeof(ParticleState),
+            m_particlesNumber,
+            front.size() - m_particlesNumber,
+            previous.data() + m_particlesNumber);
 
-        // Second triangle.
-        indecies.push_back(i * 4 + 0);
-        indecies.push_back(i * 4 + 2);
-        indecies.push_back(i * 4 + 3);
+        m_particlesNumber = front.size();
     }
+}
+
+void ParticlesShader::ConsumeCursorPath() noexcept
+{
+    // The path now belongs to the step that was started, the next one begins where it ended.
+    if (!m_cursorPath.empty())
+    {
+        m_stepInputTime = m_cursorPath.back().Time;
+        m_cursorPath.clear();
+    }
+}
+
+bool ParticlesShader::UpdateTransformationMatrices(const Matrix& viewMatrix, const Matrix& projectionMatrix) noexcept
+{
+    // Transpose the matrices to prepare them for the shader. Copy the matrices into the constant buffer.
+    m_CSParameters.View = viewMatrix.Transpose();
+    m_CSParameters.Projection = projectionMatrix.Transpose();
 
-    return indecies;
-}
\ No newline at end of file
+    // The compute shader rebuilds the flat particle index from a 2D grid of groups.
+    constexpr size_t threadGroupSize = 1024;
+    const auto numGroups = (m_particlesNumber + threadGroupSize - 1) / threadGroupSize;
+    m_CSParameters.ParticlesNumber = static_cast<unsigned int>(m_particlesNumber);
+    m_CSParameters.DispatchGroupsX = static_cast<unsigned int>(std::ceil(std::sqrt(static_cast<double>(numGroups))));
+    m_CSParameters.BillboardSize = m_parameters.BillboardSize;
+
+    return true;
+}
@@ -1,7 +1,8 @@
 #ifndef _LIGHTSHADERCLASS_H_
 #define _LIGHTSHADERCLASS_H_
 
-#include <chrono>
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string_view>
 #include <vector>
@@ -10,6 +11,16 @@
 #include <d3dcompiler.h>
 #include <directxtk/SimpleMath.h>
 
+#include "AssetManager.h"
+#include "CameraClass.h"
+#include "InputEvents.h"
+#include "MemoryTracker.h"
+#include "ParticlesGenerator.h"
+#include "ParticlesGeometry.h"
+#include "ParticlesSimulationThread.h"
+#include "ParticlesStore.h"
+#include "SceneConfigClass.h"
+#include "ShaderCache.h"
 #include "TextureClass.h"
 
 using namespace DirectX::SimpleMath;
@@ -23,6 +34,10 @@ private:
         Matrix Projection;
         Vector3 GravityFieldPosition;
         float DeltaTime;
+        unsigned int ParticlesNumber;
+        unsigned int DispatchGroupsX;
+        float BillboardSize;
+        float Interpolation;
     };
 
     struct ParticleDataType
@@ -37,63 +52,130 @@ public:
     ParticlesShader();
     ~ParticlesShader();
 
-    bool Initialize(ID3D11Device* device, HWND hwnd, const int screenWidth, const int screenHeight);
+    bool Initialize(
+        ID3D11Device* device,
+        HWND hwnd,
+        const int screenWidth,
+        const int screenHeight,
+        const SceneParameters& parameters,
+        ShaderCache& shaders,
+        AssetManager& assets);
+
+    //--------------------------------------------------------------------------------------
+    // The steps of Initialize for a parallel startup. LoadParticles needs no device and
+    // starts the texture decode. CreateShaders and CreateResources only use the device, not
+    // the context, so they can run at the same time on different threads. CreateResources
+    // has to come after LoadParticles.
+    //--------------------------------------------------------------------------------------
+    bool LoadParticles(HWND hwnd, const SceneParameters& parameters, AssetManager& assets);
+    bool CreateShaders(ID3D11Device* device, HWND hwnd, ShaderCache& shaders);
+    bool CreateResources(ID3D11Device* device, const int screenWidth, const int screenHeight);
+
+    bool ApplyParameters(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, const SceneParameters& parameters);
     void Shutdown();
-    bool Render(ID3D11DeviceContext* deviceContext, int indexCount, const Matrix& viewMatrix, const Matrix& projectionMatrix);
-    void SetMousePosition(const Vector2& mousePosition) noexcept;
+    bool Render(ID3D11DeviceContext* deviceContext, int indexCount, const CameraClass& camera);
+
+    //--------------------------------------------------------------------------------------
+    // Adds the cursor path of a frame. The next step follows every point since the previous
+    // step, split into at most InputSubsteps substeps.
+    //--------------------------------------------------------------------------------------
+    void AddCursorPath(const std::vector<CursorSample>& cursorPath);
+
+    // Time of the frame about to be rendered, the particles advance by it times TimeScale.
+    void SetFrameTime(float milliseconds) noexcept;
+
+    // Time of the newest input event the particles drawn by the last Render were stepped with.
+    uint64_t GetPresentedInputTime() const noexcept;
+
+    // Statistics of the particles drawn by the last Render. They are reduced by the CPU
+    // simulation thread, with the compute shader stepping the particles they stay empty.
+    const ParticlesSimulation::CloudStats& GetCloudStats() const noexcept;
 
 private:
-    static std::vector<unsigned long> GenerateIndexBuffer(const unsigned long number) noexcept;
+    bool InitializeParticles(HWND hwnd);
+    void JoinParticles(ID3D11DeviceContext* deviceContext);
+    bool InitializeBuffers(ID3D11Device* device);
+    void ShutdownBuffers();
 
     bool InitializeShader(
         ID3D11Device* device,
         HWND hwnd,
+        ShaderCache& shaders,
         std::wstring_view vsFilename,
         std::wstring_view psFilename,
         std::wstring_view csFilename);
 
-    bool InitializeTexture(ID3D11Device* device, std::wstring_view textureFilename);
+    bool InitializeTexture(ID3D11Device* device, const AssetManager::ImageAsset& texture);
 
     void ShutdownShader();
     void OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND hwnd, std::wstring_view shaderFilename);
 
     bool SetShaderParameters(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture);
-    void RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
+    bool WriteCSParameters(ID3D11DeviceContext* deviceContext);
+    bool RenderShader(ID3D11DeviceContext* deviceContext, int indexCount);
 
-    bool InitializeComputeShader(ID3D11Device* device, HWND hwnd, std::wstring_view filename);
+    bool InitializeComputeShader(
+        ID3D11Device* device,
+        HWND hwnd,
+        ShaderCache& shaders,
+        std::wstring_view filename,
+        const char* entryPoint,
+        ID3D11ComputeShader** computeShader);
 
-    void RunComputeShader(ID3D11DeviceContext* deviceContext);
+    bool RunComputeShader(ID3D11DeviceContext* deviceContext);
 
-    bool UpdateGravityFieldPosition(const Matrix& viewMatrix, const Matrix& projectionMatrix);
+    bool UpdateGravityFieldPosition(const CameraClass& camera);
     bool UpdateFrameDeltaTime() noexcept;
+    void UpdateSimulation(ID3D11DeviceContext* deviceContext);
+    void ConsumeCursorPath() noexcept;
     bool UpdateTransformationMatrices(const Matrix& viewMatrix, const Matrix& projectionMatrix) noexcept;
 
 private:
-    constexpr static size_t s_ParticlesNumber = 1000000;
-    constexpr static size_t s_VerticesNumber = s_ParticlesNumber * 4;
-    constexpr static size_t s_VertixIndeciesNumber = s_ParticlesNumber * 6;
-
     ID3D11VertexShader* m_vertexShader;
     ID3D11PixelShader* m_pixelShader;
     ID3D11ComputeShader* m_computeShader;
+    ID3D11ComputeShader* m_projectShader;
 
     ID3D11Buffer* m_csParametersBuffer;
     ID3D11Buffer* m_particlesBuffer;
     ID3D11Buffer* m_indexBuffer;
+    std::array<ID3D11Buffer*, 2> m_statesBuffers;
 
     ID3D11UnorderedAccessView* m_particlesUAV;
     ID3D11ShaderResourceView* m_particlesSRV;
-
-    std::vector<ParticleDataType> m_particlesDataBuffer;
-    std::vector<unsigned long> m_indexDataBuffer;
+    std::array<ID3D11ShaderResourceView*, 2> m_statesSRVs;
+
+    // The buffers hold m_particlesCapacity particles, the first m_particlesNumber of them are
+    // simulated and drawn. The others join as the generator hands them out.
+    size_t m_particlesCapacity;
+    size_t m_particlesNumber;
+    std::unique_ptr<ParticlesGenerator> m_Generator;
+    MemoryTracker::Vector<ParticleDataType, MemoryTracker::Tag::ParticlesUpload> m_particlesDataBuffer;
+    ParticlesGeometry::IndexBuffer m_indexDataBuffer;
+    std::unique_ptr<ParticlesSimulationThread> m_Simulation;
+    uint32_t m_currentStates;
+    float m_simulationAccumulator;
 
     ID3D11SamplerState* m_sampleState;
     std::unique_ptr<TextureClass> m_Texture;
+    AssetManager::ImageHandle m_textureAsset;
+
+    // Chunks of the generator uploaded per frame, so joining particles never stalls a frame.
+    static constexpr size_t s_MaxChunksPerFrame = 4;
+
+    // Cursor samples kept for the next step, the oldest are dropped past this.
+    static constexpr size_t s_MaxCursorPath = 1024;
+
     Vector2 m_MousePosition;
+    std::vector<CursorSample> m_cursorPath;
+    std::vector<ParticlesSimulation::StepParameters> m_substeps;
+    uint64_t m_stepInputTime;
+    uint64_t m_presentedInputTime;
     int m_ScreenWidth;
     int m_ScreenHeight;
+    SceneParameters m_parameters;
     CSParametersBufferType m_CSParameters;
-    std::chrono::high_resolution_clock::time_point m_lastSampleTime;
+    float m_frameMilliseconds;
 };
 
 #endif
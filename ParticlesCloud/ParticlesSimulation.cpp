@@ -0,0 +1,699 @@
+#include "ParticlesSimulation.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#include "Profiler.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    using ParticlesSimulation::CloudStats;
+    using ParticlesSimulation::CloudStatsPartial;
+    using ParticlesSimulation::KernelConfig;
+    using ParticlesSimulation::ParticleRecord;
+    using ParticlesSimulation::StepParameters;
+
+    // The values of the configuration the loops read, worked out once per call.
+    struct KernelConstants
+    {
+        float SofteningSquared;
+        float BoundaryExtent;
+    };
+
+    // Math policies, 1 / distance^3 from the squared distance.
+    struct ReferenceMath
+    {
+        static float InverseCube(float distanceSquared) noexcept
+        {
+            // Same math as the compute shader, including pow(distance, 3).
+            return 1.0f / std::pow(std::sqrt(distanceSquared), 3.0f);
+        }
+    };
+
+    struct FastMath
+    {
+        static float InverseCube(float distanceSquared) noexcept
+        {
+            const float inverseDistance = 1.0f / std::sqrt(distanceSquared);
+            return inverseDistance * inverseDistance * inverseDistance;
+        }
+    };
+
+    // Softening policies, applied to the squared distance to the well.
+    struct NoSoftening
+    {
+        static float Apply(float distanceSquared, const KernelConstants&) noexcept
+        {
+            return distanceSquared;
+        }
+    };
+
+    struct PlummerSoftening
+    {
+        static float Apply(float distanceSquared, const KernelConstants& constants) noexcept
+        {
+            return distanceSquared + constants.SofteningSquared;
+        }
+    };
+
+    // Force law policies, the factor turning the offset from the well into the acceleration and
+    // the potential per unit mass it comes from.
+    struct InverseSquareForce
+    {
+        template<typename Math, typename Softening>
+        static float Scale(float distanceSquared, const KernelConstants& constants) noexcept
+        {
+            return Math::InverseCube(Softening::Apply(distanceSquared, constants));
+        }
+
+        template<typename Softening>
+        static float Potential(float distanceSquared, const KernelConstants& constants) noexcept
+        {
+            return -1.0f / std::sqrt(Softening::Apply(distanceSquared, constants));
+        }
+    };
+
+    struct HarmonicForce
+    {
+        template<typename Math, typename Softening>
+        static float Scale(float, const KernelConstants&) noexcept
+        {
+            return 1.0f;
+        }
+
+        template<typename Softening>
+        static float Potential(float distanceSquared, const KernelConstants&) noexcept
+        {
+            return 0.5f * distanceSquared;
+        }
+    };
+
+    // Boundary policies, applied to every axis after the step.
+    struct OpenBoundary
+    {
+        static void Apply(float&, float&, const KernelConstants&) noexcept
+        {
+        }
+    };
+
+    struct ReflectBoundary
+    {
+        static void Apply(float& position, float& velocity, const KernelConstants& constants) noexcept
+        {
+            // Mirror the overshoot back inside and turn the velocity around. Written as plain
+            // selects and a sign, the loop is if-converted and stays vectorized.
+            const float extent = constants.BoundaryExtent;
+            const float clamped = position < -extent ? -extent : (position > extent ? extent : position);
+            const float mirrored = 2.0f * clamped - position;
+
+            velocity *= std::abs(position) > extent ? -1.0f : 1.0f;
+
+            const float low = mirrored < -extent ? -extent : mirrored;
+            position = low > extent ? extent : low;
+        }
+    };
+
+    template<typename MathPolicy, typename ForcePolicy, typename IntegratorPolicy, typename SofteningPolicy, typename BoundaryPolicy>
+    struct KernelPolicies
+    {
+        using Math = MathPolicy;
+        using Force = ForcePolicy;
+        using Integration = IntegratorPolicy;
+        using Softening = SofteningPolicy;
+        using Bounds = BoundaryPolicy;
+    };
+
+    template<typename Policies>
+    inline void CalculateGravityForce(
+        float x,
+        float y,
+        float z,
+        const StepParameters& parameters,
+        const KernelConstants& constants,
+        float& ax,
+        float& ay,
+        float& az) noexcept
+    {
+        const float dx = x - parameters.GravityFieldPosition[0];
+        const float dy = y - parameters.GravityFieldPosition[1];
+        const float dz = z - parameters.GravityFieldPosition[2];
+
+        using Force = typename Policies::Force;
+        const float scale =
+            Force::template Scale<typename Policies::Math, typename Policies::Softening>(dx * dx + dy * dy + dz * dz, constants);
+
+        ax = -dx * scale;
+        ay = -dy * scale;
+        az = -dz * scale;
+    }
+
+    // Integrator policies, advance one particle by the time step of the parameters.
+    struct VelocityVerletIntegrator
+    {
+        // Identical to DefaultCS.
+        template<typename Policies>
+        static void Advance(
+            float& x,
+            float& y,
+            float& z,
+            float& vx,
+            float& vy,
+            float& vz,
+            const StepParameters& parameters,
+            const KernelConstants& constants) noexcept
+        {
+            const float halfDeltaTime = parameters.DeltaTime / 2.0f;
+            float ax, ay, az;
+
+            CalculateGravityForce<Policies>(x, y, z, parameters, constants, ax, ay, az);
+
+            const float halfVelocityX = vx + ax * halfDeltaTime;
+            const float halfVelocityY = vy + ay * halfDeltaTime;
+            const float halfVelocityZ = vz + az * halfDeltaTime;
+
+            x += halfVelocityX * parameters.DeltaTime;
+            y += halfVelocityY * parameters.DeltaTime;
+            z += halfVelocityZ * parameters.DeltaTime;
+
+            CalculateGravityForce<Policies>(x, y, z, parameters, constants, ax, ay, az);
+
+            vx = halfVelocityX + ax * halfDeltaTime;
+            vy = halfVelocityY + ay * halfDeltaTime;
+            vz = halfVelocityZ + az * halfDeltaTime;
+        }
+    };
+
+    struct SemiImplicitEulerIntegrator
+    {
+        template<typename Policies>
+        static void Advance(
+            float& x,
+            float& y,
+            float& z,
+            float& vx,
+            float& vy,
+            float& vz,
+            const StepParameters& parameters,
+            const KernelConstants& constants) noexcept
+        {
+            float ax, ay, az;
+
+            CalculateGravityForce<Policies>(x, y, z, parameters, constants, ax, ay, az);
+
+            vx += ax * parameters.DeltaTime;
+            vy += ay * parameters.DeltaTime;
+            vz += az * parameters.DeltaTime;
+
+            x += vx * parameters.DeltaTime;
+            y += vy * parameters.DeltaTime;
+            z += vz * parameters.DeltaTime;
+        }
+    };
+
+    template<typename Policies>
+    inline void Integrate(
+        float& x,
+        float& y,
+        float& z,
+        float& vx,
+        float& vy,
+        float& vz,
+        const StepParameters& parameters,
+        const KernelConstants& constants) noexcept
+    {
+        using Bounds = typename Policies::Bounds;
+
+        Policies::Integration::template Advance<Policies>(x, y, z, vx, vy, vz, parameters, constants);
+
+        Bounds::Apply(x, vx, constants);
+        Bounds::Apply(y, vy, constants);
+        Bounds::Apply(z, vz, constants);
+    }
+
+    // The arrays are passed as restrict qualified parameters, so the loop vectorizes without run-time alias checks.
+    template<typename Policies>
+    void StepArrays(
+        float* __restrict positionX,
+        float* __restrict positionY,
+        float* __restrict positionZ,
+        float* __restrict velocityX,
+        float* __restrict velocityY,
+        float* __restrict velocityZ,
+        const StepParameters parameters,
+        const KernelConstants constants,
+        size_t begin,
+        size_t end) noexcept
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            float x = positionX[i], y = positionY[i], z = positionZ[i];
+            float vx = velocityX[i], vy = velocityY[i], vz = velocityZ[i];
+
+            Integrate<Policies>(x, y, z, vx, vy, vz, parameters, constants);
+
+            positionX[i] = x;
+            positionY[i] = y;
+            positionZ[i] = z;
+            velocityX[i] = vx;
+            velocityY[i] = vy;
+            velocityZ[i] = vz;
+        }
+    }
+
+    template<typename Policies>
+    void StepStore(ParticlesStore& store, const StepParameters& parameters, const KernelConstants& constants, size_t begin, size_t end) noexcept
+    {
+        StepArrays<Policies>(
+            store.PositionX.data(),
+            store.PositionY.data(),
+            store.PositionZ.data(),
+            store.VelocityX.data(),
+            store.VelocityY.data(),
+            store.VelocityZ.data(),
+            parameters,
+            constants,
+            begin,
+            end);
+    }
+
+    template<typename Policies>
+    void StepRecords(ParticleRecord* records, const StepParameters& parameters, const KernelConstants& constants, size_t begin, size_t end) noexcept
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            auto& particle = records[i];
+            const float vx = particle.Velocity[0];
+            const float vy = particle.Velocity[1];
+            const float vz = particle.Velocity[2];
+
+            // The shader colors the particle by the speed it had before the step.
+            particle.VelocityLength = std::sqrt(vx * vx + vy * vy + vz * vz);
+
+            Integrate<Policies>(
+                particle.Position[0],
+                particle.Position[1],
+                particle.Position[2],
+                particle.Velocity[0],
+                particle.Velocity[1],
+                particle.Velocity[2],
+                parameters,
+                constants);
+        }
+    }
+
+    // Running sums of a block, one per lane so the block loop vectorizes without reordering the
+    // additions of a lane. The lanes are added up in order at the end of the block.
+    constexpr size_t s_StatsLanes = 8;
+    constexpr size_t s_StatsHistograms = 4;
+
+    struct StatsLanes
+    {
+        float Mass[s_StatsLanes] = {};
+        float KineticEnergy[s_StatsLanes] = {};
+        float PotentialEnergy[s_StatsLanes] = {};
+        float Momentum[3][s_StatsLanes] = {};
+        float MassMoment[3][s_StatsLanes] = {};
+        float BoundsMin[3][s_StatsLanes];
+        float BoundsMax[3][s_StatsLanes];
+    };
+
+    template<typename Policies>
+    inline void AccumulateLane(
+        StatsLanes& lanes,
+        size_t lane,
+        const float* position,
+        const float* velocity,
+        float mass,
+        const StepParameters& parameters,
+        const KernelConstants& constants) noexcept
+    {
+        const float speedSquared = velocity[0] * velocity[0] + velocity[1] * velocity[1] + velocity[2] * velocity[2];
+        const float dx = position[0] - parameters.GravityFieldPosition[0];
+        const float dy = position[1] - parameters.GravityFieldPosition[1];
+        const float dz = position[2] - parameters.GravityFieldPosition[2];
+
+        using Force = typename Policies::Force;
+        const float potential = Force::template Potential<typename Policies::Softening>(dx * dx + dy * dy + dz * dz, constants);
+
+        lanes.Mass[lane] += mass;
+        lanes.KineticEnergy[lane] += 0.5f * mass * speedSquared;
+        lanes.PotentialEnergy[lane] += mass * potential;
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            lanes.Momentum[axis][lane] += mass * velocity[axis];
+            lanes.MassMoment[axis][lane] += mass * position[axis];
+            lanes.BoundsMin[axis][lane] = position[axis] < lanes.BoundsMin[axis][lane] ? position[axis] : lanes.BoundsMin[axis][lane];
+            lanes.BoundsMax[axis][lane] = position[axis] > lanes.BoundsMax[axis][lane] ? position[axis] : lanes.BoundsMax[axis][lane];
+        }
+    }
+
+    // floor(log2(speed)) is half of floor(log2(speed^2)), read from the float exponent. Zero, denormal
+    // and infinite speeds end up in the first and the last bin.
+    inline uint8_t GetSpeedBin(float speedSquared) noexcept
+    {
+        const int exponent = static_cast<int>((std::bit_cast<uint32_t>(speedSquared) >> 23) & 0xff) - 127;
+        const int bin = (exponent >> 1) - CloudStats::s_FirstSpeedExponent + 1;
+
+        return static_cast<uint8_t>(std::clamp(bin, 0, static_cast<int>(CloudStats::s_SpeedBins) - 1));
+    }
+
+    template<typename Policies>
+    void ReduceBlock(
+        const ParticlesStore& store,
+        const StepParameters& parameters,
+        const KernelConstants& constants,
+        size_t begin,
+        size_t end,
+        CloudStatsPartial& partial) noexcept
+    {
+        const float* __restrict positionX = store.PositionX.data();
+        const float* __restrict positionY = store.PositionY.data();
+        const float* __restrict positionZ = store.PositionZ.data();
+        const float* __restrict velocityX = store.VelocityX.data();
+        const float* __restrict velocityY = store.VelocityY.data();
+        const float* __restrict velocityZ = store.VelocityZ.data();
+        const float* __restrict mass = store.Mass.data();
+
+        StatsLanes lanes;
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            std::fill_n(lanes.BoundsMin[axis], s_StatsLanes, std::numeric_limits<float>::infinity());
+            std::fill_n(lanes.BoundsMax[axis], s_StatsLanes, -std::numeric_limits<float>::infinity());
+        }
+
+        size_t i = begin;
+        for (; i + s_StatsLanes <= end; i += s_StatsLanes)
+        {
+            for (size_t lane = 0; lane < s_StatsLanes; ++lane)
+            {
+                const float position[3] = { positionX[i + lane], positionY[i + lane], positionZ[i + lane] };
+                const float velocity[3] = { velocityX[i + lane], velocityY[i + lane], velocityZ[i + lane] };
+                AccumulateLane<Policies>(lanes, lane, position, velocity, mass[i + lane], parameters, constants);
+            }
+        }
+        for (size_t lane = 0; i < end; ++i, ++lane)
+        {
+            const float position[3] = { positionX[i], positionY[i], positionZ[i] };
+            const float velocity[3] = { velocityX[i], velocityY[i], velocityZ[i] };
+            AccumulateLane<Policies>(lanes, lane, position, velocity, mass[i], parameters, constants);
+        }
+
+        // The bins are worked out in a loop of their own, the counting does not vectorize. Most
+        // particles fall into a few bins, so consecutive particles count into separate histograms
+        // instead of waiting for the increment of the one before.
+        uint8_t bins[ParticlesSimulation::s_StatsBlockSize];
+        for (size_t j = begin; j < end; ++j)
+        {
+            bins[j - begin] = GetSpeedBin(velocityX[j] * velocityX[j] + velocityY[j] * velocityY[j] + velocityZ[j] * velocityZ[j]);
+        }
+
+        uint32_t counts[s_StatsHistograms][CloudStats::s_SpeedBins] = {};
+        for (size_t j = 0; j < end - begin; ++j)
+        {
+            ++counts[j % s_StatsHistograms][bins[j]];
+        }
+        for (size_t bin = 0; bin < CloudStats::s_SpeedBins; ++bin)
+        {
+            for (size_t histogram = 0; histogram < s_StatsHistograms; ++histogram)
+            {
+                partial.SpeedHistogram[bin] += counts[histogram][bin];
+            }
+        }
+
+        if (partial.Count == 0)
+        {
+            partial.BoundsMin.fill(std::numeric_limits<float>::infinity());
+            partial.BoundsMax.fill(-std::numeric_limits<float>::infinity());
+        }
+
+        partial.Count += end - begin;
+        for (size_t lane = 0; lane < s_StatsLanes; ++lane)
+        {
+            partial.Mass += lanes.Mass[lane];
+            partial.KineticEnergy += lanes.KineticEnergy[lane];
+            partial.PotentialEnergy += lanes.PotentialEnergy[lane];
+
+            for (size_t axis = 0; axis < 3; ++axis)
+            {
+                partial.Momentum[axis] += lanes.Momentum[axis][lane];
+                partial.MassMoment[axis] += lanes.MassMoment[axis][lane];
+                partial.BoundsMin[axis] = std::min(partial.BoundsMin[axis], lanes.BoundsMin[axis][lane]);
+                partial.BoundsMax[axis] = std::max(partial.BoundsMax[axis], lanes.BoundsMax[axis][lane]);
+            }
+        }
+    }
+
+    template<typename Policies>
+    void ReduceRange(
+        const ParticlesStore& store,
+        const StepParameters& parameters,
+        const KernelConstants& constants,
+        size_t begin,
+        size_t end,
+        CloudStatsPartial& partial) noexcept
+    {
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += ParticlesSimulation::s_StatsBlockSize)
+        {
+            ReduceBlock<Policies>(
+                store, parameters, constants, blockBegin, std::min(blockBegin + ParticlesSimulation::s_StatsBlockSize, end), partial);
+        }
+    }
+
+    // The policies of every choice in the order of its enum. A new policy only adds loops, the
+    // existing ones compile exactly as before.
+    using MathPolicies = std::tuple<ReferenceMath, FastMath>;
+    using ForcePolicies = std::tuple<InverseSquareForce, HarmonicForce>;
+    using IntegratorPolicies = std::tuple<VelocityVerletIntegrator, SemiImplicitEulerIntegrator>;
+    using SofteningPolicies = std::tuple<NoSoftening, PlummerSoftening>;
+    using BoundaryPolicies = std::tuple<OpenBoundary, ReflectBoundary>;
+
+    // Every combination has its loop, the table is indexed by the choices as digits of a mixed
+    // radix number.
+    constexpr size_t s_MathStride = 1;
+    constexpr size_t s_ForceStride = s_MathStride * std::tuple_size_v<MathPolicies>;
+    constexpr size_t s_IntegratorStride = s_ForceStride * std::tuple_size_v<ForcePolicies>;
+    constexpr size_t s_SofteningStride = s_IntegratorStride * std::tuple_size_v<IntegratorPolicies>;
+    constexpr size_t s_BoundaryStride = s_SofteningStride * std::tuple_size_v<SofteningPolicies>;
+    constexpr size_t s_KernelCount = s_BoundaryStride * std::tuple_size_v<BoundaryPolicies>;
+
+    template<typename Policies, size_t index, size_t stride>
+    using PolicyAt = std::tuple_element_t<index / stride % std::tuple_size_v<Policies>, Policies>;
+
+    template<size_t index>
+    using KernelPoliciesAt = KernelPolicies<
+        PolicyAt<MathPolicies, index, s_MathStride>,
+        PolicyAt<ForcePolicies, index, s_ForceStride>,
+        PolicyAt<IntegratorPolicies, index, s_IntegratorStride>,
+        PolicyAt<SofteningPolicies, index, s_SofteningStride>,
+        PolicyAt<BoundaryPolicies, index, s_BoundaryStride>>;
+
+    using StoreStepFunction = void (*)(ParticlesStore&, const StepParameters&, const KernelConstants&, size_t, size_t) noexcept;
+    using RecordsStepFunction = void (*)(ParticleRecord*, const StepParameters&, const KernelConstants&, size_t, size_t) noexcept;
+    using ReduceFunction =
+        void (*)(const ParticlesStore&, const StepParameters&, const KernelConstants&, size_t, size_t, CloudStatsPartial&) noexcept;
+
+    template<size_t... indices>
+    constexpr std::array<StoreStepFunction, sizeof...(indices)> MakeStoreSteps(std::index_sequence<indices...>) noexcept
+    {
+        return { &StepStore<KernelPoliciesAt<indices>>... };
+    }
+
+    template<size_t... indices>
+    constexpr std::array<RecordsStepFunction, sizeof...(indices)> MakeRecordsSteps(std::index_sequence<indices...>) noexcept
+    {
+        return { &StepRecords<KernelPoliciesAt<indices>>... };
+    }
+
+    template<size_t... indices>
+    constexpr std::array<ReduceFunction, sizeof...(indices)> MakeReductions(std::index_sequence<indices...>) noexcept
+    {
+        return { &ReduceRange<KernelPoliciesAt<indices>>... };
+    }
+
+    constexpr auto s_StoreSteps = MakeStoreSteps(std::make_index_sequence<s_KernelCount>{});
+    constexpr auto s_RecordsSteps = MakeRecordsSteps(std::make_index_sequence<s_KernelCount>{});
+    constexpr auto s_Reductions = MakeReductions(std::make_index_sequence<s_KernelCount>{});
+
+    size_t GetKernelIndex(const KernelConfig& config) noexcept
+    {
+        const size_t softening = config.Softening > 0.0f ? 1 : 0;
+
+        return static_cast<size_t>(config.Math) * s_MathStride + static_cast<size_t>(config.Force) * s_ForceStride +
+               static_cast<size_t>(config.Integration) * s_IntegratorStride + softening * s_SofteningStride +
+               static_cast<size_t>(config.Bounds) * s_BoundaryStride;
+    }
+
+    KernelConstants GetKernelConstants(const KernelConfig& config) noexcept
+    {
+        return KernelConstants{ config.Softening * config.Softening, config.BoundaryExtent };
+    }
+}
+
+std::string_view ParticlesSimulation::GetLayoutName(Layout layout) noexcept
+{
+    return layout == Layout::StructureOfArrays ? "soa" : "aos";
+}
+
+std::string_view ParticlesSimulation::GetKernelName(Kernel kernel) noexcept
+{
+    return kernel == Kernel::Reference ? "reference" : "fast";
+}
+
+std::string_view ParticlesSimulation::GetForceLawName(ForceLaw force) noexcept
+{
+    return force == ForceLaw::InverseSquare ? "inverse-square" : "harmonic";
+}
+
+std::string_view ParticlesSimulation::GetIntegratorName(Integrator integrator) noexcept
+{
+    return integrator == Integrator::VelocityVerlet ? "verlet" : "euler";
+}
+
+std::string_view ParticlesSimulation::GetBoundaryName(Boundary boundary) noexcept
+{
+    return boundary == Boundary::Open ? "open" : "reflect";
+}
+
+size_t ParticlesSimulation::GetBytesPerParticle(Layout layout) noexcept
+{
+    // Structure of arrays streams positions and velocities in and out, records are read and written whole.
+    return layout == Layout::StructureOfArrays ? 2 * 6 * sizeof(float) : 2 * sizeof(ParticleRecord);
+}
+
+void ParticlesSimulation::StoreToRecords(const ParticlesStore& store, std::vector<ParticleRecord>& records)
+{
+    records.resize(store.Size());
+
+    for (size_t i = 0; i < store.Size(); ++i)
+    {
+        records[i] = ParticleRecord{
+            { store.PositionX[i], store.PositionY[i], store.PositionZ[i] },
+            store.Mass[i],
+            { store.VelocityX[i], store.VelocityY[i], store.VelocityZ[i] },
+            0.0f,
+        };
+    }
+}
+
+void ParticlesSimulation::StepRange(
+    ParticlesStore& store,
+    const StepParameters& parameters,
+    const KernelConfig& config,
+    size_t begin,
+    size_t end) noexcept
+{
+    s_StoreSteps[GetKernelIndex(config)](store, parameters, GetKernelConstants(config), begin, end);
+}
+
+void ParticlesSimulation::StepRange(
+    std::vector<ParticleRecord>& records,
+    const StepParameters& parameters,
+    const KernelConfig& config,
+    size_t begin,
+    size_t end) noexcept
+{
+    s_RecordsSteps[GetKernelIndex(config)](records.data(), parameters, GetKernelConstants(config), begin, end);
+}
+
+void ParticlesSimulation::Step(ParticlesStore& store, const StepParameters& parameters, const KernelConfig& config, WorkerPool& workers)
+{
+    workers.ParallelFor(store.Size(), [&](size_t begin, size_t end, size_t) {
+        PROFILE_ZONE("SimulationStep");
+        StepRange(store, parameters, config, begin, end);
+    });
+}
+
+void ParticlesSimulation::Step(
+    std::vector<ParticleRecord>& records,
+    const StepParameters& parameters,
+    const KernelConfig& config,
+    WorkerPool& workers)
+{
+    workers.ParallelFor(records.size(), [&](size_t begin, size_t end, size_t) {
+        PROFILE_ZONE("SimulationStep");
+        StepRange(records, parameters, config, begin, end);
+    });
+}
+
+ParticlesSimulation::CloudStats ParticlesSimulation::StepWithStats(
+    ParticlesStore& store,
+    const StepParameters& parameters,
+    const KernelConfig& config,
+    WorkerPool& workers)
+{
+    std::vector<CloudStatsPartial> partials(workers.GetThreadCount());
+
+    // Every thread reduces its own chunk, the partials are merged in the order of the chunks.
+    workers.ParallelFor(store.Size(), [&](size_t begin, size_t end, size_t chunk) {
+        PROFILE_ZONE("SimulationStep");
+        for (size_t blockBegin = begin; blockBegin < end; blockBegin += s_StatsBlockSize)
+        {
+            const size_t blockEnd = std::min(blockBegin + s_StatsBlockSize, end);
+
+            StepRange(store, parameters, config, blockBegin, blockEnd);
+            ReduceStats(store, parameters, config, blockBegin, blockEnd, partials[chunk]);
+        }
+    });
+
+    return MergeStats(partials);
+}
+
+void ParticlesSimulation::ReduceStats(
+    const ParticlesStore& store,
+    const StepParameters& parameters,
+    const KernelConfig& config,
+    size_t begin,
+    size_t end,
+    CloudStatsPartial& partial) noexcept
+{
+    s_Reductions[GetKernelIndex(config)](store, parameters, GetKernelConstants(config), begin, end, partial);
+}
+
+ParticlesSimulation::CloudStats ParticlesSimulation::MergeStats(std::span<const CloudStatsPartial> partials) noexcept
+{
+    CloudStats stats;
+    std::array<double, 3> massMoment = {};
+
+    for (const auto& partial : partials)
+    {
+        if (partial.Count == 0)
+        {
+            continue;
+        }
+
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            stats.BoundsMin[axis] = stats.Count == 0 ? partial.BoundsMin[axis] : std::min(stats.BoundsMin[axis], partial.BoundsMin[axis]);
+            stats.BoundsMax[axis] = stats.Count == 0 ? partial.BoundsMax[axis] : std::max(stats.BoundsMax[axis], partial.BoundsMax[axis]);
+            stats.Momentum[axis] += partial.Momentum[axis];
+            massMoment[axis] += partial.MassMoment[axis];
+        }
+
+        for (size_t bin = 0; bin < CloudStats::s_SpeedBins; ++bin)
+        {
+            stats.SpeedHistogram[bin] += partial.SpeedHistogram[bin];
+        }
+
+        stats.Count += partial.Count;
+        stats.TotalMass += partial.Mass;
+        stats.KineticEnergy += partial.KineticEnergy;
+        stats.PotentialEnergy += partial.PotentialEnergy;
+    }
+
+    if (stats.TotalMass > 0.0)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            stats.CenterOfMass[axis] = massMoment[axis] / stats.TotalMass;
+        }
+    }
+
+    return stats;
+}
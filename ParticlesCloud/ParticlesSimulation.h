@@ -0,0 +1,186 @@
+#ifndef _PARTICLESSIMULATION_H_
+#define _PARTICLESSIMULATION_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "ParticlesStore.h"
+
+class WorkerPool;
+
+// CPU implementation of the particle step done by DefaultCS in particlesCS.hlsl: a velocity Verlet
+// integration of every particle inside the gravitational field of a single moving well. Variations
+// of the step are compiled as their own loops from policy types and picked from a table once per
+// call, so none of them costs a branch inside the loop of another.
+namespace ParticlesSimulation
+{
+    struct StepParameters
+    {
+        float GravityFieldPosition[3];
+        float DeltaTime;
+    };
+
+    // Array of structures layout, one record per particle like the GPU structured buffer.
+    struct ParticleRecord
+    {
+        float Position[3];
+        float Mass;
+        float Velocity[3];
+        float VelocityLength;
+    };
+
+    enum class Layout
+    {
+        StructureOfArrays,
+        ArrayOfStructures,
+    };
+
+    enum class Kernel
+    {
+        // Same math as the compute shader, including pow(distance, 3).
+        Reference,
+        // Inverse square root formulation the compiler can vectorize.
+        Fast,
+    };
+
+    enum class ForceLaw
+    {
+        // Pull of a point mass, what DefaultCS computes.
+        InverseSquare,
+        // Pull growing linearly with the distance, like a spring to the well.
+        Harmonic,
+    };
+
+    enum class Integrator
+    {
+        // Two force evaluations per step, what DefaultCS computes.
+        VelocityVerlet,
+        // One force evaluation per step.
+        SemiImplicitEuler,
+    };
+
+    enum class Boundary
+    {
+        Open,
+        // Particles leaving the cube of BoundaryExtent around the origin bounce back off its faces.
+        Reflect,
+    };
+
+    // Everything that selects the loop a step runs. The defaults are the step of DefaultCS.
+    struct KernelConfig
+    {
+        constexpr KernelConfig() noexcept = default;
+        constexpr KernelConfig(Kernel math) noexcept
+            : Math(math)
+        {
+        }
+
+        Kernel Math = Kernel::Fast;
+        ForceLaw Force = ForceLaw::InverseSquare;
+        Integrator Integration = Integrator::VelocityVerlet;
+        Boundary Bounds = Boundary::Open;
+        // Plummer softening length added to the distance to the well, 0 compiles it out.
+        float Softening = 0.0f;
+        float BoundaryExtent = 0.0f;
+    };
+
+    // Statistics of the whole cloud after a step. The potential energy is the one in the field of
+    // the well the step ended with, for the force law of the step.
+    struct CloudStats
+    {
+        // Speeds are binned by powers of two. Bin 0 counts the speeds below 2^s_FirstSpeedExponent,
+        // bin i the ones in [2^(s_FirstSpeedExponent + i - 1), 2^(s_FirstSpeedExponent + i)) and the
+        // last bin everything faster.
+        static constexpr size_t s_SpeedBins = 16;
+        static constexpr int s_FirstSpeedExponent = -6;
+
+        uint64_t Count = 0;
+        double TotalMass = 0.0;
+        double KineticEnergy = 0.0;
+        double PotentialEnergy = 0.0;
+        std::array<double, 3> Momentum = {};
+        std::array<double, 3> CenterOfMass = {};
+        std::array<float, 3> BoundsMin = {};
+        std::array<float, 3> BoundsMax = {};
+        std::array<uint64_t, s_SpeedBins> SpeedHistogram = {};
+    };
+
+    // Sums of the particles one thread reduced during a step.
+    struct CloudStatsPartial
+    {
+        uint64_t Count = 0;
+        double Mass = 0.0;
+        double KineticEnergy = 0.0;
+        double PotentialEnergy = 0.0;
+        std::array<double, 3> Momentum = {};
+        std::array<double, 3> MassMoment = {};
+        std::array<float, 3> BoundsMin = {};
+        std::array<float, 3> BoundsMax = {};
+        std::array<uint64_t, CloudStats::s_SpeedBins> SpeedHistogram = {};
+    };
+
+    std::string_view GetLayoutName(Layout layout) noexcept;
+    std::string_view GetKernelName(Kernel kernel) noexcept;
+    std::string_view GetForceLawName(ForceLaw force) noexcept;
+    std::string_view GetIntegratorName(Integrator integrator) noexcept;
+    std::string_view GetBoundaryName(Boundary boundary) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Bytes read and written per particle and step, used to report memory bandwidth.
+    //--------------------------------------------------------------------------------------
+    size_t GetBytesPerParticle(Layout layout) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Convert between the two storage layouts.
+    //--------------------------------------------------------------------------------------
+    void StoreToRecords(const ParticlesStore& store, std::vector<ParticleRecord>& records);
+
+    //--------------------------------------------------------------------------------------
+    // Advance the particles in [begin, end) by one step.
+    //--------------------------------------------------------------------------------------
+    void StepRange(ParticlesStore& store, const StepParameters& parameters, const KernelConfig& config, size_t begin, size_t end) noexcept;
+    void StepRange(
+        std::vector<ParticleRecord>& records,
+        const StepParameters& parameters,
+        const KernelConfig& config,
+        size_t begin,
+        size_t end) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Advance all particles by one step on the threads of the pool.
+    //--------------------------------------------------------------------------------------
+    void Step(ParticlesStore& store, const StepParameters& parameters, const KernelConfig& config, WorkerPool& workers);
+    void Step(std::vector<ParticleRecord>& records, const StepParameters& parameters, const KernelConfig& config, WorkerPool& workers);
+
+    //--------------------------------------------------------------------------------------
+    // Step like above and reduce the statistics of the stepped particles block by block,
+    // while each block is still in the cache, so they cost no second pass over the cloud.
+    //--------------------------------------------------------------------------------------
+    CloudStats StepWithStats(ParticlesStore& store, const StepParameters& parameters, const KernelConfig& config, WorkerPool& workers);
+
+    //--------------------------------------------------------------------------------------
+    // Add the particles in [begin, end) to a partial reduction. A block of at most
+    // s_StatsBlockSize particles is reduced in single precision, the partial in double.
+    //--------------------------------------------------------------------------------------
+    void ReduceStats(
+        const ParticlesStore& store,
+        const StepParameters& parameters,
+        const KernelConfig& config,
+        size_t begin,
+        size_t end,
+        CloudStatsPartial& partial) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Merge the partials of a step in order, the same partials always give the same stats.
+    //--------------------------------------------------------------------------------------
+    CloudStats MergeStats(std::span<const CloudStatsPartial> partials) noexcept;
+
+    // Particles per block of StepWithStats, small enough to stay in the L2 cache between the step and the reduction.
+    constexpr size_t s_StatsBlockSize = 4096;
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "ParticlesSimulationThread.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "Clock.h"
+#include "Profiler.h"
+
+ParticlesSimulationThread::ParticlesSimulationThread()
+    : m_kernel()
+    , m_threadCount(1)
+    , m_front(0)
+    , m_requestedStep(0)
+    , m_completedStep(0)
+    , m_remainingWorkers(0)
+    , m_stop(false)
+    , m_waitNanoseconds(0)
+{
+    m_substeps.reserve(s_MaxSubsteps);
+}
+
+ParticlesSimulationThread::~ParticlesSimulationThread()
+{
+    Shutdown();
+}
+
+void ParticlesSimulationThread::Initialize(
+    ParticlesStore&& store,
+    const ParticlesSimulation::KernelConfig& kernel,
+    size_t threadCount,
+    size_t capacity)
+{
+    Shutdown();
+
+    m_store = std::move(store);
+    m_store.Reserve(capacity);
+    m_pending.clear();
+    m_kernel = kernel;
+    m_threadCount = std::max<size_t>(threadCount, 1);
+    m_stats.fill({});
+    m_partials.resize(m_threadCount);
+
+    // Every buffer starts with the initial states, the first frames show them.
+    for (auto& states : m_states)
+    {
+        states.reserve(capacity);
+        states.resize(m_store.Size());
+        WriteStates(states, 0, m_store.Size());
+    }
+
+    m_front = 0;
+    m_requestedStep.store(0, std::memory_order_relaxed);
+    m_completedStep.store(0, std::memory_order_relaxed);
+    m_stop.store(false, std::memory_order_relaxed);
+    m_waitNanoseconds = 0;
+
+    m_remainingWorkers.store(0, std::memory_order_relaxed);
+
+    m_workers.reserve(m_threadCount);
+    for (size_t worker = 0; worker < m_threadCount; ++worker)
+    {
+        m_workers.emplace_back(&ParticlesSimulationThread::SimulationThread, this, worker);
+    }
+}
+
+void ParticlesSimulationThread::Shutdown()
+{
+    if (m_workers.empty())
+    {
+        return;
+    }
+
+    // Wake up the simulation threads with a request they exit on.
+    m_stop.store(true, std::memory_order_relaxed);
+    m_requestedStep.fetch_add(1, std::memory_order_release);
+    m_requestedStep.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+void ParticlesSimulationThread::AddParticles(ParticlesStore&& particles)
+{
+    m_pending.push_back(std::move(particles));
+}
+
+bool ParticlesSimulationThread::HasPendingParticles() const noexcept
+{
+    return !m_pending.empty();
+}
+
+void ParticlesSimulationThread::Swap(std::span<const ParticlesSimulation::StepParameters> substeps)
+{
+    PROFILE_ZONE("SimulationSwap");
+
+    const uint64_t requested = m_requestedStep.load(std::memory_order_relaxed);
+    const uint64_t waitStart = Clock::Now();
+
+    // Wait for the step started in the previous frame.
+    for (uint64_t completed = m_completedStep.load(std::memory_order_acquire); completed != requested;
+         completed = m_completedStep.load(std::memory_order_acquire))
+    {
+        m_completedStep.wait(completed, std::memory_order_acquire);
+    }
+
+    m_waitNanoseconds = Clock::Now() - waitStart;
+
+    StartStep(substeps);
+}
+
+bool ParticlesSimulationThread::TrySwap(std::span<const ParticlesSimulation::StepParameters> substeps)
+{
+    if (m_completedStep.load(std::memory_order_acquire) != m_requestedStep.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    m_waitNanoseconds = 0;
+
+    StartStep(substeps);
+
+    return true;
+}
+
+const ParticlesSimulationThread::StateBuffer& ParticlesSimulationThread::GetFrontStates() const noexcept
+{
+    return m_states[m_front];
+}
+
+const ParticlesSimulationThread::StateBuffer& ParticlesSimulationThread::GetPreviousStates() const noexcept
+{
+    return m_states[(m_front + 2) % s_BufferCount];
+}
+
+size_t ParticlesSimulationThread::Size() const noexcept
+{
+    return m_states[m_front].size();
+}
+
+const ParticlesSimulation::CloudStats& ParticlesSimulationThread::GetCloudStats() const noexcept
+{
+    return m_stats[m_front];
+}
+
+uint64_t ParticlesSimulationThread::GetStepIndex() const noexcept
+{
+    return m_completedStep.load(std::memory_order_relaxed);
+}
+
+uint64_t ParticlesSimulationThread::GetWaitNanoseconds() const noexcept
+{
+    return m_waitNanoseconds;
+}
+
+void ParticlesSimulationThread::StartStep(std::span<const ParticlesSimulation::StepParameters> substeps)
+{
+    const uint64_t requested = m_requestedStep.load(std::memory_order_relaxed);
+
+    // The finished back buffer becomes the front one, the oldest buffer receives the next step.
+    m_front = (m_front + 1) % s_BufferCount;
+    m_substeps.assign(substeps.begin(), substeps.begin() + std::min(substeps.size(), s_MaxSubsteps));
+
+    // The simulation thread is idle between two steps, so the particles join here. They start
+    // with their initial states in every buffer, like the first particles did.
+    for (const auto& particles : m_pending)
+    {
+        const size_t begin = m_store.Size();
+        m_store.Append(particles);
+
+        for (auto& states : m_states)
+        {
+            states.resize(m_store.Size());
+            WriteStates(states, begin, m_store.Size());
+        }
+    }
+    m_pending.clear();
+
+    m_remainingWorkers.store(m_threadCount, std::memory_order_relaxed);
+    m_requestedStep.store(requested + 1, std::memory_order_release);
+    m_requestedStep.notify_all();
+}
+
+void ParticlesSimulationThread::SimulationThread(size_t worker)
+{
+    uint64_t step = 0;
+
+    Profiler::SetThreadName(worker == 0 ? "Simulation" : "SimulationWorker");
+
+    while (true)
+    {
+        m_requestedStep.wait(step, std::memory_order_acquire);
+        step = m_requestedStep.load(std::memory_order_acquire);
+
+        if (m_stop.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        // The renderer only reads the front and the previous buffer until the next swap.
+        const uint32_t back = (m_front + 1) % s_BufferCount;
+
+        SimulateChunk(worker, back);
+
+        // The last thread to finish sees the partials of all others and completes the step.
+        if (m_remainingWorkers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            m_stats[back] = ParticlesSimulation::MergeStats(m_partials);
+
+            m_completedStep.store(step, std::memory_order_release);
+            m_completedStep.notify_one();
+        }
+    }
+}
+
+void ParticlesSimulationThread::SimulateChunk(size_t worker, uint32_t back) noexcept
+{
+    PROFILE_ZONE("SimulationStep");
+
+    // The same chunks as ParallelUtils::ParallelFor, so the statistics merge in the same order.
+    const size_t count = m_store.Size();
+    const size_t chunkSize = (count + m_threadCount - 1) / m_threadCount;
+    const size_t begin = std::min(worker * chunkSize, count);
+    const size_t end = std::min(begin + chunkSize, count);
+
+    auto& states = m_states[back];
+    auto& partial = m_partials[worker];
+    partial = {};
+
+    // The particles do not interact, so every block of particles runs all substeps, writes its
+    // states and adds to the statistics of its thread while it is still in the cache.
+    for (size_t blockBegin = begin; blockBegin < end; blockBegin += s_BlockSize)
+    {
+        const size_t blockEnd = std::min(blockBegin + s_BlockSize, end);
+
+        for (const auto& substep : m_substeps)
+        {
+            ParticlesSimulation::StepRange(m_store, substep, m_kernel, blockBegin, blockEnd);
+        }
+        WriteStates(states, blockBegin, blockEnd);
+
+        if (!m_substeps.empty())
+        {
+            ParticlesSimulation::ReduceStats(m_store, m_substeps.back(), m_kernel, blockBegin, blockEnd, partial);
+        }
+    }
+}
+
+void ParticlesSimulationThread::WriteStates(StateBuffer& states, size_t begin, size_t end) const noexcept
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        const float velocityX = m_store.VelocityX[i];
+        const float velocityY = m_store.VelocityY[i];
+        const float velocityZ = m_store.VelocityZ[i];
+
+        states[i] = ParticleState{
+            { m_store.PositionX[i], m_store.PositionY[i], m_store.PositionZ[i] },
+            std::sqrt(velocityX * velocityX + velocityY * velocityY + velocityZ * velocityZ),
+        };
+    }
+}
@@ -0,0 +1,115 @@
+#ifndef _PARTICLESSIMULATIONTHREAD_H_
+#define _PARTICLESSIMULATIONTHREAD_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "MemoryTracker.h"
+#include "ParticlesSimulation.h"
+#include "ParticlesStore.h"
+
+// What the renderer needs of one particle after a step, the layout of the GPU states buffer.
+struct ParticleState
+{
+    float Position[3];
+    float VelocityLength;
+};
+
+// Runs the particle step on its own thread, one step ahead of the renderer. The step writes the
+// particle states into the back buffer while the renderer reads the front buffer of the last step
+// and the one before it, to interpolate between the two. Swap waits for the step in flight,
+// rotates the buffers and starts the next step, so a frame costs max(simulation, render) and
+// shows the particles one step behind the input. TrySwap does the same only if the step is done.
+// A step may be split into substeps, one per well position along the input path of the frame.
+// The step runs on threadCount threads started once in Initialize. Each of them waits for the next
+// requested step and simulates its own chunk of the particles, the last one to finish completes
+// the step.
+class ParticlesSimulationThread
+{
+public:
+    using StateBuffer = MemoryTracker::Vector<ParticleState, MemoryTracker::Tag::ParticlesStates>;
+
+    ParticlesSimulationThread();
+    ParticlesSimulationThread(const ParticlesSimulationThread&) = delete;
+    ParticlesSimulationThread& operator=(const ParticlesSimulationThread&) = delete;
+    ~ParticlesSimulationThread();
+
+    //--------------------------------------------------------------------------------------
+    // Start the simulation of the particles. Memory for capacity particles is reserved up
+    // front, so the ones added later do not reallocate the buffers.
+    //--------------------------------------------------------------------------------------
+    void Initialize(
+        ParticlesStore&& store,
+        const ParticlesSimulation::KernelConfig& kernel,
+        size_t threadCount,
+        size_t capacity = 0);
+    void Shutdown();
+
+    //--------------------------------------------------------------------------------------
+    // Queue particles to join the simulation at the next swap, with their initial states in
+    // every buffer. Only the renderer thread adds particles.
+    //--------------------------------------------------------------------------------------
+    void AddParticles(ParticlesStore&& particles);
+    bool HasPendingParticles() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Makes the states of the last step the front buffer and starts the next step, made of
+    // the given substeps in order. At most s_MaxSubsteps are taken.
+    //--------------------------------------------------------------------------------------
+    void Swap(std::span<const ParticlesSimulation::StepParameters> substeps);
+    bool TrySwap(std::span<const ParticlesSimulation::StepParameters> substeps);
+
+    const StateBuffer& GetFrontStates() const noexcept;
+    const StateBuffer& GetPreviousStates() const noexcept;
+    size_t Size() const noexcept;
+
+    // Statistics of the cloud reduced while the front buffer was written, empty before the first step.
+    const ParticlesSimulation::CloudStats& GetCloudStats() const noexcept;
+
+    // Number of completed steps and the time the last Swap waited for its step.
+    uint64_t GetStepIndex() const noexcept;
+    uint64_t GetWaitNanoseconds() const noexcept;
+
+    static constexpr size_t s_MaxSubsteps = 16;
+
+private:
+    void StartStep(std::span<const ParticlesSimulation::StepParameters> substeps);
+    void SimulationThread(size_t worker);
+    void SimulateChunk(size_t worker, uint32_t back) noexcept;
+    void WriteStates(StateBuffer& states, size_t begin, size_t end) const noexcept;
+
+private:
+    ParticlesStore m_store;
+    std::vector<ParticlesStore> m_pending;
+    ParticlesSimulation::KernelConfig m_kernel;
+    size_t m_threadCount;
+
+    // Particles per block of the substep loop, small enough to stay in the L2 cache between substeps.
+    static constexpr size_t s_BlockSize = 4096;
+
+    // Front, back and previous buffer, in that order starting at m_front.
+    static constexpr uint32_t s_BufferCount = 3;
+
+    std::array<StateBuffer, s_BufferCount> m_states;
+    std::array<ParticlesSimulation::CloudStats, s_BufferCount> m_stats;
+    std::vector<ParticlesSimulation::CloudStatsPartial> m_partials;
+    uint32_t m_front;
+
+    // The renderer writes the substeps and the front index, then bumps m_requestedStep. The
+    // simulation thread answers through m_completedStep once the back buffer is written.
+    std::vector<ParticlesSimulation::StepParameters> m_substeps;
+    std::atomic<uint64_t> m_requestedStep;
+    std::atomic<uint64_t> m_completedStep;
+    std::atomic<size_t> m_remainingWorkers;
+    std::atomic<bool> m_stop;
+    std::vector<std::thread> m_workers;
+
+    uint64_t m_waitNanoseconds;
+};
+
+#endif
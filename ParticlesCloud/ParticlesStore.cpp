@@ -0,0 +1,101 @@
+#include "ParticlesStore.h"
+
+#include <algorithm>
+#include <random>
+
+namespace
+{
+    // SplitMix64 finalizer, neighbouring blocks get unrelated seeds.
+    uint64_t MixSeed(uint64_t value) noexcept
+    {
+        value += 0x9e3779b97f4a7c15ull;
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
+    }
+}
+
+void ParticlesStore::Resize(size_t count)
+{
+    PositionX.resize(count);
+    PositionY.resize(count);
+    PositionZ.resize(count);
+
+    VelocityX.resize(count);
+    VelocityY.resize(count);
+    VelocityZ.resize(count);
+
+    Mass.resize(count, 1.0f);
+}
+
+void ParticlesStore::Reserve(size_t count)
+{
+    PositionX.reserve(count);
+    PositionY.reserve(count);
+    PositionZ.reserve(count);
+
+    VelocityX.reserve(count);
+    VelocityY.reserve(count);
+    VelocityZ.reserve(count);
+
+    Mass.reserve(count);
+}
+
+void ParticlesStore::Clear() noexcept
+{
+    PositionX.clear();
+    PositionY.clear();
+    PositionZ.clear();
+
+    VelocityX.clear();
+    VelocityY.clear();
+    VelocityZ.clear();
+
+    Mass.clear();
+}
+
+size_t ParticlesStore::Size() const noexcept
+{
+    return PositionX.size();
+}
+
+void ParticlesStore::Append(const ParticlesStore& particles)
+{
+    PositionX.insert(PositionX.end(), particles.PositionX.begin(), particles.PositionX.end());
+    PositionY.insert(PositionY.end(), particles.PositionY.begin(), particles.PositionY.end());
+    PositionZ.insert(PositionZ.end(), particles.PositionZ.begin(), particles.PositionZ.end());
+
+    VelocityX.insert(VelocityX.end(), particles.VelocityX.begin(), particles.VelocityX.end());
+    VelocityY.insert(VelocityY.end(), particles.VelocityY.begin(), particles.VelocityY.end());
+    VelocityZ.insert(VelocityZ.end(), particles.VelocityZ.begin(), particles.VelocityZ.end());
+
+    Mass.insert(Mass.end(), particles.Mass.begin(), particles.Mass.end());
+}
+
+void ParticlesStore::GenerateUniformCube(size_t count, float extent, size_t first)
+{
+    std::uniform_real_distribution<float> positionDistribution(-extent, extent);
+
+    Clear();
+    Resize(count);
+
+    // Every block of the cloud has its own seed, so a piece starts drawing at its first
+    // particle instead of replaying the cloud before it. Keep the x, y, z draw order so the
+    // same seed always produces the same cloud.
+    for (size_t i = 0; i < count;)
+    {
+        const size_t index = first + i;
+        const size_t block = index / s_GenerationBlock;
+        const size_t blockEnd = std::min((block + 1) * s_GenerationBlock - first, count);
+
+        std::default_random_engine generator(static_cast<std::default_random_engine::result_type>(MixSeed(block)));
+        generator.discard(3 * (index - block * s_GenerationBlock));
+
+        for (; i < blockEnd; ++i)
+        {
+            PositionX[i] = positionDistribution(generator);
+            PositionY[i] = positionDistribution(generator);
+            PositionZ[i] = positionDistribution(generator);
+        }
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef _PARTICLESSTORE_H_
+#define _PARTICLESSTORE_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "MemoryTracker.h"
+
+// CPU-side particle state kept as structure of arrays, so loaders and the simulation can stream each
+// component independently. The GPU buffers are expanded from it on upload.
+class ParticlesStore
+{
+public:
+    template<typename T>
+    using Array = MemoryTracker::Vector<T, MemoryTracker::Tag::ParticlesStore>;
+
+public:
+    void Resize(size_t count);
+    void Reserve(size_t count);
+    void Clear() noexcept;
+    size_t Size() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Add the particles at the end, without reallocating while the reserved capacity lasts.
+    //--------------------------------------------------------------------------------------
+    void Append(const ParticlesStore& particles);
+
+    //--------------------------------------------------------------------------------------
+    // Fill the store with count particles of the cloud, starting with particle first. A
+    // particle only depends on its index, so a cloud generated in pieces, in any order and
+    // on any number of threads, equals the one generated at once.
+    //--------------------------------------------------------------------------------------
+    void GenerateUniformCube(size_t count, float extent, size_t first = 0);
+
+    // Particles drawn from one seed of the random engine.
+    static constexpr size_t s_GenerationBlock = 65536;
+
+public:
+    Array<float> PositionX;
+    Array<float> PositionY;
+    Array<float> PositionZ;
+
+    Array<float> VelocityX;
+    Array<float> VelocityY;
+    Array<float> VelocityZ;
+
+    Array<float> Mass;
+};
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Operating system services used by the portable core: threads, the executable location, process
+// CPU time and memory, and the machine CPU counters. PlatformWin32.cpp and PlatformPosix.cpp
+// implement them, the build compiles the one that matches the target.
+namespace Platform
+{
+    //--------------------------------------------------------------------------------------
+    // Calling thread. Ids match the ones reported by EnumerateThreadTimes.
+    //--------------------------------------------------------------------------------------
+    uint64_t GetCurrentThreadId() noexcept;
+    void SetCurrentThreadName(std::string_view name);
+    void LowerCurrentThreadPriority() noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Directory of the running executable, so files deployed next to it are found whatever
+    // the working directory is. Empty when it cannot be determined.
+    //--------------------------------------------------------------------------------------
+    std::string GetExecutableDirectory();
+
+    //--------------------------------------------------------------------------------------
+    // Resident set size of the process and its peak, in bytes.
+    //--------------------------------------------------------------------------------------
+    bool GetProcessMemory(uint64_t& residentBytes, uint64_t& peakResidentBytes);
+
+    //--------------------------------------------------------------------------------------
+    // User plus kernel time of every thread of the process, including the ones that exited,
+    // in nanoseconds.
+    //--------------------------------------------------------------------------------------
+    uint64_t GetProcessCpuTime() noexcept;
+
+    struct ThreadTimes
+    {
+        uint64_t Id = 0;
+        char Name[16] = {};
+        uint64_t Time = 0;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // User plus kernel time of every live thread of the process, in nanoseconds.
+    //--------------------------------------------------------------------------------------
+    bool EnumerateThreadTimes(std::vector<ThreadTimes>& threads);
+
+    //--------------------------------------------------------------------------------------
+    // Machine wide CPU usage between two calls of Sample, in percent: PDH counters on
+    // Windows, /proc/stat on Linux.
+    //--------------------------------------------------------------------------------------
+    class SystemCpuCounters
+    {
+    public:
+        SystemCpuCounters();
+        SystemCpuCounters(const SystemCpuCounters&) = delete;
+        SystemCpuCounters& operator=(const SystemCpuCounters&) = delete;
+        ~SystemCpuCounters();
+
+        bool Open();
+        void Close() noexcept;
+
+        // Fills the cores the counters reported, in core order. Returns false until there
+        // are two collections to compare.
+        bool Sample(float& systemPercentage, std::vector<float>& corePercentages);
+
+    private:
+        struct State;
+        std::unique_ptr<State> m_state;
+    };
+};
+
+#endif
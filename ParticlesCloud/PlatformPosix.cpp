@@ -0,0 +1,245 @@
+#ifndef _WIN32
+
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+    struct CoreTimes
+    {
+        uint64_t Busy = 0;
+        uint64_t Total = 0;
+    };
+
+    uint64_t ToNanoseconds(const timeval& time) noexcept
+    {
+        return static_cast<uint64_t>(time.tv_sec) * 1000000000 + static_cast<uint64_t>(time.tv_usec) * 1000;
+    }
+
+    float ToPercentage(uint64_t busy, uint64_t total) noexcept
+    {
+        return total > 0 && busy <= total ? 100.0f * static_cast<float>(busy) / static_cast<float>(total) : 0.0f;
+    }
+}
+
+struct Platform::SystemCpuCounters::State
+{
+    std::vector<CoreTimes> LastCoreTimes;
+};
+
+uint64_t Platform::GetCurrentThreadId() noexcept
+{
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+}
+
+void Platform::SetCurrentThreadName(std::string_view name)
+{
+    // Linux limits thread names to 15 characters.
+    const std::string shortName{ name.substr(0, 15) };
+    pthread_setname_np(pthread_self(), shortName.c_str());
+}
+
+void Platform::LowerCurrentThreadPriority() noexcept
+{
+    // On Linux the nice value applies to the calling thread only.
+    setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 10);
+}
+
+std::string Platform::GetExecutableDirectory()
+{
+    std::error_code error;
+
+    const auto executable = std::filesystem::read_symlink("/proc/self/exe", error);
+    if (error)
+    {
+        return {};
+    }
+
+    return executable.parent_path().string();
+}
+
+bool Platform::GetProcessMemory(uint64_t& residentBytes, uint64_t& peakResidentBytes)
+{
+    std::ifstream fin{ "/proc/self/status" };
+    std::string line;
+    bool foundResident = false, foundPeak = false;
+
+    // VmRSS and VmHWM (the high water mark of VmRSS) are reported in kB.
+    while (std::getline(fin, line))
+    {
+        if (line.compare(0, 6, "VmRSS:") == 0)
+        {
+            residentBytes = std::stoull(line.substr(6)) * 1024;
+            foundResident = true;
+        }
+        else if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            peakResidentBytes = std::stoull(line.substr(6)) * 1024;
+            foundPeak = true;
+        }
+    }
+
+    return foundResident && foundPeak;
+}
+
+uint64_t Platform::GetProcessCpuTime() noexcept
+{
+    rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return 0;
+    }
+
+    return ToNanoseconds(usage.ru_utime) + ToNanoseconds(usage.ru_stime);
+}
+
+bool Platform::EnumerateThreadTimes(std::vector<ThreadTimes>& threads)
+{
+    std::error_code error;
+
+    const double nanosecondsPerTick = 1e9 / static_cast<double>(sysconf(_SC_CLK_TCK));
+
+    threads.clear();
+
+    for (const auto& task : std::filesystem::directory_iterator("/proc/self/task", error))
+    {
+        std::ifstream statFile{ task.path() / "stat" };
+        std::ifstream commFile{ task.path() / "comm" };
+        std::string stat, name;
+
+        if (!std::getline(statFile, stat))
+        {
+            continue;
+        }
+
+        // The thread name is in parentheses and may contain spaces, the fields that follow start
+        // with the state (field 3); utime and stime are fields 14 and 15.
+        const auto nameEnd = stat.rfind(')');
+        if (nameEnd == std::string::npos)
+        {
+            continue;
+        }
+
+        std::istringstream fields{ stat.substr(nameEnd + 1) };
+        std::string field;
+        uint64_t userTicks = 0, systemTicks = 0;
+
+        for (int index = 3; index <= 15 && fields >> field; ++index)
+        {
+            if (index == 14)
+            {
+                userTicks = std::strtoull(field.c_str(), nullptr, 10);
+            }
+            else if (index == 15)
+            {
+                systemTicks = std::strtoull(field.c_str(), nullptr, 10);
+            }
+        }
+
+        ThreadTimes thread;
+        thread.Id = std::strtoull(task.path().filename().c_str(), nullptr, 10);
+        thread.Time = static_cast<uint64_t>(static_cast<double>(userTicks + systemTicks) * nanosecondsPerTick);
+
+        std::getline(commFile, name);
+        std::strncpy(thread.Name, name.c_str(), sizeof(thread.Name) - 1);
+
+        threads.push_back(thread);
+    }
+
+    return !error;
+}
+
+Platform::SystemCpuCounters::SystemCpuCounters() = default;
+
+Platform::SystemCpuCounters::~SystemCpuCounters()
+{
+    Close();
+}
+
+bool Platform::SystemCpuCounters::Open()
+{
+    float systemPercentage;
+    std::vector<float> corePercentages;
+
+    // /proc is always there, the first read is the baseline.
+    m_state = std::make_unique<State>();
+    Sample(systemPercentage, corePercentages);
+
+    return !m_state->LastCoreTimes.empty();
+}
+
+void Platform::SystemCpuCounters::Close() noexcept
+{
+    m_state.reset();
+}
+
+bool Platform::SystemCpuCounters::Sample(float& systemPercentage, std::vector<float>& corePercentages)
+{
+    std::ifstream fin{ "/proc/stat" };
+    std::string line;
+    std::vector<CoreTimes> coreTimes;
+
+    if (!m_state)
+    {
+        return false;
+    }
+
+    // The "cpu" line sums every core, the "cpuN" lines follow. Times are user, nice, system, idle,
+    // iowait, irq, softirq and steal, in clock ticks since boot.
+    while (std::getline(fin, line) && line.compare(0, 3, "cpu") == 0)
+    {
+        std::istringstream fields{ line.substr(line.find(' ')) };
+        uint64_t times[8] = {};
+
+        for (auto& time : times)
+        {
+            fields >> time;
+        }
+
+        CoreTimes core;
+        for (const auto time : times)
+        {
+            core.Total += time;
+        }
+        core.Busy = core.Total - times[3] - times[4];
+
+        coreTimes.push_back(core);
+    }
+
+    auto& lastCoreTimes = m_state->LastCoreTimes;
+    const bool result = !coreTimes.empty() && coreTimes.size() == lastCoreTimes.size();
+
+    if (result)
+    {
+        const auto percentage = [&](size_t i) {
+            return ToPercentage(coreTimes[i].Busy - lastCoreTimes[i].Busy, coreTimes[i].Total - lastCoreTimes[i].Total);
+        };
+
+        systemPercentage = percentage(0);
+
+        corePercentages.resize(coreTimes.size() - 1);
+        for (size_t i = 1; i < coreTimes.size(); ++i)
+        {
+            corePercentages[i - 1] = percentage(i);
+        }
+    }
+
+    lastCoreTimes = std::move(coreTimes);
+
+    return result;
+}
+
+#endif
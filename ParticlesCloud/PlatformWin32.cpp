@@ -0,0 +1,240 @@
+#ifdef _WIN32
+
+#include "Platform.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cwchar>
+#include <string>
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <pdh.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+
+namespace
+{
+    uint64_t ToNanoseconds(const FILETIME& time) noexcept
+    {
+        // FILETIME counts 100 nanosecond intervals.
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+    }
+}
+
+struct Platform::SystemCpuCounters::State
+{
+    HQUERY Query = nullptr;
+    HCOUNTER TotalCounter = nullptr;
+    HCOUNTER CoresCounter = nullptr;
+};
+
+uint64_t Platform::GetCurrentThreadId() noexcept
+{
+    return ::GetCurrentThreadId();
+}
+
+void Platform::SetCurrentThreadName(std::string_view name)
+{
+    const std::wstring wideName(name.begin(), name.end());
+    SetThreadDescription(GetCurrentThread(), wideName.c_str());
+}
+
+void Platform::LowerCurrentThreadPriority() noexcept
+{
+    SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+}
+
+std::string Platform::GetExecutableDirectory()
+{
+    char path[MAX_PATH];
+
+    const DWORD length = GetModuleFileNameA(nullptr, path, MAX_PATH);
+    if (length == 0 || length == MAX_PATH)
+    {
+        return {};
+    }
+
+    const std::string_view executable{ path, length };
+    const size_t separator = executable.find_last_of("\\/");
+
+    return std::string(executable.substr(0, separator == std::string_view::npos ? 0 : separator));
+}
+
+bool Platform::GetProcessMemory(uint64_t& residentBytes, uint64_t& peakResidentBytes)
+{
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return false;
+    }
+
+    residentBytes = counters.WorkingSetSize;
+    peakResidentBytes = counters.PeakWorkingSetSize;
+
+    return true;
+}
+
+uint64_t Platform::GetProcessCpuTime() noexcept
+{
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+
+    if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+    {
+        return 0;
+    }
+
+    return ToNanoseconds(kernelTime) + ToNanoseconds(userTime);
+}
+
+bool Platform::EnumerateThreadTimes(std::vector<ThreadTimes>& threads)
+{
+    THREADENTRY32 entry;
+
+    threads.clear();
+
+    HANDLE threadsSnapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (threadsSnapshot == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    const DWORD processId = GetCurrentProcessId();
+    entry.dwSize = sizeof(entry);
+
+    for (BOOL found = Thread32First(threadsSnapshot, &entry); found; found = Thread32Next(threadsSnapshot, &entry))
+    {
+        FILETIME creationTime, exitTime, kernelTime, userTime;
+        PWSTR description = nullptr;
+
+        if (entry.th32OwnerProcessID != processId)
+        {
+            continue;
+        }
+
+        HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE, entry.th32ThreadID);
+        if (!thread)
+        {
+            continue;
+        }
+
+        if (GetThreadTimes(thread, &creationTime, &exitTime, &kernelTime, &userTime))
+        {
+            ThreadTimes times;
+            times.Id = entry.th32ThreadID;
+            times.Time = ToNanoseconds(kernelTime) + ToNanoseconds(userTime);
+
+            if (SUCCEEDED(GetThreadDescription(thread, &description)) && description)
+            {
+                WideCharToMultiByte(CP_UTF8, 0, description, -1, times.Name, sizeof(times.Name) - 1, nullptr, nullptr);
+                LocalFree(description);
+            }
+
+            threads.push_back(times);
+        }
+
+        CloseHandle(thread);
+    }
+
+    CloseHandle(threadsSnapshot);
+
+    return true;
+}
+
+Platform::SystemCpuCounters::SystemCpuCounters() = default;
+
+Platform::SystemCpuCounters::~SystemCpuCounters()
+{
+    Close();
+}
+
+bool Platform::SystemCpuCounters::Open()
+{
+    PDH_STATUS status;
+    auto state = std::make_unique<State>();
+
+    // Create a query object to poll cpu usage.
+    status = PdhOpenQuery(NULL, 0, &state->Query);
+    if (status != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    // Set query object to poll all cpus in the system, together and one by one.
+    status = PdhAddEnglishCounterW(state->Query, L"\\Processor(_Total)\\% processor time", 0, &state->TotalCounter);
+    if (status == ERROR_SUCCESS)
+    {
+        status = PdhAddEnglishCounterW(state->Query, L"\\Processor(*)\\% processor time", 0, &state->CoresCounter);
+    }
+
+    if (status != ERROR_SUCCESS)
+    {
+        PdhCloseQuery(state->Query);
+        return false;
+    }
+
+    // Rates need two collections, the first one is the baseline.
+    PdhCollectQueryData(state->Query);
+
+    m_state = std::move(state);
+
+    return true;
+}
+
+void Platform::SystemCpuCounters::Close() noexcept
+{
+    if (m_state)
+    {
+        PdhCloseQuery(m_state->Query);
+        m_state.reset();
+    }
+}
+
+bool Platform::SystemCpuCounters::Sample(float& systemPercentage, std::vector<float>& corePercentages)
+{
+    PDH_FMT_COUNTERVALUE value;
+    DWORD bufferSize = 0, itemCount = 0;
+
+    if (!m_state || PdhCollectQueryData(m_state->Query) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    if (PdhGetFormattedCounterValue(m_state->TotalCounter, PDH_FMT_DOUBLE, nullptr, &value) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    systemPercentage = static_cast<float>(value.doubleValue);
+
+    // The first call returns the size of the array of instances.
+    PdhGetFormattedCounterArrayW(m_state->CoresCounter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, nullptr);
+
+    std::vector<std::byte> buffer(bufferSize);
+    auto items = reinterpret_cast<PDH_FMT_COUNTERVALUE_ITEM_W*>(buffer.data());
+
+    if (PdhGetFormattedCounterArrayW(m_state->CoresCounter, PDH_FMT_DOUBLE, &bufferSize, &itemCount, items) != ERROR_SUCCESS)
+    {
+        return false;
+    }
+
+    // Instances are named by the core index, plus "_Total".
+    corePercentages.clear();
+    for (DWORD i = 0; i < itemCount; ++i)
+    {
+        if (items[i].szName[0] < L'0' || items[i].szName[0] > L'9')
+        {
+            continue;
+        }
+
+        const auto core = static_cast<size_t>(std::wcstoul(items[i].szName, nullptr, 10));
+        corePercentages.resize(std::max(corePercentages.size(), core + 1));
+        corePercentages[core] = static_cast<float>(items[i].FmtValue.doubleValue);
+    }
+
+    return true;
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Platform.h"
+
+namespace
+{
+    struct ZoneRecord
+    {
+        const char* Name;
+        uint64_t Begin;
+        uint64_t End;
+        uint32_t Frame;
+        uint32_t ThreadId;
+    };
+
+    // 16K zones per thread, a few hundred frames of the main loop.
+    constexpr size_t s_RingCapacity = 16 * 1024;
+
+    struct ZoneRing
+    {
+        std::array<ZoneRecord, s_RingCapacity> Records;
+        std::atomic<uint64_t> WriteIndex{ 0 };
+        std::atomic<bool> InUse{ false };
+        uint32_t ThreadId = 0;
+    };
+
+    struct Registry
+    {
+        std::mutex Mutex;
+        std::vector<std::unique_ptr<ZoneRing>> Rings;
+        std::map<uint32_t, std::string> ThreadNames;
+        uint32_t NextThreadId = 1;
+
+        uint64_t StartTicks = Clock::ReadTicks();
+    };
+
+    std::atomic<uint32_t> s_FrameIndex{ 0 };
+
+    Registry& GetRegistry()
+    {
+        static Registry registry;
+        return registry;
+    }
+
+    // Rings are owned by the registry and only lent to threads, so the zones of finished worker
+    // threads can still be exported and the ring is reused by the next thread.
+    struct RingLease
+    {
+        ZoneRing* Ring = nullptr;
+
+        ~RingLease()
+        {
+            if (Ring)
+            {
+                Ring->InUse.store(false, std::memory_order_release);
+            }
+        }
+    };
+
+    ZoneRing& AcquireRing()
+    {
+        thread_local RingLease lease;
+
+        if (lease.Ring)
+        {
+            return *lease.Ring;
+        }
+
+        auto& registry = GetRegistry();
+        std::lock_guard lock{ registry.Mutex };
+
+        for (auto& ring : registry.Rings)
+        {
+            if (!ring->InUse.load(std::memory_order_acquire))
+            {
+                lease.Ring = ring.get();
+                break;
+            }
+        }
+
+        if (!lease.Ring)
+        {
+            registry.Rings.push_back(std::make_unique<ZoneRing>());
+            lease.Ring = registry.Rings.back().get();
+        }
+
+        lease.Ring->InUse.store(true, std::memory_order_relaxed);
+        lease.Ring->ThreadId = registry.NextThreadId++;
+
+        return *lease.Ring;
+    }
+
+    // Copy the live part of a ring, skipping the records the owner may have overwritten meanwhile.
+    void CopyRing(const ZoneRing& ring, std::vector<ZoneRecord>& records)
+    {
+        const auto end = ring.WriteIndex.load(std::memory_order_acquire);
+        const auto begin = end > s_RingCapacity ? end - s_RingCapacity : 0;
+        const auto first = records.size();
+
+        for (auto i = begin; i < end; ++i)
+        {
+            records.push_back(ring.Records[i % s_RingCapacity]);
+        }
+
+        // The owner writes record `after` into its slot before publishing it, so that slot may be torn
+        // already, one more than the published index says.
+        const auto after = ring.WriteIndex.load(std::memory_order_acquire);
+        const auto valid = after + 1 > s_RingCapacity ? after + 1 - s_RingCapacity : 0;
+        if (valid > begin)
+        {
+            const auto overwritten = static_cast<size_t>(std::min(valid, end) - begin);
+            records.erase(records.begin() + first, records.begin() + first + overwritten);
+        }
+    }
+}
+
+void Profiler::BeginFrame() noexcept
+{
+    s_FrameIndex.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t Profiler::GetFrameIndex() noexcept
+{
+    return s_FrameIndex.load(std::memory_order_relaxed);
+}
+
+void Profiler::SetThreadName(std::string_view name)
+{
+    const auto threadId = AcquireRing().ThreadId;
+    auto& registry = GetRegistry();
+
+    Platform::SetCurrentThreadName(name);
+
+    std::lock_guard lock{ registry.Mutex };
+    registry.ThreadNames[threadId] = name;
+}
+
+void Profiler::RecordZone(const char* name, uint64_t begin, uint64_t end) noexcept
+{
+    auto& ring = AcquireRing();
+    const auto index = ring.WriteIndex.load(std::memory_order_relaxed);
+
+    ring.Records[index % s_RingCapacity] = ZoneRecord{ name, begin, end, GetFrameIndex(), ring.ThreadId };
+    ring.WriteIndex.store(index + 1, std::memory_order_release);
+}
+
+bool Profiler::ExportChromeTrace(std::string_view filename, uint32_t frameCount)
+{
+    auto& registry = GetRegistry();
+    std::vector<ZoneRecord> records;
+    std::map<uint32_t, std::string> threadNames;
+
+    // Snapshot every ring. Holding the registry lock only blocks threads that record their first zone.
+    {
+        std::lock_guard lock{ registry.Mutex };
+
+        for (const auto& ring : registry.Rings)
+        {
+            CopyRing(*ring, records);
+        }
+
+        threadNames = registry.ThreadNames;
+    }
+
+    // Convert ticks to microseconds with the calibrated tick rate.
+    const double microsecondsPerTick = Clock::GetNanosecondsPerTick() / static_cast<double>(Clock::s_NanosecondsPerMicrosecond);
+
+    const auto currentFrame = GetFrameIndex();
+    const auto firstFrame = currentFrame >= frameCount ? currentFrame - frameCount + 1 : 0;
+
+    records.erase(
+        std::remove_if(records.begin(), records.end(), [&](const ZoneRecord& record) { return record.Frame < firstFrame; }),
+        records.end());
+    std::sort(records.begin(), records.end(), [](const ZoneRecord& a, const ZoneRecord& b) { return a.Begin < b.Begin; });
+
+    std::ofstream fout{ std::string(filename) };
+    if (fout.fail())
+    {
+        return false;
+    }
+
+    fout << std::fixed << std::setprecision(3);
+    fout << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+    bool first = true;
+    for (const auto& [threadId, name] : threadNames)
+    {
+        fout << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadId
+             << ",\"args\":{\"name\":\"" << name << "\"}}";
+        first = false;
+    }
+
+    for (const auto& record : records)
+    {
+        const double begin = static_cast<double>(static_cast<int64_t>(record.Begin - registry.StartTicks)) * microsecondsPerTick;
+        const double duration = static_cast<double>(record.End - record.Begin) * microsecondsPerTick;
+
+        fout << (first ? "" : ",\n") << "{\"name\":\"" << record.Name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << record.ThreadId
+             << ",\"ts\":" << begin << ",\"dur\":" << duration << ",\"args\":{\"frame\":" << record.Frame << "}}";
+        first = false;
+    }
+
+    fout << "\n]}\n";
+
+    return !fout.fail();
+}
@@ -0,0 +1,66 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "Clock.h"
+
+// Scoped timing zones for the frame phases. Every thread writes its zones into its own ring
+// buffer, so recording takes two Clock::ReadTicks calls and a store and never locks. The rings keep
+// the most recent zones and can be written out as a Chrome trace (chrome://tracing, Perfetto).
+namespace Profiler
+{
+    //--------------------------------------------------------------------------------------
+    // Mark the start of a new frame. Zones are tagged with the frame they finished in.
+    //--------------------------------------------------------------------------------------
+    void BeginFrame() noexcept;
+    uint32_t GetFrameIndex() noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Name the calling thread in the exported trace and for the OS, so debuggers and the
+    // CPU sampler show the same name.
+    //--------------------------------------------------------------------------------------
+    void SetThreadName(std::string_view name);
+
+    //--------------------------------------------------------------------------------------
+    // Record a finished zone on the calling thread, begin and end are Clock ticks. The name
+    // must outlive the profiler, in practice it is a string literal.
+    //--------------------------------------------------------------------------------------
+    void RecordZone(const char* name, uint64_t begin, uint64_t end) noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Write the zones of the last frameCount frames of every thread as Chrome trace-event
+    // JSON. Zones of running threads that are overwritten during the export are dropped.
+    //--------------------------------------------------------------------------------------
+    bool ExportChromeTrace(std::string_view filename, uint32_t frameCount);
+
+    class ScopedZone
+    {
+    public:
+        explicit ScopedZone(const char* name) noexcept
+            : m_name(name)
+            , m_begin(Clock::ReadTicks())
+        {
+        }
+
+        ScopedZone(const ScopedZone&) = delete;
+        ScopedZone& operator=(const ScopedZone&) = delete;
+
+        ~ScopedZone()
+        {
+            RecordZone(m_name, m_begin, Clock::ReadTicks());
+        }
+
+    private:
+        const char* m_name;
+        uint64_t m_begin;
+    };
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::ScopedZone PROFILE_CONCAT(profileZone, __LINE__){ name }
+
+#endif
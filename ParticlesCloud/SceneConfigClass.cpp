@@ -0,0 +1,280 @@
+#include "SceneConfigClass.h"
+
+#include <charconv>
+#include <fstream>
+#include <sstream>
+
+#include "Clock.h"
+
+namespace
+{
+    std::string_view Trim(std::string_view text) noexcept
+    {
+        const auto begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos)
+        {
+            return {};
+        }
+
+        const auto end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    bool ParseValue(std::string_view text, size_t& value)
+    {
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+    }
+
+    // Accepts plain numbers as well as simple fractions such as "1/15".
+    bool ParseValue(std::string_view text, float& value)
+    {
+        const auto slash = text.find('/');
+        if (slash != std::string_view::npos)
+        {
+            float numerator, denominator;
+            if (!ParseValue(Trim(text.substr(0, slash)), numerator) || !ParseValue(Trim(text.substr(slash + 1)), denominator) ||
+                denominator == 0.0f)
+            {
+                return false;
+            }
+
+            value = numerator / denominator;
+            return true;
+        }
+
+        const auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+    }
+
+    bool ParseValue(std::string_view text, bool& value)
+    {
+        if (text == "true" || text == "1")
+        {
+            value = true;
+            return true;
+        }
+
+        if (text == "false" || text == "0")
+        {
+            value = false;
+            return true;
+        }
+
+        return false;
+    }
+}
+
+SceneConfigClass::SceneConfigClass()
+    : m_lastWriteTime()
+    , m_lastCheckTime(0)
+    , m_changed(false)
+{
+}
+
+bool SceneConfigClass::Initialize(std::string_view filename)
+{
+    std::error_code error;
+
+    m_filename = filename;
+    m_lastCheckTime = Clock::Now();
+
+    // A missing scene file is not an error, the built-in defaults are used instead.
+    if (!std::filesystem::exists(m_filename, error))
+    {
+        return true;
+    }
+
+    m_lastWriteTime = std::filesystem::last_write_time(m_filename, error);
+
+    return Reload();
+}
+
+void SceneConfigClass::Frame()
+{
+    std::error_code error;
+
+    m_changed = false;
+
+    // Only look at the file once per second, the check is a filesystem call.
+    const uint64_t now = Clock::Now();
+    if (now - m_lastCheckTime < Clock::s_NanosecondsPerSecond)
+    {
+        return;
+    }
+
+    m_lastCheckTime = now;
+
+    const auto writeTime = std::filesystem::last_write_time(m_filename, error);
+    if (error || writeTime == m_lastWriteTime)
+    {
+        return;
+    }
+
+    m_lastWriteTime = writeTime;
+
+    // Keep running with the previous parameters if the edited file does not parse.
+    m_changed = Reload();
+}
+
+bool SceneConfigClass::HasChanged() const noexcept
+{
+    return m_changed;
+}
+
+const SceneParameters& SceneConfigClass::GetParameters() const noexcept
+{
+    return m_parameters;
+}
+
+SceneParameters& SceneConfigClass::GetParameters() noexcept
+{
+    return m_parameters;
+}
+
+const std::string& SceneConfigClass::GetErrorMessage() const noexcept
+{
+    return m_errorMessage;
+}
+
+bool SceneConfigClass::Reload()
+{
+    std::ifstream fin{ m_filename };
+    std::stringstream text;
+    SceneParameters parameters;
+
+    if (fin.fail())
+    {
+        m_errorMessage = "Could not open the scene file.";
+        return false;
+    }
+
+    text << fin.rdbuf();
+
+    if (!Parse(text.str(), parameters, m_errorMessage))
+    {
+        return false;
+    }
+
+    m_parameters = parameters;
+    m_errorMessage.clear();
+
+    return true;
+}
+
+bool SceneConfigClass::Parse(std::string_view text, SceneParameters& parameters, std::string& errorMessage)
+{
+    int lineNumber = 0;
+
+    while (!text.empty())
+    {
+        const auto lineEnd = text.find('\n');
+        auto line = text.substr(0, lineEnd);
+        text = (lineEnd == std::string_view::npos) ? std::string_view{} : text.substr(lineEnd + 1);
+        ++lineNumber;
+
+        // Strip comments and skip blank lines.
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty())
+        {
+            continue;
+        }
+
+        const auto separator = line.find('=');
+        if (separator == std::string_view::npos)
+        {
+            errorMessage = "Line " + std::to_string(lineNumber) + ": expected \"Key = Value\".";
+            return false;
+        }
+
+        const auto key = Trim(line.substr(0, separator));
+        const auto value = Trim(line.substr(separator + 1));
+        bool result;
+
+        if (key == "ParticlesNumber")
+        {
+            result = ParseValue(value, parameters.ParticlesNumber) && parameters.ParticlesNumber > 0;
+        }
+        else if (key == "SpawnExtent")
+        {
+            result = ParseValue(value, parameters.SpawnExtent) && parameters.SpawnExtent > 0.0f;
+        }
+        else if (key == "ParticlesFile")
+        {
+            parameters.ParticlesFile = value;
+            result = true;
+        }
+        else if (key == "TimeScale")
+        {
+            result = ParseValue(value, parameters.TimeScale) && parameters.TimeScale >= 0.0f;
+        }
+        else if (key == "BillboardSize")
+        {
+            result = ParseValue(value, parameters.BillboardSize) && parameters.BillboardSize > 0.0f;
+        }
+        else if (key == "WellOrbitRadius")
+        {
+            result = ParseValue(value, parameters.WellOrbitRadius);
+        }
+        else if (key == "CameraDrift")
+        {
+            result = ParseValue(value, parameters.CameraDrift);
+        }
+        else if (key == "SimulationThread")
+        {
+            result = ParseValue(value, parameters.SimulationThread);
+        }
+        else if (key == "SimulationRate")
+        {
+            result = ParseValue(value, parameters.SimulationRate) && parameters.SimulationRate >= 0.0f;
+        }
+        else if (key == "InputSubsteps")
+        {
+            result = ParseValue(value, parameters.InputSubsteps) && parameters.InputSubsteps > 0;
+        }
+        else if (key == "InputRecordFile")
+        {
+            parameters.InputRecordFile = value;
+            result = true;
+        }
+        else if (key == "InputPlaybackFile")
+        {
+            parameters.InputPlaybackFile = value;
+            result = true;
+        }
+        else if (key == "FullScreen")
+        {
+            result = ParseValue(value, parameters.FullScreen);
+        }
+        else if (key == "VSyncEnabled")
+        {
+            result = ParseValue(value, parameters.VSyncEnabled);
+        }
+        else if (key == "TraceFile")
+        {
+            parameters.TraceFile = value;
+            result = !value.empty();
+        }
+        else if (key == "TraceFrames")
+        {
+            result = ParseValue(value, parameters.TraceFrames) && parameters.TraceFrames > 0;
+        }
+        else if (key == "TraceOnExit")
+        {
+            result = ParseValue(value, parameters.TraceOnExit);
+        }
+        else
+        {
+            errorMessage = "Line " + std::to_string(lineNumber) + ": unknown key \"" + std::string(key) + "\".";
+            return false;
+        }
+
+        if (!result)
+        {
+            errorMessage = "Line " + std::to_string(lineNumber) + ": invalid value for \"" + std::string(key) + "\".";
+            return false;
+        }
+    }
+
+    return true;
+}
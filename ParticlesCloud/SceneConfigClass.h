@@ -0,0 +1,65 @@
+#ifndef _SCENECONFIGCLASS_H_
+#define _SCENECONFIGCLASS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Simulation and presentation parameters that can be tuned without recompiling.
+struct SceneParameters
+{
+    size_t ParticlesNumber = 1000000;
+    float SpawnExtent = 25.5f;
+    std::string ParticlesFile;
+
+    float TimeScale = 1.f / 15.f;
+    float BillboardSize = 0.01f;
+    float WellOrbitRadius = 0.5f;
+    float CameraDrift = 0.01f;
+
+    bool SimulationThread = true;
+    float SimulationRate = 0.0f;
+    size_t InputSubsteps = 4;
+    std::string InputRecordFile;
+    std::string InputPlaybackFile;
+
+    bool FullScreen = true;
+    bool VSyncEnabled = false;
+
+    std::string TraceFile = "profile_trace.json";
+    size_t TraceFrames = 120;
+    bool TraceOnExit = false;
+};
+
+// Reads "Key = Value" scene files and watches them for modifications.
+class SceneConfigClass
+{
+public:
+    SceneConfigClass();
+
+    bool Initialize(std::string_view filename);
+    void Frame();
+
+    bool HasChanged() const noexcept;
+    const SceneParameters& GetParameters() const noexcept;
+    SceneParameters& GetParameters() noexcept;
+    const std::string& GetErrorMessage() const noexcept;
+
+    static bool Parse(std::string_view text, SceneParameters& parameters, std::string& errorMessage);
+
+private:
+    bool Reload();
+
+private:
+    std::string m_filename;
+    std::filesystem::file_time_type m_lastWriteTime;
+    uint64_t m_lastCheckTime;
+
+    SceneParameters m_parameters;
+    std::string m_errorMessage;
+    bool m_changed;
+};
+
+#endif
@@ -0,0 +1,334 @@
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_set>
+
+#include "MappedFile.h"
+#include "Platform.h"
+
+namespace
+{
+    // 64-bit FNV-1a over every field of the key. Strings are hashed with their size first, so
+    // moving bytes from one field to the next changes the key.
+    class KeyHasher
+    {
+    public:
+        void Add(std::span<const std::byte> data) noexcept
+        {
+            Add(static_cast<uint64_t>(data.size()));
+            for (const auto value : data)
+            {
+                m_hash = (m_hash ^ std::to_integer<uint64_t>(value)) * s_Prime;
+            }
+        }
+
+        void Add(std::string_view text) noexcept
+        {
+            Add(std::as_bytes(std::span(text.data(), text.size())));
+        }
+
+        void Add(uint64_t value) noexcept
+        {
+            for (size_t i = 0; i < sizeof(value); ++i)
+            {
+                m_hash = (m_hash ^ ((value >> (8 * i)) & 0xff)) * s_Prime;
+            }
+        }
+
+        uint64_t GetHash() const noexcept
+        {
+            return m_hash;
+        }
+
+    private:
+        static constexpr uint64_t s_OffsetBasis = 14695981039346656037ull;
+        static constexpr uint64_t s_Prime = 1099511628211ull;
+
+        uint64_t m_hash = s_OffsetBasis;
+    };
+
+    // Names of the files a source includes, in order. A plain scan of the #include lines, one
+    // inside a comment or a disabled #if block is found as well, which only costs a key that
+    // changes more often than it has to.
+    std::vector<std::string_view> FindIncludes(std::span<const std::byte> source)
+    {
+        std::vector<std::string_view> includes;
+        const std::string_view text{ reinterpret_cast<const char*>(source.data()), source.size() };
+        constexpr std::string_view whitespace = " \t";
+
+        for (size_t begin = 0; begin < text.size();)
+        {
+            auto end = text.find('\n', begin);
+            if (end == std::string_view::npos)
+            {
+                end = text.size();
+            }
+
+            auto line = text.substr(begin, end - begin);
+            begin = end + 1;
+
+            line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
+            if (!line.starts_with('#'))
+            {
+                continue;
+            }
+
+            line.remove_prefix(1);
+            line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
+            if (!line.starts_with("include"))
+            {
+                continue;
+            }
+
+            line.remove_prefix(std::string_view("include").size());
+            line.remove_prefix(std::min(line.find_first_not_of(whitespace), line.size()));
+            if (line.empty() || (line.front() != '"' && line.front() != '<'))
+            {
+                continue;
+            }
+
+            const char close = line.front() == '"' ? '"' : '>';
+            const auto last = line.find(close, 1);
+            if (last != std::string_view::npos)
+            {
+                includes.push_back(line.substr(1, last - 1));
+            }
+        }
+
+        return includes;
+    }
+
+    void AddIncludes(
+        KeyHasher& hasher,
+        const AssetPack& pack,
+        std::string_view filename,
+        std::span<const std::byte> source,
+        std::unordered_set<std::string>& visited)
+    {
+        for (const auto include : FindIncludes(source))
+        {
+            auto name = ShaderCache::ResolveInclude(filename, include);
+            if (!visited.insert(name).second)
+            {
+                continue;
+            }
+
+            // A missing file is hashed as empty, the compiler reports it if it is really used.
+            const auto data = pack.Find(name);
+            hasher.Add(name);
+            hasher.Add(data);
+            AddIncludes(hasher, pack, filename, data, visited);
+        }
+    }
+}
+
+ShaderCache::ShaderCache()
+    : m_pack(nullptr)
+    , m_requests(0)
+    , m_packHits(0)
+    , m_directoryHits(0)
+    , m_compiles(0)
+    , m_failures(0)
+{
+}
+
+ShaderCache::~ShaderCache()
+{
+    Shutdown();
+}
+
+void ShaderCache::Initialize(std::unique_ptr<ShaderCompiler> compiler, const AssetPack& pack, std::string_view directory)
+{
+    m_compiler = std::move(compiler);
+    m_pack = &pack;
+    m_directory = directory;
+
+    m_requests = 0;
+    m_packHits = 0;
+    m_directoryHits = 0;
+    m_compiles = 0;
+    m_failures = 0;
+}
+
+void ShaderCache::Shutdown()
+{
+    m_compiler.reset();
+    m_pack = nullptr;
+    m_directory.clear();
+}
+
+bool ShaderCache::GetBytecode(const ShaderDesc& desc, std::vector<std::byte>& bytecode, std::string& errors)
+{
+    errors.clear();
+    ++m_requests;
+
+    if (!m_pack || !m_compiler)
+    {
+        errors = "The shader cache is not initialized.";
+        ++m_failures;
+        return false;
+    }
+
+    const auto source = m_pack->Find(desc.Filename);
+    if (source.empty())
+    {
+        ++m_failures;
+        return false;
+    }
+
+    const auto key = ComputeKey(desc, source);
+    const auto entryName = GetEntryName(key);
+
+    // A prebuilt entry shipped in the pack.
+    if (ReadEntry(m_pack->Find(std::string(s_PackDirectory) + "/" + entryName), key, bytecode))
+    {
+        ++m_packHits;
+        return true;
+    }
+
+    // An entry an earlier launch compiled.
+    if (!m_directory.empty())
+    {
+        MappedFile file;
+        if (file.Open(m_directory + "/" + entryName) && ReadEntry({ file.GetData(), file.GetSize() }, key, bytecode))
+        {
+            ++m_directoryHits;
+            return true;
+        }
+    }
+
+    if (!m_compiler->Compile(desc, source, *m_pack, bytecode, errors))
+    {
+        if (errors.empty())
+        {
+            errors = "Could not compile " + std::string(desc.Filename) + ".";
+        }
+
+        ++m_failures;
+        return false;
+    }
+
+    ++m_compiles;
+
+    // The bytecode is valid either way, a cache that cannot be written only compiles again.
+    if (!m_directory.empty())
+    {
+        WriteEntry(key, bytecode);
+    }
+
+    return true;
+}
+
+uint64_t ShaderCache::ComputeKey(const ShaderDesc& desc, std::span<const std::byte> source) const
+{
+    KeyHasher hasher;
+    std::unordered_set<std::string> visited;
+
+    hasher.Add(m_compiler ? m_compiler->GetIdentity() : std::string_view{});
+    hasher.Add(AssetPack::NormalizeName(desc.Filename));
+    hasher.Add(desc.EntryPoint);
+    hasher.Add(desc.Target);
+    hasher.Add(uint64_t{ desc.Flags });
+    hasher.Add(source);
+
+    if (m_pack)
+    {
+        AddIncludes(hasher, *m_pack, desc.Filename, source, visited);
+    }
+
+    return hasher.GetHash();
+}
+
+ShaderCache::CacheStats ShaderCache::GetStats() const noexcept
+{
+    CacheStats stats;
+
+    stats.Requests = m_requests;
+    stats.PackHits = m_packHits;
+    stats.DirectoryHits = m_directoryHits;
+    stats.Compiles = m_compiles;
+    stats.Failures = m_failures;
+
+    return stats;
+}
+
+std::string ShaderCache::ResolveInclude(std::string_view filename, std::string_view include)
+{
+    const auto directory = std::filesystem::path(AssetPack::NormalizeName(filename)).parent_path();
+    return AssetPack::NormalizeName((directory / std::filesystem::path(include)).generic_string());
+}
+
+std::string ShaderCache::GetEntryName(uint64_t key)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(key));
+
+    return name + std::string(s_Extension);
+}
+
+bool ShaderCache::ReadEntry(std::span<const std::byte> data, uint64_t key, std::vector<std::byte>& bytecode)
+{
+    ShaderEntryHeader header;
+
+    if (data.size() < sizeof(ShaderEntryHeader))
+    {
+        return false;
+    }
+
+    std::memcpy(&header, data.data(), sizeof(ShaderEntryHeader));
+
+    // The key in the header guards against a renamed file, the size against a truncated one.
+    if (std::memcmp(header.Magic, s_Magic, sizeof(s_Magic)) != 0 || header.Version != s_Version || header.Key != key ||
+        header.BytecodeSize == 0 || header.BytecodeSize != data.size() - sizeof(ShaderEntryHeader))
+    {
+        return false;
+    }
+
+    const auto payload = data.subspan(sizeof(ShaderEntryHeader));
+    bytecode.assign(payload.begin(), payload.end());
+
+    return true;
+}
+
+bool ShaderCache::WriteEntry(uint64_t key, std::span<const std::byte> bytecode) const
+{
+    ShaderEntryHeader header{};
+    std::error_code error;
+
+    std::memcpy(header.Magic, s_Magic, sizeof(s_Magic));
+    header.Version = s_Version;
+    header.Key = key;
+    header.BytecodeSize = bytecode.size();
+
+    std::filesystem::create_directories(m_directory, error);
+
+    // Write a file of our own and rename it into place, so a reader on another thread or in
+    // another process never maps a half written entry.
+    const auto filename = m_directory + "/" + GetEntryName(key);
+    const auto temporary = filename + "." + std::to_string(Platform::GetCurrentThreadId()) + ".tmp";
+
+    {
+        std::ofstream fout{ temporary, std::ios::binary };
+        fout.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        fout.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+        if (fout.fail())
+        {
+            fout.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, filename, error);
+    if (error)
+    {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
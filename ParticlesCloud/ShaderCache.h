@@ -0,0 +1,154 @@
+#ifndef _SHADERCACHE_H_
+#define _SHADERCACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetPack.h"
+
+// One shader to compile: its source file in the asset pack, the entry point, the profile like
+// "vs_5_0" and the compiler flags.
+struct ShaderDesc
+{
+    std::string_view Filename;
+    std::string_view EntryPoint;
+    std::string_view Target;
+    uint32_t Flags = 0;
+};
+
+// Turns shader source into bytecode. The cache only calls it on a miss, so a stub can stand in
+// for the real compiler. Compile may run on several threads at once.
+class ShaderCompiler
+{
+public:
+    virtual ~ShaderCompiler() = default;
+
+    //--------------------------------------------------------------------------------------
+    // Name and version of the compiler, part of every cache key so bytecode of another
+    // compiler is never reused.
+    //--------------------------------------------------------------------------------------
+    virtual std::string_view GetIdentity() const noexcept = 0;
+
+    //--------------------------------------------------------------------------------------
+    // Compile the source, files it includes are looked up in the pack through
+    // ShaderCache::ResolveInclude. Fills the errors when it fails.
+    //--------------------------------------------------------------------------------------
+    virtual bool Compile(
+        const ShaderDesc& desc,
+        std::span<const std::byte> source,
+        const AssetPack& pack,
+        std::vector<std::byte>& bytecode,
+        std::string& errors) = 0;
+};
+
+#ifdef _WIN32
+//--------------------------------------------------------------------------------------
+// The D3DCompile compiler of d3dcompiler_47.dll.
+//--------------------------------------------------------------------------------------
+class D3DShaderCompiler final : public ShaderCompiler
+{
+public:
+    std::string_view GetIdentity() const noexcept override;
+    bool Compile(
+        const ShaderDesc& desc,
+        std::span<const std::byte> source,
+        const AssetPack& pack,
+        std::vector<std::byte>& bytecode,
+        std::string& errors) override;
+};
+#endif
+
+// Compiled shaders stored by a hash of everything that decides the bytecode: the compiler
+// identity, the source and every file it includes, the entry point, the profile and the flags.
+// A changed shader gets a new key, so entries are never invalidated, only left behind.
+//
+// Entries are looked up first in the asset pack, under shadercache/, where a prebuilt cache
+// ships, then in the cache directory. Only a miss in both compiles, and the bytecode is then
+// written to the cache directory for the next launch.
+//
+// Entry file layout (little endian), named by the key in hexadecimal with a .cso extension:
+//   ShaderEntryHeader
+//   uint8_t[BytecodeSize]   bytecode as returned by the compiler
+class ShaderCache
+{
+public:
+    static constexpr char s_Magic[4] = { 'P', 'C', 'S', 'C' };
+    static constexpr uint32_t s_Version = 1;
+    static constexpr std::string_view s_PackDirectory = "shadercache";
+    static constexpr std::string_view s_Extension = ".cso";
+
+    struct ShaderEntryHeader
+    {
+        char Magic[4];
+        uint32_t Version;
+        uint64_t Key;
+        uint64_t BytecodeSize;
+    };
+
+    struct CacheStats
+    {
+        uint64_t Requests = 0;
+        uint64_t PackHits = 0;
+        uint64_t DirectoryHits = 0;
+        uint64_t Compiles = 0;
+        uint64_t Failures = 0;
+    };
+
+public:
+    ShaderCache();
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+    ~ShaderCache();
+
+    //--------------------------------------------------------------------------------------
+    // Read sources and prebuilt entries from the pack, which has to outlive the cache, and
+    // store compiled entries in the directory. An empty directory only reads the pack.
+    //--------------------------------------------------------------------------------------
+    void Initialize(std::unique_ptr<ShaderCompiler> compiler, const AssetPack& pack, std::string_view directory);
+    void Shutdown();
+
+    //--------------------------------------------------------------------------------------
+    // Bytecode of the shader from the cache, compiled on a miss. The errors stay empty when
+    // the pack has no such source file. Safe to call from several threads.
+    //--------------------------------------------------------------------------------------
+    bool GetBytecode(const ShaderDesc& desc, std::vector<std::byte>& bytecode, std::string& errors);
+
+    //--------------------------------------------------------------------------------------
+    // Key of the shader with the given source. An included file missing from the pack is
+    // hashed as empty.
+    //--------------------------------------------------------------------------------------
+    uint64_t ComputeKey(const ShaderDesc& desc, std::span<const std::byte> source) const;
+
+    CacheStats GetStats() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Name of an included file in the pack. Includes are relative to the directory of the
+    // shader that is compiled.
+    //--------------------------------------------------------------------------------------
+    static std::string ResolveInclude(std::string_view filename, std::string_view include);
+
+    static std::string GetEntryName(uint64_t key);
+
+private:
+    static bool ReadEntry(std::span<const std::byte> data, uint64_t key, std::vector<std::byte>& bytecode);
+    bool WriteEntry(uint64_t key, std::span<const std::byte> bytecode) const;
+
+private:
+    std::unique_ptr<ShaderCompiler> m_compiler;
+    const AssetPack* m_pack;
+    std::string m_directory;
+
+    std::atomic<uint64_t> m_requests;
+    std::atomic<uint64_t> m_packHits;
+    std::atomic<uint64_t> m_directoryHits;
+    std::atomic<uint64_t> m_compiles;
+    std::atomic<uint64_t> m_failures;
+};
+
+#endif
@@ -0,0 +1,110 @@
+#ifdef _WIN32
+
+#include "ShaderCache.h"
+
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <d3dcompiler.h>
+
+#define SHADERCACHE_STRINGIFY(value) #value
+#define SHADERCACHE_COMPILER_NAME(version) "d3dcompiler_" SHADERCACHE_STRINGIFY(version)
+
+namespace
+{
+    constexpr std::string_view s_CompilerIdentity = SHADERCACHE_COMPILER_NAME(D3D_COMPILER_VERSION);
+
+    // Serves #include from the pack, the data stays mapped so Close has nothing to free.
+    class PackInclude final : public ID3DInclude
+    {
+    public:
+        PackInclude(const AssetPack& pack, std::string_view filename)
+            : m_pack(pack)
+            , m_filename(filename)
+        {
+        }
+
+        HRESULT __stdcall Open(D3D_INCLUDE_TYPE, LPCSTR pFileName, LPCVOID, LPCVOID* ppData, UINT* pBytes) override
+        {
+            const auto data = m_pack.Find(ShaderCache::ResolveInclude(m_filename, pFileName));
+            if (data.empty())
+            {
+                return HRESULT_FROM_WIN32(ERROR_FILE_NOT_FOUND);
+            }
+
+            *ppData = data.data();
+            *pBytes = static_cast<UINT>(data.size());
+
+            return S_OK;
+        }
+
+        HRESULT __stdcall Close(LPCVOID) override
+        {
+            return S_OK;
+        }
+
+    private:
+        const AssetPack& m_pack;
+        std::string_view m_filename;
+    };
+}
+
+std::string_view D3DShaderCompiler::GetIdentity() const noexcept
+{
+    return s_CompilerIdentity;
+}
+
+bool D3DShaderCompiler::Compile(
+    const ShaderDesc& desc,
+    std::span<const std::byte> source,
+    const AssetPack& pack,
+    std::vector<std::byte>& bytecode,
+    std::string& errors)
+{
+    const std::string filename(desc.Filename);
+    const std::string entryPoint(desc.EntryPoint);
+    const std::string target(desc.Target);
+    PackInclude include{ pack, desc.Filename };
+    ID3DBlob* code = nullptr;
+    ID3DBlob* errorMessages = nullptr;
+
+    const HRESULT result = D3DCompile(
+        source.data(),
+        source.size(),
+        filename.c_str(),
+        nullptr,
+        &include,
+        entryPoint.c_str(),
+        target.c_str(),
+        desc.Flags,
+        0,
+        &code,
+        &errorMessages);
+
+    if (errorMessages)
+    {
+        errors.assign(static_cast<const char*>(errorMessages->GetBufferPointer()), errorMessages->GetBufferSize());
+        errorMessages->Release();
+    }
+
+    if (FAILED(result) || !code)
+    {
+        if (code)
+        {
+            code->Release();
+        }
+
+        return false;
+    }
+
+    const auto* data = static_cast<const std::byte*>(code->GetBufferPointer());
+    bytecode.assign(data, data + code->GetBufferSize());
+    code->Release();
+
+    // Warnings of a successful compile are not errors.
+    errors.clear();
+
+    return true;
+}
+
+#endif
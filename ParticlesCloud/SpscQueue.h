@@ -0,0 +1,69 @@
+#ifndef _SPSCQUEUE_H_
+#define _SPSCQUEUE_H_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue between exactly one producer and one consumer thread. The producer only
+// writes m_tail and the consumer only m_head, each on its own cache line, so neither side ever
+// blocks the other. Capacity must be a power of two.
+template<typename T, size_t Capacity>
+class SpscQueue
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two.");
+
+public:
+    SpscQueue()
+        : m_head(0)
+        , m_tail(0)
+        , m_items{}
+    {
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    //--------------------------------------------------------------------------------------
+    // Producer side. Returns false and drops the value when the queue is full.
+    //--------------------------------------------------------------------------------------
+    bool Push(const T& value) noexcept
+    {
+        const size_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head.load(std::memory_order_acquire) == Capacity)
+        {
+            return false;
+        }
+
+        m_items[tail & (Capacity - 1)] = value;
+        m_tail.store(tail + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------
+    // Consumer side. Returns false when the queue is empty.
+    //--------------------------------------------------------------------------------------
+    bool Pop(T& value) noexcept
+    {
+        const size_t head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+
+        value = m_items[head & (Capacity - 1)];
+        m_head.store(head + 1, std::memory_order_release);
+
+        return true;
+    }
+
+private:
+    static constexpr size_t s_CacheLineSize = 64;
+
+    alignas(s_CacheLineSize) std::atomic<size_t> m_head;
+    alignas(s_CacheLineSize) std::atomic<size_t> m_tail;
+    alignas(s_CacheLineSize) std::array<T, Capacity> m_items;
+};
+
+#endif
@@ -0,0 +1,239 @@
+#include "StartupGraph.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "Clock.h"
+#include "Profiler.h"
+
+namespace
+{
+    double ToMilliseconds(uint64_t nanoseconds) noexcept
+    {
+        return static_cast<double>(nanoseconds) / static_cast<double>(Clock::s_NanosecondsPerMillisecond);
+    }
+}
+
+StartupGraph::StartupGraph()
+    : m_failedTask(nullptr)
+    , m_wallTime(0)
+{
+}
+
+StartupGraph::TaskId StartupGraph::AddTask(
+    const char* name,
+    TaskFunction function,
+    std::initializer_list<TaskId> dependencies,
+    Affinity affinity)
+{
+    const TaskId id = m_tasks.size();
+
+    auto& task = m_tasks.emplace_back();
+    task.Function = std::move(function);
+    task.TaskAffinity = affinity;
+
+    for (const auto dependency : dependencies)
+    {
+        if (dependency < id)
+        {
+            m_tasks[dependency].Dependents.push_back(id);
+            ++task.DependencyCount;
+        }
+    }
+
+    auto& timing = m_timings.emplace_back();
+    timing.Name = name;
+
+    return id;
+}
+
+bool StartupGraph::Run(size_t threadCount)
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<TaskId> anyThreadReady;
+    std::deque<TaskId> callingThreadReady;
+    std::vector<size_t> remaining(m_tasks.size());
+    std::vector<std::thread> workers;
+    size_t finished = 0;
+    size_t running = 0;
+    bool failed = false;
+
+    m_failedTask = nullptr;
+    for (auto& timing : m_timings)
+    {
+        timing = TaskTiming{ timing.Name };
+    }
+
+    const uint64_t start = Clock::Now();
+
+    for (TaskId id = 0; id < m_tasks.size(); ++id)
+    {
+        remaining[id] = m_tasks[id].DependencyCount;
+        if (remaining[id] == 0)
+        {
+            (m_tasks[id].TaskAffinity == Affinity::CallingThread ? callingThreadReady : anyThreadReady).push_back(id);
+        }
+    }
+
+    // Runs a step outside the lock, then releases the steps waiting only on it. The timing of a
+    // step is written by the thread that runs it and read once every thread is joined.
+    auto execute = [&](std::unique_lock<std::mutex>& lock, TaskId id, bool callingThread) {
+        auto& timing = m_timings[id];
+
+        ++running;
+        lock.unlock();
+
+        const uint64_t beginTicks = Clock::ReadTicks();
+        timing.Start = Clock::Now() - start;
+        const bool succeeded = m_tasks[id].Function();
+        timing.End = Clock::Now() - start;
+        Profiler::RecordZone(timing.Name, beginTicks, Clock::ReadTicks());
+
+        timing.Finished = true;
+        timing.Succeeded = succeeded;
+        timing.CallingThread = callingThread;
+
+        lock.lock();
+        --running;
+        ++finished;
+
+        if (!succeeded)
+        {
+            if (!failed)
+            {
+                failed = true;
+                m_failedTask = timing.Name;
+            }
+        }
+        else
+        {
+            for (const auto dependent : m_tasks[id].Dependents)
+            {
+                if (--remaining[dependent] == 0)
+                {
+                    auto& ready = m_tasks[dependent].TaskAffinity == Affinity::CallingThread ? callingThreadReady : anyThreadReady;
+                    ready.push_back(dependent);
+                }
+            }
+        }
+
+        changed.notify_all();
+    };
+
+    const auto anyThreadTasks = std::count_if(m_tasks.begin(), m_tasks.end(), [](const Task& task) {
+        return task.TaskAffinity == Affinity::AnyThread;
+    });
+
+    workers.reserve(std::min<size_t>(threadCount, anyThreadTasks));
+    for (size_t i = 0; i < std::min<size_t>(threadCount, anyThreadTasks); ++i)
+    {
+        workers.emplace_back([&]() {
+            Profiler::SetThreadName("Startup");
+
+            std::unique_lock lock{ mutex };
+            for (;;)
+            {
+                changed.wait(lock, [&]() { return failed || finished == m_tasks.size() || !anyThreadReady.empty(); });
+                if (failed || finished == m_tasks.size())
+                {
+                    return;
+                }
+
+                const TaskId id = anyThreadReady.front();
+                anyThreadReady.pop_front();
+                execute(lock, id, false);
+            }
+        });
+    }
+
+    // The calling thread runs its own steps first and helps with the others in between.
+    {
+        std::unique_lock lock{ mutex };
+        for (;;)
+        {
+            changed.wait(lock, [&]() {
+                return finished == m_tasks.size() || (failed && running == 0) ||
+                       (!failed && (!callingThreadReady.empty() || !anyThreadReady.empty()));
+            });
+            if (finished == m_tasks.size() || failed)
+            {
+                break;
+            }
+
+            auto& ready = callingThreadReady.empty() ? anyThreadReady : callingThreadReady;
+            const TaskId id = ready.front();
+            ready.pop_front();
+            execute(lock, id, true);
+        }
+    }
+
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+
+    m_wallTime = Clock::Now() - start;
+
+    return !failed;
+}
+
+const char* StartupGraph::GetFailedTask() const noexcept
+{
+    return m_failedTask;
+}
+
+const std::vector<StartupGraph::TaskTiming>& StartupGraph::GetTimings() const noexcept
+{
+    return m_timings;
+}
+
+uint64_t StartupGraph::GetWallTime() const noexcept
+{
+    return m_wallTime;
+}
+
+std::string StartupGraph::FormatReport() const
+{
+    std::string report;
+    char line[128];
+    uint64_t serialTime = 0;
+
+    report += "Startup steps:\n";
+    for (const auto& timing : m_timings)
+    {
+        if (!timing.Finished)
+        {
+            std::snprintf(line, sizeof(line), "  %-24s skipped\n", timing.Name);
+        }
+        else
+        {
+            std::snprintf(
+                line,
+                sizeof(line),
+                "  %-24s at %8.2f ms  took %8.2f ms  on the %s thread%s\n",
+                timing.Name,
+                ToMilliseconds(timing.Start),
+                ToMilliseconds(timing.End - timing.Start),
+                timing.CallingThread ? "calling" : "worker",
+                timing.Succeeded ? "" : ", failed");
+            serialTime += timing.End - timing.Start;
+        }
+
+        report += line;
+    }
+
+    std::snprintf(
+        line,
+        sizeof(line),
+        "Startup took %.2f ms, the steps one after the other %.2f ms.\n",
+        ToMilliseconds(m_wallTime),
+        ToMilliseconds(serialTime));
+    report += line;
+
+    return report;
+}
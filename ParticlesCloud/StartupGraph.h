@@ -0,0 +1,94 @@
+#ifndef _STARTUPGRAPH_H_
+#define _STARTUPGRAPH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+// Initialization steps described as a small dependency graph and run on a pool of threads. A step
+// starts as soon as the steps it depends on finished, so independent ones overlap. Steps that have
+// to stay on the calling thread, like creating the window swap chain, are marked as such and run
+// there in between. Every step is timed for the startup report and recorded as a profiler zone.
+class StartupGraph
+{
+public:
+    using TaskId = size_t;
+    using TaskFunction = std::function<bool()>;
+
+    enum class Affinity
+    {
+        AnyThread,
+        CallingThread
+    };
+
+    struct TaskTiming
+    {
+        const char* Name = nullptr;
+        bool Finished = false;
+        bool Succeeded = false;
+        bool CallingThread = false;
+        // Nanoseconds since Run started.
+        uint64_t Start = 0;
+        uint64_t End = 0;
+    };
+
+public:
+    StartupGraph();
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    //--------------------------------------------------------------------------------------
+    // Add a step that runs once the given steps succeeded. Steps can only depend on steps
+    // added before them, so the graph never has a cycle. The name must outlive the graph,
+    // in practice it is a string literal.
+    //--------------------------------------------------------------------------------------
+    TaskId AddTask(
+        const char* name,
+        TaskFunction function,
+        std::initializer_list<TaskId> dependencies = {},
+        Affinity affinity = Affinity::AnyThread);
+
+    //--------------------------------------------------------------------------------------
+    // Run every step on up to threadCount worker threads and the calling thread, which takes
+    // its own steps first and any other ready step in between. After a step fails no new
+    // step starts, the running ones finish and Run returns false.
+    //--------------------------------------------------------------------------------------
+    bool Run(size_t threadCount);
+
+    //--------------------------------------------------------------------------------------
+    // Name of the step that failed the last Run, null when it succeeded.
+    //--------------------------------------------------------------------------------------
+    const char* GetFailedTask() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Timings of the last Run in the order the steps were added, and its wall time.
+    //--------------------------------------------------------------------------------------
+    const std::vector<TaskTiming>& GetTimings() const noexcept;
+    uint64_t GetWallTime() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // One line per step with its start, duration and thread, then the wall time against the
+    // time the steps would have taken one after the other.
+    //--------------------------------------------------------------------------------------
+    std::string FormatReport() const;
+
+private:
+    struct Task
+    {
+        TaskFunction Function;
+        std::vector<TaskId> Dependents;
+        size_t DependencyCount = 0;
+        Affinity TaskAffinity = Affinity::AnyThread;
+    };
+
+private:
+    std::vector<Task> m_tasks;
+    std::vector<TaskTiming> m_timings;
+    const char* m_failedTask;
+    uint64_t m_wallTime;
+};
+
+#endif
@@ -1,6 +1,31 @@
 #include "SystemClass.h"
 
-bool SystemClass::Initialize()
+namespace
+{
+    // The command line as WinMain gets it. Explorer passes the path of a dropped or opened file in
+    // quotes when it contains spaces, and may leave whitespace around it.
+    std::string_view GetCommandLinePath(std::string_view commandLine) noexcept
+    {
+        constexpr std::string_view whitespace = " \t\r\n";
+
+        const size_t first = commandLine.find_first_not_of(whitespace);
+        if (first == std::string_view::npos)
+        {
+            return {};
+        }
+        commandLine = commandLine.substr(first, commandLine.find_last_not_of(whitespace) - first + 1);
+
+        if (commandLine.front() == '"')
+        {
+            commandLine.remove_prefix(1);
+            return commandLine.substr(0, commandLine.find('"'));
+        }
+
+        return commandLine;
+    }
+}
+
+bool SystemClass::Initialize(std::string_view particlesFilename)
 {
     int screenWidth, screenHeight;
     bool result;
@@ -10,6 +35,37 @@ bool SystemClass::Initialize()
     screenWidth = 0;
     screenHeight = 0;
 
+    // Name the main thread in the profiler traces and measure the tick rate of the profiler zones
+    // now rather than when the first trace is exported.
+    Profiler::SetThreadName("Main");
+    Clock::Calibrate();
+    m_traceKeyDown = false;
+
+    // Create the scene config object. It is read before the window is created since it decides
+    // between full screen and windowed mode.
+    m_Config = std::make_unique<SceneConfigClass>();
+    if (!m_Config)
+    {
+        return false;
+    }
+
+    // Initialize the scene config object.
+    result = m_Config->Initialize("./assets/scene.cfg");
+    if (!result)
+    {
+        MessageBoxA(nullptr, m_Config->GetErrorMessage().c_str(), "Could not read the scene file", MB_OK);
+        return false;
+    }
+
+    // A particles file given on the command line takes precedence over the scene file.
+    m_particlesFilename = GetCommandLinePath(particlesFilename);
+    if (!m_particlesFilename.empty())
+    {
+        m_Config->GetParameters().ParticlesFile = m_particlesFilename;
+    }
+
+    m_fullScreen = m_Config->GetParameters().FullScreen;
+
     // Initialize the windows api.
     InitializeWindows(screenWidth, screenHeight);
 
@@ -38,7 +94,7 @@ bool SystemClass::Initialize()
     }
 
     // Initialize the graphics object.
-    result = m_Graphics->Initialize(screenWidth, screenHeight, m_hwnd);
+    result = m_Graphics->Initialize(screenWidth, screenHeight, m_hwnd, m_Config->GetParameters());
     if (!result)
     {
         return false;
@@ -64,6 +120,57 @@ bool SystemClass::Initialize()
     // Initialize the cpu object.
     m_Cpu->Initialize();
 
+    // Create the memory object.
+    m_Memory = std::make_unique<MemoryClass>();
+    if (!m_Memory)
+    {
+        return false;
+    }
+
+    // Initialize the memory object.
+    m_Memory->Initialize();
+
+    // Create the input latency object.
+    m_InputLatency = std::make_unique<InputLatencyClass>();
+    if (!m_InputLatency)
+    {
+        return false;
+    }
+
+    // Initialize the input latency object.
+    m_InputLatency->Initialize();
+
+    // Create the input recorder object when the session is recorded. The file is only read at
+    // startup like FullScreen.
+    m_inputRecordFilename = m_Config->GetParameters().InputRecordFile;
+    if (!m_inputRecordFilename.empty())
+    {
+        m_InputRecorder = std::make_unique<InputRecording>();
+        if (!m_InputRecorder)
+        {
+            return false;
+        }
+
+        m_InputRecorder->BeginRecording(screenWidth, screenHeight);
+    }
+
+    // Load the recorded session to play back instead of the live input.
+    if (!m_Config->GetParameters().InputPlaybackFile.empty())
+    {
+        m_InputPlayback = std::make_unique<InputRecording>();
+        if (!m_InputPlayback)
+        {
+            return false;
+        }
+
+        result = m_InputPlayback->Load(m_Config->GetParameters().InputPlaybackFile);
+        if (!result)
+        {
+            MessageBoxA(m_hwnd, m_InputPlayback->GetErrorMessage().c_str(), "Could not load the input recording", MB_OK);
+            return false;
+        }
+    }
+
     // Create the timer object.
     m_Timer = std::make_unique<TimerClass>();
     if (!m_Timer)
@@ -84,6 +191,18 @@ bool SystemClass::Initialize()
 
 void SystemClass::Shutdown()
 {
+    // Write the profiler trace of the last frames if the scene asks for it.
+    if (m_Config && m_Config->GetParameters().TraceOnExit)
+    {
+        ExportTrace();
+    }
+
+    // Write the recorded session.
+    if (m_InputRecorder)
+    {
+        SaveInputRecording();
+    }
+
     // Release the graphics object.
     if (m_Graphics)
     {
@@ -103,7 +222,12 @@ void SystemClass::Shutdown()
 
     m_Fps.reset();
     m_Cpu.reset();
+    m_Memory.reset();
+    m_InputLatency.reset();
+    m_InputRecorder.reset();
+    m_InputPlayback.reset();
     m_Timer.reset();
+    m_Config.reset();
 
     return;
 }
@@ -155,33 +279,160 @@ void SystemClass::Run()
 bool SystemClass::Frame()
 {
     bool result;
-    int mouseX, mouseY;
+    uint64_t frameNanoseconds;
+
+    Profiler::BeginFrame();
+    PROFILE_ZONE("Frame");
 
     // Update the system stats.
-    m_Timer->Frame();
-    m_Fps->Frame();
-    m_Cpu->Frame();
+    {
+        PROFILE_ZONE("Timer");
+        m_Timer->Frame();
+    }
+    {
+        PROFILE_ZONE("Fps");
+        m_Fps->Frame();
+    }
+    {
+        PROFILE_ZONE("Cpu");
+        m_Cpu->Frame();
+    }
+    {
+        PROFILE_ZONE("Memory");
+        m_Memory->Frame();
+    }
+
+    // Apply the scene file if it was edited since the previous frame.
+    {
+        PROFILE_ZONE("Config");
+        m_Config->Frame();
+    }
+    if (m_Config->HasChanged())
+    {
+        PROFILE_ZONE("ApplyParameters");
+
+        if (!m_particlesFilename.empty())
+        {
+            m_Config->GetParameters().ParticlesFile = m_particlesFilename;
+        }
+
+        result = m_Graphics->ApplyParameters(m_Config->GetParameters());
+        if (!result)
+        {
+            return false;
+        }
+    }
+
+    // Take the frame time and the input either from the recorded session or from the timer and
+    // the devices. The application ends with the last recorded frame.
+    frameNanoseconds = m_Timer->GetFrameNanoseconds();
+    {
+        PROFILE_ZONE("Input");
 
-	// Do the input frame processing.
-    result = m_Input->Frame();
+        const uint64_t inputTime = Clock::Now();
+
+        if (m_InputPlayback)
+        {
+            if (!m_InputPlayback->PlayFrame(inputTime, frameNanoseconds, m_playbackEvents))
+            {
+                return false;
+            }
+
+            result = m_Input->Frame(m_playbackEvents);
+        }
+        else
+        {
+            result = m_Input->Frame();
+        }
+
+        if (result && m_InputRecorder)
+        {
+            m_InputRecorder->RecordFrame(frameNanoseconds, inputTime, m_Input->GetFrameEvents());
+        }
+    }
     if (!result)
     {
         return false;
     }
 
-    // Get the location of the mouse from the input object,
-    m_Input->GetMouseLocation(mouseX, mouseY);
-
-    // Do the frame processing for the graphics object.
-    result = m_Graphics->Frame(m_Fps->GetFps(), m_Cpu->GetCpuPercentage(), m_Timer->GetTime(), mouseX, mouseY);
+    // Write the profiler trace when F12 goes down.
+    const bool traceKeyDown = m_Input->IsF12Pressed();
+    if (traceKeyDown && !m_traceKeyDown)
+    {
+        ExportTrace();
+    }
+    m_traceKeyDown = traceKeyDown;
+
+    // Do the frame processing for the graphics object with the path the cursor took since the
+    // previous frame.
+    result = m_Graphics->Frame(
+        m_Fps->GetFrameStats(),
+        m_Cpu->GetSnapshot(),
+        m_Memory->GetMemoryStats(),
+        m_InputLatency->GetStats(),
+        Clock::ToMilliseconds(frameNanoseconds),
+        m_Input->GetCursorPath());
     if (!result)
     {
         return false;
     }
 
+    // Account the input events the presented frame reflects.
+    m_InputLatency->Frame(m_Input->GetCursorPath(), m_Graphics->GetPresentedInputTime());
+
     return true;
 }
 
+const FrameStats& SystemClass::GetFrameStats() const noexcept
+{
+    return m_Fps->GetFrameStats();
+}
+
+std::vector<FramePeak> SystemClass::GetLongestFrameTimeline() const
+{
+    return m_Fps->GetLongestFrameTimeline();
+}
+
+const CpuSnapshot& SystemClass::GetCpuSnapshot() const noexcept
+{
+    return m_Cpu->GetSnapshot();
+}
+
+const MemoryStats& SystemClass::GetMemoryStats() const noexcept
+{
+    return m_Memory->GetMemoryStats();
+}
+
+const InputLatencyStats& SystemClass::GetInputLatency() const noexcept
+{
+    return m_InputLatency->GetStats();
+}
+
+const ParticlesSimulation::CloudStats& SystemClass::GetCloudStats() const noexcept
+{
+    return m_Graphics->GetCloudStats();
+}
+
+void SystemClass::ExportTrace()
+{
+    const auto& parameters = m_Config->GetParameters();
+
+    // A failed export must not stop the application, report it to the debugger only.
+    if (!Profiler::ExportChromeTrace(parameters.TraceFile, static_cast<uint32_t>(parameters.TraceFrames)))
+    {
+        OutputDebugStringA(("Could not write the profiler trace to " + parameters.TraceFile + "\n").c_str());
+    }
+}
+
+void SystemClass::SaveInputRecording()
+{
+    // Like the trace export, a failed write is only reported to the debugger.
+    if (!m_InputRecorder->Save(m_inputRecordFilename))
+    {
+        OutputDebugStringA((m_InputRecorder->GetErrorMessage() + " " + m_inputRecordFilename + "\n").c_str());
+    }
+}
+
 LRESULT CALLBACK SystemClass::MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam, LPARAM lparam)
 {
     return DefWindowProc(hwnd, umsg, wparam, lparam);
@@ -225,7 +476,7 @@ void SystemClass::InitializeWindows(int& screenWidth, int& screenHeight)
 
     // Setup the screen settings depending on whether it is running in full screen
     // or in windowed mode.
-    if (FULL_SCREEN)
+    if (m_fullScreen)
     {
         // If full screen set the screen to maximum size of the users desktop and
         // 32bit.
@@ -285,7 +536,7 @@ void SystemClass::ShutdownWindows()
     ShowCursor(true);
 
     // Fix the display settings if leaving full screen mode.
-    if (FULL_SCREEN)
+    if (m_fullScreen)
     {
         ChangeDisplaySettings(NULL, 0);
     }
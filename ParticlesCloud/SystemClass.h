@@ -7,26 +7,44 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 #include <windows.h>
 
+#include "Clock.h"
 #include "CpuClass.h"
 #include "FpsClass.h"
 #include "GraphicsClass.h"
 #include "InputClass.h"
+#include "InputLatencyClass.h"
+#include "InputRecording.h"
+#include "MemoryClass.h"
+#include "Profiler.h"
+#include "SceneConfigClass.h"
 #include "TimerClass.h"
 
 class SystemClass
 {
 public:
-    bool Initialize();
+    bool Initialize(std::string_view particlesFilename);
     void Shutdown();
     void Run();
 
+    const FrameStats& GetFrameStats() const noexcept;
+    std::vector<FramePeak> GetLongestFrameTimeline() const;
+    const CpuSnapshot& GetCpuSnapshot() const noexcept;
+    const MemoryStats& GetMemoryStats() const noexcept;
+    const InputLatencyStats& GetInputLatency() const noexcept;
+    const ParticlesSimulation::CloudStats& GetCloudStats() const noexcept;
+
     LRESULT CALLBACK MessageHandler(HWND hwnd, UINT umsg, WPARAM wparam, LPARAM lparam);
 
 private:
     bool Frame();
+    void ExportTrace();
+    void SaveInputRecording();
     void InitializeWindows(int& screenWidth, int& screenHeight);
     void ShutdownWindows();
 
@@ -39,7 +57,17 @@ private:
     std::unique_ptr<GraphicsClass> m_Graphics;
     std::unique_ptr<FpsClass> m_Fps;
     std::unique_ptr<CpuClass> m_Cpu;
+    std::unique_ptr<MemoryClass> m_Memory;
+    std::unique_ptr<InputLatencyClass> m_InputLatency;
+    std::unique_ptr<InputRecording> m_InputRecorder;
+    std::unique_ptr<InputRecording> m_InputPlayback;
+    std::vector<InputEvent> m_playbackEvents;
     std::unique_ptr<TimerClass> m_Timer;
+    std::unique_ptr<SceneConfigClass> m_Config;
+    std::string m_particlesFilename;
+    std::string m_inputRecordFilename;
+    bool m_fullScreen;
+    bool m_traceKeyDown;
 };
 
 /////////////////////////
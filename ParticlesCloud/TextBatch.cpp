@@ -0,0 +1,135 @@
+#include "TextBatch.h"
+
+#include <algorithm>
+#include <utility>
+
+TextBatch::TextBatch()
+    : m_layout(nullptr)
+    , m_screenWidth(0)
+    , m_screenHeight(0)
+    , m_scale(1.0f)
+    , m_dirty(false)
+{
+}
+
+void TextBatch::Initialize(const FontLayout& layout, int screenWidth, int screenHeight, float scale)
+{
+    m_layout = &layout;
+    m_screenWidth = screenWidth;
+    m_screenHeight = screenHeight;
+    m_scale = scale;
+    m_lines.clear();
+    m_vertices.clear();
+    m_indices.clear();
+    m_dirty = true;
+}
+
+size_t TextBatch::AddLine(int maxLength, int positionX, int positionY)
+{
+    LineType line;
+
+    // Reserve the text up front so setting a new one never allocates.
+    line.text.reserve(static_cast<size_t>(maxLength));
+    line.firstVertex = m_vertices.size();
+    line.maxLength = static_cast<size_t>(maxLength);
+
+    // Calculate the X and Y pixel position on the screen to start drawing to.
+    line.drawX = static_cast<float>(((m_screenWidth / 2) * -1) + positionX);
+    line.drawY = static_cast<float>((m_screenHeight / 2) - positionY);
+
+    line.red = 1.0f;
+    line.green = 1.0f;
+    line.blue = 1.0f;
+    line.dirty = false;
+
+    // A quad per letter, zeroed vertices draw nothing until the line gets a text.
+    const size_t firstIndex = m_indices.size();
+    m_vertices.resize(m_vertices.size() + FontLayout::s_VerticesPerQuad * line.maxLength, VertexType{});
+    m_indices.resize(firstIndex + FontLayout::s_IndicesPerQuad * line.maxLength);
+    FontLayout::BuildQuadIndices(m_indices.data() + firstIndex, line.maxLength, static_cast<uint32_t>(line.firstVertex));
+    m_lines.push_back(std::move(line));
+    m_dirty = true;
+
+    return m_lines.size() - 1;
+}
+
+bool TextBatch::SetLine(size_t index, std::string_view text, float red, float green, float blue)
+{
+    auto& line = m_lines[index];
+
+    // Check for possible buffer overflow.
+    if (text.length() > line.maxLength)
+    {
+        return false;
+    }
+
+    if (text == line.text && red == line.red && green == line.green && blue == line.blue)
+    {
+        return true;
+    }
+
+    line.text.assign(text);
+    line.red = red;
+    line.green = green;
+    line.blue = blue;
+    line.dirty = true;
+
+    return true;
+}
+
+bool TextBatch::Update() noexcept
+{
+    bool changed = m_dirty;
+
+    for (auto& line : m_lines)
+    {
+        if (!line.dirty)
+        {
+            continue;
+        }
+
+        // Use the font layout to build the quads of the line, scale them around the start of the
+        // line and clear what its previous text left behind.
+        VertexType* vertices = m_vertices.data() + line.firstVertex;
+        const size_t vertexCount =
+            m_layout->BuildQuadArray(vertices, line.text, line.drawX, line.drawY, line.red, line.green, line.blue);
+
+        if (m_scale != 1.0f)
+        {
+            for (size_t i = 0; i < vertexCount; ++i)
+            {
+                vertices[i].position[0] = line.drawX + (vertices[i].position[0] - line.drawX) * m_scale;
+                vertices[i].position[1] = line.drawY + (vertices[i].position[1] - line.drawY) * m_scale;
+            }
+        }
+
+        std::fill(vertices + vertexCount, vertices + FontLayout::s_VerticesPerQuad * line.maxLength, VertexType{});
+
+        line.dirty = false;
+        changed = true;
+    }
+
+    m_dirty = false;
+
+    return changed;
+}
+
+const TextBatch::VertexType* TextBatch::GetVertices() const noexcept
+{
+    return m_vertices.data();
+}
+
+size_t TextBatch::GetVertexCount() const noexcept
+{
+    return m_vertices.size();
+}
+
+const uint32_t* TextBatch::GetIndices() const noexcept
+{
+    return m_indices.data();
+}
+
+size_t TextBatch::GetIndexCount() const noexcept
+{
+    return m_indices.size();
+}
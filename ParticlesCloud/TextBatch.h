@@ -0,0 +1,76 @@
+#ifndef _TEXTBATCH_H_
+#define _TEXTBATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FontLayout.h"
+#include "MemoryTracker.h"
+
+// Lays out the lines of the HUD into one vertex array of indexed quads that is drawn with a single
+// draw call. Every line owns a fixed range of the array sized for its longest text, so only a line
+// whose text or color changed is laid out again, in place, and the unused tail of its range holds
+// empty quads. The indices never change once the lines are added.
+class TextBatch
+{
+public:
+    using VertexType = FontLayout::VertexType;
+
+public:
+    TextBatch();
+
+    //--------------------------------------------------------------------------------------
+    // Start over with no lines. Every letter is drawn scale times its size in the font,
+    // around the start of its line.
+    //--------------------------------------------------------------------------------------
+    void Initialize(const FontLayout& layout, int screenWidth, int screenHeight, float scale = 1.0f);
+
+    //--------------------------------------------------------------------------------------
+    // Add a line with room for maxLength letters, positioned in pixels from the top left
+    // corner of the screen. Returns the index of the line.
+    //--------------------------------------------------------------------------------------
+    size_t AddLine(int maxLength, int positionX, int positionY);
+
+    //--------------------------------------------------------------------------------------
+    // Set the text and color of a line. Returns false when the text does not fit the line,
+    // setting the text it already shows does nothing.
+    //--------------------------------------------------------------------------------------
+    bool SetLine(size_t line, std::string_view text, float red, float green, float blue);
+
+    //--------------------------------------------------------------------------------------
+    // Lay out the lines changed since the last update. Returns true when the vertices changed
+    // and have to be uploaded again.
+    //--------------------------------------------------------------------------------------
+    bool Update() noexcept;
+
+    const VertexType* GetVertices() const noexcept;
+    size_t GetVertexCount() const noexcept;
+    const uint32_t* GetIndices() const noexcept;
+    size_t GetIndexCount() const noexcept;
+
+private:
+    struct LineType
+    {
+        std::string text;
+        size_t firstVertex;
+        size_t maxLength;
+        float drawX, drawY;
+        float red, green, blue;
+        bool dirty;
+    };
+
+private:
+    const FontLayout* m_layout;
+    int m_screenWidth, m_screenHeight;
+    float m_scale;
+
+    std::vector<LineType> m_lines;
+    MemoryTracker::Vector<VertexType, MemoryTracker::Tag::Text> m_vertices;
+    MemoryTracker::Vector<uint32_t, MemoryTracker::Tag::Text> m_indices;
+    bool m_dirty;
+};
+
+#endif
@@ -1,12 +1,14 @@
 #include "TextClass.h"
 
-#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 #include "DirectXUtils.h"
 
 TextClass::TextClass()
-    : m_sentence1(nullptr)
-    , m_sentence2(nullptr)
+    : m_vertexBuffer(nullptr)
+    , m_indexBuffer(nullptr)
 {
 }
 
@@ -25,7 +27,9 @@ bool TextClass::Initialize(
     HWND hwnd,
     int screenWidth,
     int screenHeight,
-    Matrix baseViewMatrix)
+    Matrix baseViewMatrix,
+    const AssetPack& pack,
+    ShaderCache& shaders)
 {
     bool result;
 
@@ -44,7 +48,7 @@ bool TextClass::Initialize(
     }
 
     // Initialize the font object.
-    result = m_Font->Initialize(device, "./assets/fontdata.txt", PWSTR(L"./assets/font.gif"));
+    result = m_Font->Initialize(device, pack, "./assets/font.atlas");
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the font object.", L"Error", MB_OK);
@@ -59,36 +63,30 @@ bool TextClass::Initialize(
     }
 
     // Initialize the font shader object.
-    result = m_FontShader->Initialize(device, hwnd);
+    result = m_FontShader->Initialize(device, hwnd, shaders);
     if (!result)
     {
         MessageBox(hwnd, L"Could not initialize the font shader object.", L"Error", MB_OK);
         return false;
     }
 
-    // Initialize the first sentence.
-    result = InitializeSentence(&m_sentence1, 16, device);
-    if (!result)
-    {
-        return false;
-    }
+    // The lines are spaced by the line height of the font. When they do not all fit the screen
+    // height, the whole HUD is scaled down so the bottom lines stay visible in small windows.
+    const float spacing = m_Font->GetLayout().GetLineHeight() * s_LineSpacing;
+    const float available = static_cast<float>(screenHeight - 2 * s_Margin);
+    const float scale = std::clamp(available / (spacing * LineCount), 0.0f, 1.0f);
 
-    // Now update the sentence vertex buffer with the new string information.
-    result = UpdateSentence(m_sentence1, "Hello", 100, 100, 1.0f, 1.0f, 1.0f, deviceContext);
-    if (!result)
-    {
-        return false;
-    }
+    // Add the HUD lines in the order of LineType, each with room for its longest text.
+    constexpr int lineLengths[LineCount] = { 16, 32, 48, 48, 32, 32, 32 };
 
-    // Initialize the first sentence.
-    result = InitializeSentence(&m_sentence2, 16, device);
-    if (!result)
+    m_batch.Initialize(m_Font->GetLayout(), screenWidth, screenHeight, scale);
+    for (int line = 0; line < LineCount; ++line)
     {
-        return false;
+        m_batch.AddLine(lineLengths[line], s_Margin, s_Margin + static_cast<int>(line * spacing * scale));
     }
 
-    // Now update the sentence vertex buffer with the new string information.
-    result = UpdateSentence(m_sentence2, "Goodbye", 100, 200, 1.0f, 1.0f, 0.0f, deviceContext);
+    // Create the vertex and index buffers shared by all lines.
+    result = InitializeBuffer(device);
     if (!result)
     {
         return false;
@@ -99,11 +97,8 @@ bool TextClass::Initialize(
 
 void TextClass::Shutdown()
 {
-    // Release the first sentence.
-    ReleaseSentence(&m_sentence1);
-
-    // Release the second sentence.
-    ReleaseSentence(&m_sentence2);
+    // Release the vertex and index buffers of the lines.
+    ShutdownBuffer();
 
     // Release the font shader object.
     if (m_FontShader)
@@ -124,17 +119,37 @@ void TextClass::Shutdown()
 
 bool TextClass::Render(ID3D11DeviceContext* deviceContext, Matrix worldMatrix, Matrix orthoMatrix)
 {
+    unsigned int stride, offset;
     bool result;
 
-    // Draw the first sentence.
-    result = RenderSentence(deviceContext, m_sentence1, worldMatrix, orthoMatrix);
+    // Lay out the lines that changed since the last frame and upload them.
+    result = UpdateBuffer(deviceContext);
     if (!result)
     {
         return false;
     }
 
-    // Draw the second sentence.
-    result = RenderSentence(deviceContext, m_sentence2, worldMatrix, orthoMatrix);
+    // Set vertex buffer stride and offset.
+    stride = sizeof(TextBatch::VertexType);
+    offset = 0;
+
+    // Set the vertex buffer to active in the input assembler so it can be rendered.
+    deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+
+    // Set the index buffer to active in the input assembler so it can be rendered.
+    deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+
+    // Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
+    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+    // Render every line at once using the font shader, the colors are part of the vertices.
+    result = m_FontShader->Render(
+        deviceContext,
+        static_cast<int>(m_batch.GetIndexCount()),
+        worldMatrix,
+        m_baseViewMatrix,
+        orthoMatrix,
+        m_Font->GetTexture());
     if (!result)
     {
         return false;
@@ -143,207 +158,109 @@ bool TextClass::Render(ID3D11DeviceContext* deviceContext, Matrix worldMatrix, M
     return true;
 }
 
-bool TextClass::InitializeSentence(SentenceType** sentencesPtr, int maxLength, ID3D11Device* device)
+bool TextClass::InitializeBuffer(ID3D11Device* device)
 {
-    std::vector<VertexType> vertices;
-    std::vector<unsigned long> indices;
-
-    // VertexType* vertices;
-    // unsigned long* indices;
     D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
     D3D11_SUBRESOURCE_DATA vertexData, indexData;
     HRESULT result;
 
-    // Create a new sentence object.
-    *sentencesPtr = new SentenceType;
-    if (!*sentencesPtr)
-    {
-        return false;
-    }
-
-    SentenceType* sentence = *sentencesPtr;
-    // Initialize the sentence buffers to null.
-    sentence->vertexBuffer = 0;
-    sentence->indexBuffer = 0;
-
-    // Set the maximum length of the sentence.
-    sentence->maxLength = maxLength;
-
-    // Set the number of vertices in the vertex array.
-    sentence->vertexCount = 6 * maxLength;
-
-    // Set the number of indexes in the index array.
-    sentence->indexCount = sentence->vertexCount;
-
-    // Create the vertex array and initialize vertex array to zeros at first.
-    vertices.resize(sentence->vertexCount);
-
-    // Create the index array.
-    indices.reserve(sentence->indexCount);
-
-    // Initialize the index array.
-    for (int i = 0; i < sentence->indexCount; i++)
-    {
-        indices.push_back(i);
-    }
-
     // Set up the description of the dynamic vertex buffer.
     vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(VertexType) * sentence->vertexCount;
+    vertexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(TextBatch::VertexType) * m_batch.GetVertexCount());
     vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
     vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     vertexBufferDesc.MiscFlags = 0;
     vertexBufferDesc.StructureByteStride = 0;
 
-    // Give the subresource structure a pointer to the vertex data.
-    vertexData.pSysMem = vertices.data();
+    // Give the subresource structure a pointer to the vertex data, empty lines at first.
+    vertexData.pSysMem = m_batch.GetVertices();
     vertexData.SysMemPitch = 0;
     vertexData.SysMemSlicePitch = 0;
 
     // Create the vertex buffer.
-    result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &(sentence->vertexBuffer));
+    result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
     if (FAILED(result))
     {
         return false;
     }
 
-    // Set up the description of the static index buffer.
-    indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-    indexBufferDesc.ByteWidth = sizeof(unsigned long) * sentence->indexCount;
+    DirectXUtils::TrackBuffer(m_vertexBuffer, MemoryTracker::Tag::GpuText);
+
+    // Set up the description of the static index buffer, the quads of the lines never move.
+    indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    indexBufferDesc.ByteWidth = static_cast<UINT>(sizeof(uint32_t) * m_batch.GetIndexCount());
     indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
     indexBufferDesc.CPUAccessFlags = 0;
     indexBufferDesc.MiscFlags = 0;
     indexBufferDesc.StructureByteStride = 0;
 
     // Give the subresource structure a pointer to the index data.
-    indexData.pSysMem = indices.data();
+    indexData.pSysMem = m_batch.GetIndices();
     indexData.SysMemPitch = 0;
     indexData.SysMemSlicePitch = 0;
 
     // Create the index buffer.
-    result = device->CreateBuffer(&indexBufferDesc, &indexData, &(sentence->indexBuffer));
+    result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
     if (FAILED(result))
     {
         return false;
     }
 
+    DirectXUtils::TrackBuffer(m_indexBuffer, MemoryTracker::Tag::GpuText);
+
     return true;
 }
 
-bool TextClass::UpdateSentence(
-    SentenceType* sentence,
-    std::string_view text,
-    int positionX,
-    int positionY,
-    float red,
-    float green,
-    float blue,
-    ID3D11DeviceContext* deviceContext)
+void TextClass::ShutdownBuffer()
 {
-    HRESULT result;
-    D3D11_MAPPED_SUBRESOURCE mappedResource;
-    VertexType* verticesPtr;
-
-    // Store the color of the sentence.
-    sentence->red = red;
-    sentence->green = green;
-    sentence->blue = blue;
-
-    // Get the number of letters in the sentence.
-    const auto numLetters = text.length();
-
-    // Check for possible buffer overflow.
-    if (numLetters > sentence->maxLength)
+    if (m_vertexBuffer)
     {
-        return false;
+        // Release the vertex buffer.
+        DirectXUtils::UntrackBuffer(m_vertexBuffer, MemoryTracker::Tag::GpuText);
+        DirectXUtils::SafeRelease(m_vertexBuffer);
+        m_vertexBuffer = nullptr;
     }
 
-    // Create the vertex array and initialize vertex array to zeros at first.
-    std::vector<VertexType> vertices(sentence->vertexCount);
-
-    // Calculate the X and Y pixel position on the screen to start drawing to.
-    const auto drawX = static_cast<float>(((m_screenWidth / 2) * -1) + positionX);
-    const auto drawY = static_cast<float>((m_screenHeight / 2) - positionY);
-
-    // Use the font class to build the vertex array from the sentence text and sentence draw location.
-    m_Font->BuildVertexArray(vertices.data(), text, drawX, drawY);
-
-    // Lock the vertex buffer so it can be written to.
-    result = deviceContext->Map(sentence->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
-    if (FAILED(result))
+    if (m_indexBuffer)
     {
-        return false;
-    }
-
-    // Get a pointer to the data in the vertex buffer.
-    verticesPtr = reinterpret_cast<VertexType*>(mappedResource.pData);
-
-    // Copy the data into the vertex buffer.
-    memcpy(verticesPtr, vertices.data(), (sizeof(VertexType) * sentence->vertexCount));
-
-    // Unlock the vertex buffer.
-    deviceContext->Unmap(sentence->vertexBuffer, 0);
-
-    return true;
-}
-
-void TextClass::ReleaseSentence(SentenceType** sentencesPtr)
-{
-    if (*sentencesPtr)
-    {
-        SentenceType* sentence = *sentencesPtr;
-        
-        // Release the sentence vertex buffer.
-        DirectXUtils::SafeRelease(sentence->vertexBuffer);
-
-        // Release the sentence index buffer.
-        DirectXUtils::SafeRelease(sentence->indexBuffer);
-
-        // Release the sentence.
-        delete sentence;
-        *sentencesPtr = nullptr;
+        // Release the index buffer.
+        DirectXUtils::UntrackBuffer(m_indexBuffer, MemoryTracker::Tag::GpuText);
+        DirectXUtils::SafeRelease(m_indexBuffer);
+        m_indexBuffer = nullptr;
     }
 
     return;
 }
 
-bool TextClass::RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, Matrix worldMatrix, Matrix orthoMatrix)
+bool TextClass::UpdateBuffer(ID3D11DeviceContext* deviceContext)
 {
-    unsigned int stride, offset;
-    Vector4 pixelColor;
-    bool result;
-
-    // Set vertex buffer stride and offset.
-    stride = sizeof(VertexType);
-    offset = 0;
-
-    // Set the vertex buffer to active in the input assembler so it can be rendered.
-    deviceContext->IASetVertexBuffers(0, 1, &sentence->vertexBuffer, &stride, &offset);
-
-    // Set the index buffer to active in the input assembler so it can be rendered.
-    deviceContext->IASetIndexBuffer(sentence->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-
-    // Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-    deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    HRESULT result;
+    D3D11_MAPPED_SUBRESOURCE mappedResource;
 
-    // Create a pixel color vector with the input sentence color.
-    pixelColor = { sentence->red, sentence->green, sentence->blue, 1.0f };
+    // Nothing to upload while every line shows the same text.
+    if (!m_batch.Update())
+    {
+        return true;
+    }
 
-    // Render the text using the font shader.
-    result =
-        m_FontShader
-            ->Render(deviceContext, sentence->indexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(), pixelColor);
-    if (!result)
+    // Lock the vertex buffer so it can be written to, discarding replaces the whole buffer.
+    result = deviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+    if (FAILED(result))
     {
-        false;
+        return false;
     }
 
+    // Copy the vertices of all lines into the vertex buffer.
+    std::memcpy(mappedResource.pData, m_batch.GetVertices(), sizeof(TextBatch::VertexType) * m_batch.GetVertexCount());
+
+    // Unlock the vertex buffer.
+    deviceContext->Unmap(m_vertexBuffer, 0);
+
     return true;
 }
 
-bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
+bool TextClass::SetFps(int fps)
 {
-    char tempString[16];
     char fpsString[16];
     float red, green, blue;
     bool result;
@@ -354,12 +271,8 @@ bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
         fps = 9999;
     }
 
-    // Convert the fps integer to string format.
-    _itoa_s(fps, tempString, 10);
-
     // Setup the fps string.
-    strcpy_s(fpsString, "Fps: ");
-    strcat_s(fpsString, tempString);
+    std::snprintf(fpsString, sizeof(fpsString), "Fps: %d", fps);
 
     // If fps is 60 or above set the fps color to green.
     if (fps >= 60)
@@ -385,8 +298,59 @@ bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
         blue = 0.0f;
     }
 
-    // Update the sentence vertex buffer with the new string information.
-    result = UpdateSentence(m_sentence1, fpsString, 20, 20, red, green, blue, deviceContext);
+    // Update the line with the new string information, it is laid out again only when it changed.
+    result = m_batch.SetLine(FpsLine, fpsString, red, green, blue);
+    if (!result)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool TextClass::SetCpu(int cpu, int processCpu)
+{
+    char cpuString[32];
+    bool result;
+
+    // Setup the cpu string with the machine and the process usage.
+    std::snprintf(cpuString, sizeof(cpuString), "Cpu %d%% App %d%%", cpu, processCpu);
+
+    // Update the line with the new string information, it is laid out again only when it changed.
+    result = m_batch.SetLine(CpuLine, cpuString, 0.0f, 1.0f, 0.0f);
+    if (!result)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool TextClass::SetFrameTimes(const FrameStats& stats)
+{
+    char percentilesString[48];
+    char tailString[48];
+    float red, green, blue;
+    bool result;
+
+    // Setup the frame time strings, in milliseconds.
+    std::snprintf(percentilesString, sizeof(percentilesString), "p50 %.1f p90 %.1f p99 %.1f", stats.P50, stats.P90, stats.P99);
+    std::snprintf(tailString, sizeof(tailString), "p99.9 %.1f max %.1f ms", stats.P999, stats.Max);
+
+    // Color the tail by the slowest percent of frames: green when they fit a 60Hz frame,
+    // yellow when they fit a 30Hz frame and red otherwise.
+    red = stats.P99 > 1000.0f / 60.0f ? 1.0f : 0.0f;
+    green = stats.P99 > 1000.0f / 30.0f ? 0.0f : 1.0f;
+    blue = 0.0f;
+
+    // Update the lines with the new string information, they are laid out again only when they changed.
+    result = m_batch.SetLine(FrameTimesLine, percentilesString, 0.0f, 1.0f, 0.0f);
+    if (!result)
+    {
+        return false;
+    }
+
+    result = m_batch.SetLine(FrameTailLine, tailString, red, green, blue);
     if (!result)
     {
         return false;
@@ -395,22 +359,62 @@ bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
     return true;
 }
 
-bool TextClass::SetCpu(int cpu, ID3D11DeviceContext* deviceContext)
+bool TextClass::SetMemory(const MemoryStats& stats)
 {
-    char tempString[16];
-    char cpuString[16];
+    char memoryString[32];
     bool result;
 
-    // Convert the cpu integer to string format.
-    _itoa_s(cpu, tempString, 10);
+    constexpr uint64_t megabyte = 1024 * 1024;
+
+    // Setup the memory string with the resident and the peak resident size of the process.
+    std::snprintf(
+        memoryString,
+        sizeof(memoryString),
+        "Mem %lluMB Peak %lluMB",
+        static_cast<unsigned long long>(stats.ResidentBytes / megabyte),
+        static_cast<unsigned long long>(stats.PeakResidentBytes / megabyte));
+
+    // Update the line with the new string information, it is laid out again only when it changed.
+    result = m_batch.SetLine(MemoryLine, memoryString, 0.0f, 1.0f, 0.0f);
+    if (!result)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool TextClass::SetInputLatency(const InputLatencyStats& stats)
+{
+    char latencyString[32];
+    bool result;
+
+    // Setup the input to present latency string, in milliseconds.
+    std::snprintf(latencyString, sizeof(latencyString), "Input p50 %.1f p99 %.1f ms", stats.P50, stats.P99);
+
+    // Update the line with the new string information, it is laid out again only when it changed.
+    result = m_batch.SetLine(InputLatencyLine, latencyString, 0.0f, 1.0f, 0.0f);
+    if (!result)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+bool TextClass::SetCloudStats(const ParticlesSimulation::CloudStats& stats)
+{
+    char cloudString[32];
+    bool result;
 
-    // Setup the cpu string.
-    strcpy_s(cpuString, "Cpu: ");
-    strcat_s(cpuString, tempString);
-    strcat_s(cpuString, "%");
+    // Setup the cloud string with the total energy and the largest side of the bounding box.
+    const float size = std::max({ stats.BoundsMax[0] - stats.BoundsMin[0],
+                                  stats.BoundsMax[1] - stats.BoundsMin[1],
+                                  stats.BoundsMax[2] - stats.BoundsMin[2] });
+    std::snprintf(cloudString, sizeof(cloudString), "Energy %.4g Box %.0f", stats.KineticEnergy + stats.PotentialEnergy, size);
 
-    // Update the sentence vertex buffer with the new string information.
-    result = UpdateSentence(m_sentence2, cpuString, 20, 160, 0.0f, 1.0f, 0.0f, deviceContext);
+    // Update the line with the new string information, it is laid out again only when it changed.
+    result = m_batch.SetLine(CloudLine, cloudString, 0.0f, 1.0f, 0.0f);
     if (!result)
     {
         return false;
@@ -4,24 +4,38 @@
 #include <memory>
 #include <string_view>
 
+#include "AssetPack.h"
 #include "FontClass.h"
 #include "FontShaderClass.h"
+#include "FpsClass.h"
+#include "InputLatencyClass.h"
+#include "MemoryClass.h"
+#include "ParticlesSimulation.h"
+#include "ShaderCache.h"
+#include "TextBatch.h"
 
+// Draws the HUD: every line is laid out into one dynamic vertex buffer of indexed quads by a
+// TextBatch and drawn with a single draw call. The buffer is only written when the text of a line
+// changed.
 class TextClass
 {
 private:
-    struct SentenceType
+    enum LineType
     {
-        ID3D11Buffer *vertexBuffer, *indexBuffer;
-        int vertexCount, indexCount, maxLength;
-        float red, green, blue;
+        FpsLine,
+        CpuLine,
+        FrameTimesLine,
+        FrameTailLine,
+        MemoryLine,
+        InputLatencyLine,
+        CloudLine,
+        LineCount,
     };
 
-    struct VertexType
-    {
-        Vector4 position;
-        Vector2 texture;
-    };
+    // Distance of the HUD from the top left corner of the screen and of the lines from each
+    // other in line heights, both before the HUD is scaled to fit the screen.
+    static constexpr int s_Margin = 20;
+    static constexpr float s_LineSpacing = 1.25f;
 
 public:
     TextClass();
@@ -34,26 +48,23 @@ public:
         HWND hwnd,
         int screenWidth,
         int screenHeight,
-        Matrix baseViewMatrix);
+        Matrix baseViewMatrix,
+        const AssetPack& pack,
+        ShaderCache& shaders);
     void Shutdown();
     bool Render(ID3D11DeviceContext* deviceContext, Matrix worldMatrix, Matrix orthoMatrix);
 
-    bool SetFps(int fps, ID3D11DeviceContext* deviceContext);
-    bool SetCpu(int cpu, ID3D11DeviceContext* deviceContext);
+    bool SetFps(int fps);
+    bool SetCpu(int cpu, int processCpu);
+    bool SetFrameTimes(const FrameStats& stats);
+    bool SetMemory(const MemoryStats& stats);
+    bool SetInputLatency(const InputLatencyStats& stats);
+    bool SetCloudStats(const ParticlesSimulation::CloudStats& stats);
 
 private:
-    bool InitializeSentence(SentenceType** sentence, int maxLength, ID3D11Device* device);
-    bool UpdateSentence(
-        SentenceType* sentence,
-        std::string_view text,
-        int positionX,
-        int positionY,
-        float red,
-        float green,
-        float blue,
-        ID3D11DeviceContext* deviceContext);
-    void ReleaseSentence(SentenceType** sentence);
-    bool RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, Matrix worldMatrix, Matrix orthoMatrix);
+    bool InitializeBuffer(ID3D11Device* device);
+    void ShutdownBuffer();
+    bool UpdateBuffer(ID3D11DeviceContext* deviceContext);
 
 private:
     std::unique_ptr<FontClass> m_Font;
@@ -61,8 +72,8 @@ private:
     int m_screenWidth, m_screenHeight;
     Matrix m_baseViewMatrix;
 
-    SentenceType* m_sentence1;
-    SentenceType* m_sentence2;
+    TextBatch m_batch;
+    ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,7 +1,5 @@
 #include "TextureClass.h"
 
-#include <string_view>
-
 TextureClass::TextureClass()
     : m_texture(nullptr)
 {
@@ -12,19 +10,48 @@ TextureClass::~TextureClass()
     Shutdown();
 }
 
-bool TextureClass::Initialize(ID3D11Device* device, std::wstring_view filename)
+bool TextureClass::Initialize(ID3D11Device* device, UINT width, UINT height, const void* texels, UINT pitch)
 {
+    D3D11_TEXTURE2D_DESC textureDesc;
+    D3D11_SUBRESOURCE_DATA textureData;
+    D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+    ID3D11Texture2D* texture;
     HRESULT result;
 
-    // Load the texture.
-    if (filename.ends_with(L".dds"))
-    {
-        result = DirectX::CreateDDSTextureFromFile(device, filename.data(), nullptr, &m_texture);
-    }
-    else
+    // Set up the description of the texture, it never changes after it is created.
+    textureDesc.Width = width;
+    textureDesc.Height = height;
+    textureDesc.MipLevels = 1;
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.SampleDesc.Quality = 0;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+    textureDesc.CPUAccessFlags = 0;
+    textureDesc.MiscFlags = 0;
+
+    // The texels are uploaded from where they are, for example a mapped file.
+    textureData.pSysMem = texels;
+    textureData.SysMemPitch = pitch;
+    textureData.SysMemSlicePitch = 0;
+
+    // Create the texture.
+    result = device->CreateTexture2D(&textureDesc, &textureData, &texture);
+    if (FAILED(result))
     {
-        result = DirectX::CreateWICTextureFromFile(device, filename.data(), nullptr, &m_texture);
+        return false;
     }
+
+    // Set up the description of the shader resource view.
+    viewDesc.Format = textureDesc.Format;
+    viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    viewDesc.Texture2D.MostDetailedMip = 0;
+    viewDesc.Texture2D.MipLevels = 1;
+
+    // Create the shader resource view, it keeps the texture alive.
+    result = device->CreateShaderResourceView(texture, &viewDesc, &m_texture);
+    texture->Release();
     if (FAILED(result))
     {
         return false;
@@ -1,12 +1,7 @@
 #ifndef _TEXTURECLASS_H_
 #define _TEXTURECLASS_H_
 
-#include <memory>
-#include <string_view>
-
 #include <d3d11.h>
-#include <directxtk/DDSTextureLoader.h>
-#include <directxtk/WICTextureLoader.h>
 
 class TextureClass
 {
@@ -14,7 +9,11 @@ public:
     TextureClass();
     ~TextureClass();
 
-    bool Initialize(ID3D11Device* device, std::wstring_view filename);
+    //--------------------------------------------------------------------------------------
+    // Create an immutable RGBA8 texture straight from texels in memory, rows pitch bytes
+    // apart, without decoding anything.
+    //--------------------------------------------------------------------------------------
+    bool Initialize(ID3D11Device* device, UINT width, UINT height, const void* texels, UINT pitch);
     void Shutdown();
 
     ID3D11ShaderResourceView* GetTexture() noexcept;
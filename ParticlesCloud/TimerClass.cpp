@@ -1,32 +1,20 @@
 #include "TimerClass.h"
 
+#include "Clock.h"
+
 bool TimerClass::Initialize()
 {
-    // Check to see if this system supports high performance timers.
-    QueryPerformanceFrequency(reinterpret_cast<LARGE_INTEGER*>(&m_frequency));
-    if (m_frequency == 0)
-    {
-        return false;
-    }
-
-    // Find out how many times the frequency counter ticks every millisecond.
-    m_ticksPerMs = static_cast<float>(m_frequency / 1000);
-
-    QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&m_startTime));
+    m_startTime = Clock::Now();
+    m_frameTime = 0;
 
     return true;
 }
 
 void TimerClass::Frame()
 {
-    INT64 currentTime;
-    float timeDifference;
-
-    QueryPerformanceCounter(reinterpret_cast<LARGE_INTEGER*>(&currentTime));
+    const uint64_t currentTime = Clock::Now();
 
-    timeDifference = static_cast<float>(currentTime - m_startTime);
-
-    m_frameTime = timeDifference / m_ticksPerMs;
+    m_frameTime = currentTime - m_startTime;
 
     m_startTime = currentTime;
 
@@ -34,6 +22,11 @@ void TimerClass::Frame()
 }
 
 float TimerClass::GetTime() const noexcept
+{
+    return Clock::ToMilliseconds(m_frameTime);
+}
+
+uint64_t TimerClass::GetFrameNanoseconds() const noexcept
 {
     return m_frameTime;
 }
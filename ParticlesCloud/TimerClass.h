@@ -1,20 +1,21 @@
 #ifndef _TIMERCLASS_H_
 #define _TIMERCLASS_H_
 
-#include <windows.h>
+#include <cstdint>
 
 class TimerClass
 {
 public:
     bool Initialize();
     void Frame();
+
+    // Time between the last two calls of Frame, in milliseconds and in nanoseconds.
     float GetTime() const noexcept;
+    uint64_t GetFrameNanoseconds() const noexcept;
 
 private:
-    INT64 m_frequency;
-    float m_ticksPerMs;
-    INT64 m_startTime;
-    float m_frameTime;
+    uint64_t m_startTime;
+    uint64_t m_frameTime;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,77 @@
+#include "WellPath.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+void WellPath::BuildSubsteps(
+    const CameraClass& camera,
+    const Parameters& parameters,
+    const std::vector<CursorSample>& path,
+    int cursorX,
+    int cursorY,
+    std::vector<ParticlesSimulation::StepParameters>& substeps)
+{
+    // The world XY plane (z = 0).
+    constexpr MathUtils::Float4 planeXY = { 0.0f, 0.0f, 1.0f, 0.0f };
+    constexpr size_t maxPoints = 64;
+
+    const size_t pathSize = path.size();
+    const size_t substepCount = std::clamp<size_t>(pathSize, 1, std::clamp<size_t>(parameters.MaxSubsteps, 1, maxPoints));
+
+    std::array<MathUtils::Float2, maxPoints> points;
+    std::array<MathUtils::Float3, maxPoints> positions;
+
+    for (size_t i = 1; i <= substepCount; ++i)
+    {
+        // Hold the last cursor position while the mouse does not move.
+        float x = static_cast<float>(cursorX);
+        float y = static_cast<float>(cursorY);
+        if (pathSize > 0)
+        {
+            const auto& sample = path[i * pathSize / substepCount - 1];
+            x = static_cast<float>(sample.X);
+            y = static_cast<float>(sample.Y);
+        }
+
+        // Normalize mouse position to range [-1, 1].
+        points[i - 1] = {
+            (x / static_cast<float>(parameters.ScreenWidth)) * 2.0f - 1.0f,
+            1.0f - (y / static_cast<float>(parameters.ScreenHeight)) * 2.0f,
+        };
+    }
+
+    // Intersect the rays under the cursor with the XY world plane.
+    camera.UnprojectToPlane(
+        std::span<const MathUtils::Float2>(points.data(), substepCount),
+        planeXY,
+        std::span<MathUtils::Float3>(positions.data(), substepCount));
+
+    substeps.clear();
+    for (size_t i = 1; i <= substepCount; ++i)
+    {
+        const auto& position = positions[i - 1];
+
+        // Add circular rotation.
+        const float fraction = static_cast<float>(i) / static_cast<float>(substepCount);
+        const float rotation = parameters.RotationBegin + (parameters.RotationEnd - parameters.RotationBegin) * fraction;
+        const float theta = MathUtils::ToRadians(rotation);
+
+        substeps.push_back(ParticlesSimulation::StepParameters{
+            { position.x,
+              position.y + parameters.OrbitRadius * std::cos(theta),
+              position.z + parameters.OrbitRadius * std::sin(theta) },
+            0.0f,
+        });
+    }
+}
+
+void WellPath::SetDeltaTime(float deltaTime, std::vector<ParticlesSimulation::StepParameters>& substeps) noexcept
+{
+    const float substepDeltaTime = deltaTime / static_cast<float>(std::max<size_t>(substeps.size(), 1));
+
+    for (auto& substep : substeps)
+    {
+        substep.DeltaTime = substepDeltaTime;
+    }
+}
@@ -0,0 +1,49 @@
+#ifndef _WELLPATH_H_
+#define _WELLPATH_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "CameraClass.h"
+#include "InputEvents.h"
+#include "ParticlesSimulation.h"
+
+// Turns the cursor path of a frame into the gravity wells of the substeps of a step, shared by the
+// viewer and the headless runner so a recorded session moves the well the same way in both.
+namespace WellPath
+{
+    struct Parameters
+    {
+        int ScreenWidth;
+        int ScreenHeight;
+
+        // The well orbits the point under the cursor, the rotation in degrees advances from
+        // RotationBegin to RotationEnd over the substeps.
+        float OrbitRadius;
+        float RotationBegin;
+        float RotationEnd;
+
+        size_t MaxSubsteps;
+    };
+
+    //--------------------------------------------------------------------------------------
+    // Fill substeps with the wells under evenly spaced points of the cursor path, at most
+    // MaxSubsteps, or a single well under the cursor when the path is empty. The points are
+    // unprojected in one batch with the matrices the camera cached on its last Render. The
+    // delta times are set to zero.
+    //--------------------------------------------------------------------------------------
+    void BuildSubsteps(
+        const CameraClass& camera,
+        const Parameters& parameters,
+        const std::vector<CursorSample>& path,
+        int cursorX,
+        int cursorY,
+        std::vector<ParticlesSimulation::StepParameters>& substeps);
+
+    //--------------------------------------------------------------------------------------
+    // Split the time of a step evenly between its substeps.
+    //--------------------------------------------------------------------------------------
+    void SetDeltaTime(float deltaTime, std::vector<ParticlesSimulation::StepParameters>& substeps) noexcept;
+};
+
+#endif
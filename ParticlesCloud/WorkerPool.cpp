@@ -0,0 +1,126 @@
+#include "WorkerPool.h"
+
+#include <algorithm>
+
+#include "Profiler.h"
+
+WorkerPool::WorkerPool()
+    : m_context(nullptr)
+    , m_function(nullptr)
+    , m_count(0)
+    , m_chunkCount(0)
+    , m_chunkSize(0)
+    , m_generation(0)
+    , m_remaining(0)
+    , m_stop(false)
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    Shutdown();
+}
+
+void WorkerPool::Initialize(size_t threadCount, const char* name)
+{
+    Shutdown();
+
+    m_stop.store(false, std::memory_order_relaxed);
+
+    const size_t workers = std::max<size_t>(threadCount, 1) - 1;
+    m_workers.reserve(workers);
+    for (size_t worker = 1; worker <= workers; ++worker)
+    {
+        m_workers.emplace_back(&WorkerPool::WorkerThread, this, worker, name);
+    }
+}
+
+void WorkerPool::Shutdown()
+{
+    if (m_workers.empty())
+    {
+        return;
+    }
+
+    // Wake up the workers with a generation they exit on.
+    m_stop.store(true, std::memory_order_relaxed);
+    m_generation.fetch_add(1, std::memory_order_release);
+    m_generation.notify_all();
+
+    for (auto& worker : m_workers)
+    {
+        worker.join();
+    }
+    m_workers.clear();
+}
+
+size_t WorkerPool::GetThreadCount() const noexcept
+{
+    return m_workers.size() + 1;
+}
+
+void WorkerPool::Run(size_t count, void* context, ChunkFunction function)
+{
+    // The same split as ParallelUtils::ParallelFor, so results do not depend on which one ran.
+    m_chunkCount = std::clamp<size_t>(GetThreadCount(), 1, std::max<size_t>(count, 1));
+    m_chunkSize = (count + m_chunkCount - 1) / m_chunkCount;
+    m_count = count;
+    m_context = context;
+    m_function = function;
+
+    // Every worker answers, also the ones without a chunk, so none of them still reads this loop
+    // when the next one is written.
+    const size_t workers = m_workers.size();
+    if (workers > 0)
+    {
+        m_remaining.store(workers, std::memory_order_relaxed);
+        m_generation.fetch_add(1, std::memory_order_release);
+        m_generation.notify_all();
+    }
+
+    RunChunk(0);
+
+    // Wait for the chunks of the workers.
+    for (size_t remaining = m_remaining.load(std::memory_order_acquire); workers > 0 && remaining != 0;
+         remaining = m_remaining.load(std::memory_order_acquire))
+    {
+        m_remaining.wait(remaining, std::memory_order_acquire);
+    }
+}
+
+void WorkerPool::WorkerThread(size_t worker, const char* name)
+{
+    uint64_t generation = 0;
+
+    Profiler::SetThreadName(name);
+
+    while (true)
+    {
+        m_generation.wait(generation, std::memory_order_acquire);
+        generation = m_generation.load(std::memory_order_acquire);
+
+        if (m_stop.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+
+        // Loops with fewer chunks than threads leave the last workers idle.
+        if (worker < m_chunkCount)
+        {
+            RunChunk(worker);
+        }
+
+        if (m_remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            m_remaining.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunChunk(size_t chunk) const
+{
+    const size_t begin = std::min(chunk * m_chunkSize, m_count);
+    const size_t end = std::min(begin + m_chunkSize, m_count);
+
+    m_function(m_context, begin, end, chunk);
+}
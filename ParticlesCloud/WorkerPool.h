@@ -0,0 +1,69 @@
+#ifndef _WORKERPOOL_H_
+#define _WORKERPOOL_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Worker threads started once and reused for every ParallelFor, so a loop that runs every frame
+// or every timed sample does not pay for creating and joining threads. The calling thread takes
+// the first chunk, the workers wait on a generation counter for the next loop.
+class WorkerPool
+{
+public:
+    WorkerPool();
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+    ~WorkerPool();
+
+    //--------------------------------------------------------------------------------------
+    // Start threadCount - 1 workers, the caller of ParallelFor is the last thread. The name
+    // labels the workers in the profiler traces and must outlive the pool.
+    //--------------------------------------------------------------------------------------
+    void Initialize(size_t threadCount, const char* name = "Worker");
+    void Shutdown();
+
+    size_t GetThreadCount() const noexcept;
+
+    //--------------------------------------------------------------------------------------
+    // Split [0, count) into the same chunks as ParallelUtils::ParallelFor and call
+    // function(begin, end, chunkIndex) for each chunk on its own thread. Returns once every
+    // chunk is done. Only one thread at a time may call ParallelFor.
+    //--------------------------------------------------------------------------------------
+    template<typename Function>
+    void ParallelFor(size_t count, Function&& function)
+    {
+        using FunctionType = std::remove_reference_t<Function>;
+
+        Run(count, const_cast<void*>(static_cast<const void*>(&function)), [](void* context, size_t begin, size_t end, size_t chunk) {
+            (*static_cast<FunctionType*>(context))(begin, end, chunk);
+        });
+    }
+
+private:
+    using ChunkFunction = void (*)(void* context, size_t begin, size_t end, size_t chunk);
+
+    void Run(size_t count, void* context, ChunkFunction function);
+    void WorkerThread(size_t worker, const char* name);
+    void RunChunk(size_t chunk) const;
+
+private:
+    std::vector<std::thread> m_workers;
+
+    // The loop of the current generation, written before m_generation is bumped and read by
+    // every worker before it counts down m_remaining.
+    void* m_context;
+    ChunkFunction m_function;
+    size_t m_count;
+    size_t m_chunkCount;
+    size_t m_chunkSize;
+
+    std::atomic<uint64_t> m_generation;
+    std::atomic<size_t> m_remaining;
+    std::atomic<bool> m_stop;
+};
+
+#endif
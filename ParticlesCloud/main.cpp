@@ -6,8 +6,9 @@ int WINAPI WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, PSTR pScmdline,
     
     bool result;
 
-    // Initialize and run the system object.
-    if (System.Initialize())
+    // Initialize and run the system object. The command line optionally names a particles file
+    // to start the simulation from.
+    if (System.Initialize(pScmdline ? pScmdline : ""))
     {
         System.Run();
     }
@@ -0,0 +1,105 @@
+// Offline baker of the font atlas used by the viewer.
+//
+// Reads the glyph metrics of fontdata.txt through FontLayout, so the glyph table is built exactly
+// like the viewer would build it, decodes the GIF texture of the font into RGBA8 texels and writes
+// both into one atlas file that the viewer maps without parsing or decoding anything.
+//
+//   particles_fontbake [--font assets/fontdata.txt] [--texture assets/font.gif]
+//                      [--output assets/font.atlas]
+
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "FontAtlas.h"
+#include "FontLayout.h"
+#include "ImageDecoder.h"
+#include "MappedFile.h"
+
+namespace
+{
+    struct BakerOptions
+    {
+        std::string Font = "assets/fontdata.txt";
+        std::string Texture = "assets/font.gif";
+        std::string Output = "assets/font.atlas";
+    };
+
+    bool ParseOptions(int argc, char** argv, BakerOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            const std::string_view value = argv[++i];
+
+            if (argument == "--font")
+            {
+                options.Font = value;
+            }
+            else if (argument == "--texture")
+            {
+                options.Texture = value;
+            }
+            else if (argument == "--output")
+            {
+                options.Output = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    BakerOptions options;
+    FontLayout layout;
+    FontAtlas atlas;
+    MappedFile texture;
+    ImageData image;
+    std::string errorMessage;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: particles_fontbake [--font file] [--texture file] [--output file]\n";
+        return 1;
+    }
+
+    if (!layout.LoadFontData(options.Font))
+    {
+        std::cerr << "Could not read the font data " << options.Font << "\n";
+        return 1;
+    }
+
+    if (!texture.Open(options.Texture))
+    {
+        std::cerr << "Could not open " << options.Texture << "\n";
+        return 1;
+    }
+
+    if (!ImageDecoder::DecodeGif({ texture.GetData(), texture.GetSize() }, image, errorMessage))
+    {
+        std::cerr << "Could not decode " << options.Texture << ": " << errorMessage << "\n";
+        return 1;
+    }
+
+    if (!atlas.Save(options.Output, layout, image.Width, image.Height, image.Texels))
+    {
+        std::cerr << "Could not write " << options.Output << ": " << atlas.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    std::cout << "Baked " << options.Output << ": " << layout.GetGlyphs().size() << " glyphs, " << image.Width
+              << "x" << image.Height << " texels\n";
+
+    return 0;
+}
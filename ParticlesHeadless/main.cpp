@@ -0,0 +1,419 @@
+// Headless run of the particle scene, for machines without a display or Direct3D.
+//
+// Drives the same simulation as the viewer frame by frame: the camera drifts along X, the well
+// orbits the point under the center of the screen and every frame advances the particles by the
+// scene time scale. With --playback the frame times and the cursor path come from an input
+// recording of the viewer instead, so a recorded session replays as a fixed workload. Frame time
+// percentiles, the statistics of the cloud after the last frame, CPU and memory usage are printed
+// as JSON, either to stdout or to the file given with --output. --write saves the particles after
+// the last frame as a particles file the viewer can start from.
+//
+//   particles_headless [--scene assets/scene.cfg] [--particles 1000000] [--frames 600]
+//                      [--threads 8] [--frame-ms 16] [--playback session.rec]
+//                      [--trace trace.json] [--output stats.json] [--write cloud.pcld]
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CameraClass.h"
+#include "Clock.h"
+#include "CpuClass.h"
+#include "FrameTimeHistogram.h"
+#include "InputRecording.h"
+#include "InputState.h"
+#include "MathUtils.h"
+#include "MemoryClass.h"
+#include "ParallelUtils.h"
+#include "ParticlesLoader.h"
+#include "ParticlesSimulation.h"
+#include "ParticlesSimulationThread.h"
+#include "ParticlesStore.h"
+#include "Profiler.h"
+#include "SceneConfigClass.h"
+#include "TimerClass.h"
+#include "WellPath.h"
+#include "WorkerPool.h"
+
+namespace
+{
+    // Same view as the Direct3D viewer with its default 1080p window.
+    constexpr int s_ScreenWidth = 1920;
+    constexpr int s_ScreenHeight = 1080;
+    constexpr float s_ScreenNear = 0.1f;
+    constexpr float s_ScreenDepth = 1000.0f;
+
+    struct HeadlessOptions
+    {
+        std::string Scene = "assets/scene.cfg";
+        size_t Particles = 0;
+        size_t Frames = 600;
+        size_t Threads = ParallelUtils::GetDefaultThreadCount();
+        float FrameMilliseconds = 16.0f;
+        std::string Playback;
+        std::string Trace;
+        std::string Output;
+        std::string Write;
+    };
+
+    struct HeadlessResult
+    {
+        size_t Particles = 0;
+        size_t Frames = 0;
+        double Seconds = 0.0;
+        FrameTimeHistogram StepTimes;
+        MathUtils::Float3 WellPosition = {};
+        ParticlesSimulation::CloudStats Cloud;
+        CpuSnapshot Cpu;
+        MemoryStats Memory;
+    };
+
+    bool ParseSize(std::string_view text, size_t& value)
+    {
+        char* end = nullptr;
+        const std::string number{ text };
+        const auto result = std::strtoull(number.c_str(), &end, 10);
+        if (end == number.c_str() || *end != '\0' || result == 0)
+        {
+            return false;
+        }
+
+        value = static_cast<size_t>(result);
+        return true;
+    }
+
+    bool ParseOptions(int argc, char** argv, HeadlessOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+            if (i + 1 >= argc)
+            {
+                return false;
+            }
+
+            const std::string_view value = argv[++i];
+            bool result = true;
+
+            if (argument == "--scene")
+            {
+                options.Scene = value;
+            }
+            else if (argument == "--particles")
+            {
+                result = ParseSize(value, options.Particles);
+            }
+            else if (argument == "--frames")
+            {
+                result = ParseSize(value, options.Frames);
+            }
+            else if (argument == "--threads")
+            {
+                result = ParseSize(value, options.Threads);
+            }
+            else if (argument == "--frame-ms")
+            {
+                size_t milliseconds;
+                result = ParseSize(value, milliseconds);
+                options.FrameMilliseconds = static_cast<float>(milliseconds);
+            }
+            else if (argument == "--playback")
+            {
+                options.Playback = value;
+            }
+            else if (argument == "--trace")
+            {
+                options.Trace = value;
+            }
+            else if (argument == "--output")
+            {
+                options.Output = value;
+            }
+            else if (argument == "--write")
+            {
+                options.Write = value;
+            }
+            else
+            {
+                result = false;
+            }
+
+            if (!result)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool LoadParticles(const SceneParameters& parameters, size_t particles, ParticlesStore& store)
+    {
+        // An explicit count replaces the particles file of the scene.
+        if (particles == 0 && !parameters.ParticlesFile.empty())
+        {
+            ParticlesLoader loader;
+            if (!loader.Load(parameters.ParticlesFile, store))
+            {
+                std::cerr << "Could not load " << parameters.ParticlesFile << ": " << loader.GetErrorMessage() << "\n";
+                return false;
+            }
+
+            return true;
+        }
+
+        store.GenerateUniformCube(particles ? particles : parameters.ParticlesNumber, parameters.SpawnExtent);
+
+        return true;
+    }
+
+    void Run(
+        const HeadlessOptions& options,
+        const SceneParameters& parameters,
+        InputRecording* playback,
+        ParticlesStore& store,
+        HeadlessResult& result)
+    {
+        CameraClass camera;
+        TimerClass timer;
+        CpuClass cpu;
+        MemoryClass memory;
+        InputState input;
+        WorkerPool workers;
+        std::vector<InputEvent> events;
+        std::vector<ParticlesSimulation::StepParameters> substeps;
+        float rotation = 0.0f;
+
+        // A recording replays with the screen it was recorded on, without one the cursor rests in
+        // the center of the screen.
+        const int screenWidth = playback ? playback->GetScreenWidth() : s_ScreenWidth;
+        const int screenHeight = playback ? playback->GetScreenHeight() : s_ScreenHeight;
+        const size_t frames = playback ? playback->GetFrameCount() : options.Frames;
+
+        const float screenAspect = static_cast<float>(screenWidth) / static_cast<float>(screenHeight);
+        camera.SetProjection(
+            MathUtils::PerspectiveFovLH(MathUtils::s_Pi / 4.0f, screenAspect, s_ScreenNear, s_ScreenDepth));
+
+        timer.Initialize();
+        cpu.Initialize();
+        memory.Initialize();
+        input.Initialize(screenWidth, screenHeight);
+        workers.Initialize(options.Threads);
+
+        const uint64_t start = Clock::Now();
+
+        for (size_t frame = 0; frame < frames; ++frame)
+        {
+            PROFILE_ZONE("Frame");
+            Profiler::BeginFrame();
+
+            uint64_t frameNanoseconds =
+                static_cast<uint64_t>(options.FrameMilliseconds) * Clock::s_NanosecondsPerMillisecond;
+            int cursorX = screenWidth / 2;
+            int cursorY = screenHeight / 2;
+
+            // Feed the recorded events through the same input state as the viewer.
+            if (playback)
+            {
+                playback->PlayFrame(Clock::Now(), frameNanoseconds, events);
+
+                input.BeginFrame();
+                for (const auto& event : events)
+                {
+                    input.Apply(event);
+                }
+
+                input.GetMouseLocation(cursorX, cursorY);
+            }
+
+            const float deltaTime = Clock::ToMilliseconds(frameNanoseconds) * parameters.TimeScale;
+
+            // Move the camera the way the viewer does.
+            const auto cameraPosition = camera.GetPosition();
+            camera.SetPosition(cameraPosition.x + parameters.CameraDrift, 0.0f, -70.0f);
+            camera.Render();
+
+            // Orbit the well around the point under the cursor, along the cursor path of the frame.
+            const float rotationBegin = rotation;
+            rotation += deltaTime;
+
+            const WellPath::Parameters wellParameters = {
+                screenWidth,
+                screenHeight,
+                parameters.WellOrbitRadius,
+                rotationBegin,
+                rotation,
+                std::min(parameters.InputSubsteps, ParticlesSimulationThread::s_MaxSubsteps),
+            };
+
+            WellPath::BuildSubsteps(camera, wellParameters, input.GetCursorPath(), cursorX, cursorY, substeps);
+            WellPath::SetDeltaTime(deltaTime, substeps);
+
+            // The last substep reduces the statistics of the cloud on the way.
+            timer.Frame();
+            for (size_t i = 0; i + 1 < substeps.size(); ++i)
+            {
+                ParticlesSimulation::Step(store, substeps[i], ParticlesSimulation::Kernel::Fast, workers);
+            }
+            result.Cloud = ParticlesSimulation::StepWithStats(store, substeps.back(), ParticlesSimulation::Kernel::Fast, workers);
+            timer.Frame();
+
+            const auto& well = substeps.back().GravityFieldPosition;
+            result.StepTimes.Record(timer.GetFrameNanoseconds() / Clock::s_NanosecondsPerMicrosecond);
+            result.WellPosition = { well[0], well[1], well[2] };
+
+            cpu.Frame();
+            memory.Frame();
+        }
+
+        result.Seconds = Clock::ToSeconds(Clock::Now() - start);
+        result.Frames = frames;
+        result.Particles = store.Size();
+        result.Cpu = cpu.GetSnapshot();
+        result.Memory = memory.GetMemoryStats();
+
+        cpu.Shutdown();
+    }
+
+    void WriteJson(std::ostream& out, const HeadlessOptions& options, const HeadlessResult& result)
+    {
+        const auto milliseconds = [&](double fraction) {
+            return static_cast<double>(result.StepTimes.GetPercentile(fraction)) / 1000.0;
+        };
+
+        out << "{\n";
+        out << "  \"particles\": " << result.Particles << ",\n";
+        out << "  \"frames\": " << result.Frames << ",\n";
+        out << "  \"threads\": " << options.Threads << ",\n";
+        out << "  \"seconds\": " << result.Seconds << ",\n";
+        out << "  \"step_ms\": { \"p50\": " << milliseconds(0.5) << ", \"p90\": " << milliseconds(0.9)
+            << ", \"p99\": " << milliseconds(0.99) << ", \"max\": " << static_cast<double>(result.StepTimes.GetMax()) / 1000.0
+            << " },\n";
+        out << "  \"well_position\": [" << result.WellPosition.x << ", " << result.WellPosition.y << ", "
+            << result.WellPosition.z << "],\n";
+        const auto& cloud = result.Cloud;
+        const auto writeArray = [&](const auto& values) {
+            out << "[";
+            for (size_t i = 0; i < values.size(); ++i)
+            {
+                out << (i ? ", " : "") << values[i];
+            }
+            out << "]";
+        };
+
+        out << "  \"cloud\": {\n";
+        out << "    \"count\": " << cloud.Count << ",\n";
+        out << "    \"total_mass\": " << cloud.TotalMass << ",\n";
+        out << "    \"kinetic_energy\": " << cloud.KineticEnergy << ",\n";
+        out << "    \"potential_energy\": " << cloud.PotentialEnergy << ",\n";
+        out << "    \"momentum\": ";
+        writeArray(cloud.Momentum);
+        out << ",\n    \"center_of_mass\": ";
+        writeArray(cloud.CenterOfMass);
+        out << ",\n    \"bounds_min\": ";
+        writeArray(cloud.BoundsMin);
+        out << ",\n    \"bounds_max\": ";
+        writeArray(cloud.BoundsMax);
+        out << ",\n    \"speed_histogram\": ";
+        writeArray(cloud.SpeedHistogram);
+        out << "\n  },\n";
+        out << "  \"cpu\": { \"system_percent\": " << result.Cpu.SystemPercentage << ", \"process_percent\": "
+            << result.Cpu.ProcessPercentage << " },\n";
+        out << "  \"memory\": {\n";
+        out << "    \"resident_bytes\": " << result.Memory.ResidentBytes << ",\n";
+        out << "    \"peak_resident_bytes\": " << result.Memory.PeakResidentBytes << ",\n";
+        out << "    \"tags\": {\n";
+
+        for (size_t i = 0; i < MemoryTracker::s_TagCount; ++i)
+        {
+            const auto& totals = result.Memory.Tags[i].Totals;
+
+            out << "      \"" << MemoryTracker::GetTagName(static_cast<MemoryTracker::Tag>(i)) << "\": { \"current_bytes\": "
+                << totals.CurrentBytes << ", \"peak_bytes\": " << totals.PeakBytes << " }"
+                << (i + 1 < MemoryTracker::s_TagCount ? "," : "") << "\n";
+        }
+
+        out << "    }\n";
+        out << "  }\n";
+        out << "}\n";
+    }
+}
+
+int main(int argc, char** argv)
+{
+    HeadlessOptions options;
+    SceneConfigClass sceneConfig;
+    ParticlesStore store;
+    InputRecording playback;
+    HeadlessResult result;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: particles_headless [--scene file] [--particles N] [--frames N] [--threads N] "
+                     "[--frame-ms N] [--playback file] [--trace file] [--output file] [--write file]\n";
+        return 1;
+    }
+
+    Profiler::SetThreadName("Main");
+    Clock::Calibrate();
+
+    // A missing scene file falls back to the defaults, an invalid one is an error like in the viewer.
+    if (!sceneConfig.Initialize(options.Scene))
+    {
+        std::cerr << "Could not read the scene file: " << sceneConfig.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    const auto& parameters = sceneConfig.GetParameters();
+
+    if (!LoadParticles(parameters, options.Particles, store))
+    {
+        return 1;
+    }
+
+    if (!options.Playback.empty() && !playback.Load(options.Playback))
+    {
+        std::cerr << "Could not load " << options.Playback << ": " << playback.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    Run(options, parameters, options.Playback.empty() ? nullptr : &playback, store, result);
+
+    if (!options.Trace.empty() && !Profiler::ExportChromeTrace(options.Trace, static_cast<uint32_t>(result.Frames)))
+    {
+        std::cerr << "Could not write " << options.Trace << "\n";
+    }
+
+    if (!options.Write.empty())
+    {
+        ParticlesLoader writer;
+        if (!writer.Save(options.Write, store))
+        {
+            std::cerr << "Could not write " << options.Write << ": " << writer.GetErrorMessage() << "\n";
+            return 1;
+        }
+    }
+
+    if (options.Output.empty())
+    {
+        WriteJson(std::cout, options, result);
+    }
+    else
+    {
+        std::ofstream fout{ options.Output };
+        if (fout.fail())
+        {
+            std::cerr << "Could not open " << options.Output << "\n";
+            return 1;
+        }
+
+        WriteJson(fout, options, result);
+    }
+
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Builds the asset pack the viewer maps at startup.
+//
+// Every file is stored under its path relative to the root directory, which is also the name the
+// viewer looks it up by, for example shaders/particlesVS.hlsl. The pack goes next to the viewer
+// executable.
+//
+//   particles_pack [--root .] [--output ParticlesCloud.pack] file...
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetPack.h"
+#include "MappedFile.h"
+
+namespace
+{
+    struct PackerOptions
+    {
+        std::string Root = ".";
+        std::string Output = "ParticlesCloud.pack";
+        std::vector<std::string> Files;
+    };
+
+    bool ParseOptions(int argc, char** argv, PackerOptions& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string_view argument = argv[i];
+
+            if (argument == "--root" || argument == "--output")
+            {
+                if (i + 1 >= argc)
+                {
+                    return false;
+                }
+
+                (argument == "--root" ? options.Root : options.Output) = argv[++i];
+            }
+            else if (argument.starts_with("--"))
+            {
+                return false;
+            }
+            else
+            {
+                options.Files.emplace_back(argument);
+            }
+        }
+
+        return !options.Files.empty();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    PackerOptions options;
+    AssetPack pack;
+    std::vector<std::unique_ptr<MappedFile>> mappedFiles;
+    std::vector<AssetPack::PackFile> files;
+    size_t totalSize = 0;
+
+    if (!ParseOptions(argc, argv, options))
+    {
+        std::cerr << "usage: particles_pack [--root dir] [--output file] file...\n";
+        return 1;
+    }
+
+    // The files stay mapped until the pack is written.
+    for (const auto& name : options.Files)
+    {
+        auto file = std::make_unique<MappedFile>();
+        if (!file->Open(options.Root + "/" + name))
+        {
+            std::cerr << "Could not open " << name << " in " << options.Root << "\n";
+            return 1;
+        }
+
+        files.push_back({ name, { file->GetData(), file->GetSize() } });
+        totalSize += file->GetSize();
+        mappedFiles.push_back(std::move(file));
+    }
+
+    if (!pack.Save(options.Output, files))
+    {
+        std::cerr << "Could not write " << options.Output << ": " << pack.GetErrorMessage() << "\n";
+        return 1;
+    }
+
+    std::cout << "Packed " << files.size() << " files, " << totalSize << " bytes into " << options.Output << "\n";
+
+    return 0;
+}
@@ -1,15 +1,11 @@
 Texture2D shaderTexture;
 SamplerState SampleType;
 
-cbuffer PixelBuffer
-{
-    float4 pixelColor;
-};
-
 struct PixelInputType
 {
     float4 position : SV_POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 float4 FontPixelShader(PixelInputType input) : SV_TARGET
@@ -26,11 +22,11 @@ float4 FontPixelShader(PixelInputType input) : SV_TARGET
         color.a = 0.0f;
     }
 	
-    // If the color is other than black on the texture then this is a pixel in the font so draw it using the font pixel color.
+    // If the color is other than black on the texture then this is a pixel in the font so draw it using the color of the vertex.
     else
     {
         color.a = 1.0f;
-        color = color * pixelColor;
+        color = color * input.color;
     }
 
     return color;
@@ -9,12 +9,14 @@ struct VertexInputType
 {
     float4 position : POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 struct PixelInputType
 {
     float4 position : SV_POSITION;
     float2 tex : TEXCOORD0;
+    float4 color : COLOR;
 };
 
 PixelInputType FontVertexShader(VertexInputType input)
@@ -28,6 +30,9 @@ PixelInputType FontVertexShader(VertexInputType input)
     
     // Store the texture coordinates for the pixel shader.
     output.tex = input.tex;
+
+    // Every line of text carries its color in the vertices.
+    output.color = input.color;
     
     return output;
 }
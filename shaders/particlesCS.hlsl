@@ -12,9 +12,22 @@ cbuffer Parameters : register(b0)
     Matrix ProjectionMatrix;
     float3 GravityFieldPosition;
     float DeltaTime;
+    uint ParticlesNumber;
+    uint DispatchGroupsX;
+    float BillboardSize;
+    float Interpolation;
+};
+
+// Particle states stepped on the CPU, the layout of ParticleState in ParticlesSimulationThread.h.
+struct ParticleStateType
+{
+    float3 Position;
+    float VelocityLength;
 };
 
 RWStructuredBuffer<ParticleDataType> Particles : register(u0);
+StructuredBuffer<ParticleStateType> States : register(t0);
+StructuredBuffer<ParticleStateType> PreviousStates : register(t1);
 
 float3 _calculateGravityForce(float3 particlePosition, float3 gravityFieldPosition)
 {
@@ -23,6 +36,31 @@ float3 _calculateGravityForce(float3 particlePosition, float3 gravityFieldPositi
     return -direction / pow(distance, 3.0f);
 }
 
+// Write the four corners of the particle billboard in clip space.
+void _writeBillboard(uint index, float3 positionWorld, float velocityLength)
+{
+    float4 viewPosition = mul(float4(positionWorld, 1.f), ViewMatrix);
+    float4 imagePosition = mul(viewPosition, ProjectionMatrix);
+    
+    float4 shift = mul(float4(BillboardSize, BillboardSize, 0.f, 0.f), ProjectionMatrix);
+    
+    // Bottom left.
+    Particles[index * 4 + 0].PositionImage = imagePosition + float4(-shift.x, -shift.y, 0, 0);
+    Particles[index * 4 + 0].VelocityLength = velocityLength;
+    
+    // Top left.
+    Particles[index * 4 + 1].PositionImage = imagePosition + float4(-shift.x, shift.y, 0, 0);
+    Particles[index * 4 + 1].VelocityLength = velocityLength;
+
+    // Top Right.
+    Particles[index * 4 + 2].PositionImage = imagePosition + float4(shift.x, shift.y, 0, 0);
+    Particles[index * 4 + 2].VelocityLength = velocityLength;
+    
+    // Bottom right.
+    Particles[index * 4 + 3].PositionImage = imagePosition + float4(shift.x, -shift.y, 0, 0);
+    Particles[index * 4 + 3].VelocityLength = velocityLength;
+}
+
 #define THREAD_GROUP_X 32
 #define THREAD_GROUP_Y 32
 #define THREAD_GROUP_TOTAL 1024
@@ -30,10 +68,10 @@ float3 _calculateGravityForce(float3 particlePosition, float3 gravityFieldPositi
 [numthreads(THREAD_GROUP_X, THREAD_GROUP_Y, 1)]
 void DefaultCS(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex)
 {    
-    uint index = groupID.x * THREAD_GROUP_TOTAL + groupID.y * THREAD_GROUP_X * THREAD_GROUP_TOTAL + groupIndex;
+    uint index = (groupID.y * DispatchGroupsX + groupID.x) * THREAD_GROUP_TOTAL + groupIndex;
 	
 	[flatten]
-    if (index >= 1000000)
+    if (index >= ParticlesNumber)
         return;
     
     ParticleDataType particle = Particles[index * 4 + 0];
@@ -50,33 +88,32 @@ void DefaultCS(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex)
     float3 newGravityAcceleration = _calculateGravityForce(newPositionWorld, GravityFieldPosition);
     float3 newVelocity = halfNewVelocity + newGravityAcceleration * (DeltaTime / 2.0f);
 
-    Particles[index * 4 + 0].PositionWorld = float4(newPositionWorld, 1.f);
+    // The w component carries the particle mass, keep it untouched.
+    Particles[index * 4 + 0].PositionWorld = float4(newPositionWorld, particle.PositionWorld.w);
     Particles[index * 4 + 0].Velocity = newVelocity;
 
     // Compute position of QuadBillboard.
-    float4 worldPosition = float4(newPositionWorld, 1.f);
-    float4 viewPosition = mul(worldPosition, ViewMatrix);
-    float2 velocityLength = float2(length(particle.Velocity), 0.0f);
-    float4 imagePosition = mul(viewPosition, ProjectionMatrix);
-    
-    const float size = 0.01f;
-    float4 shift = mul(float4(size, size, 0.f, 0.f), ProjectionMatrix);
-    
-    // Bottom left.
-    Particles[index * 4 + 0].PositionImage = imagePosition + float4(-shift.x, -shift.y, 0, 0);
-    Particles[index * 4 + 0].VelocityLength = velocityLength;
-    
-    // Top left.
-    Particles[index * 4 + 1].PositionImage = imagePosition + float4(-shift.x, shift.y, 0, 0);
-    Particles[index * 4 + 1].VelocityLength = velocityLength;
+    _writeBillboard(index, newPositionWorld, length(particle.Velocity));
+}
 
-    // Top Right.
-    Particles[index * 4 + 2].PositionImage = imagePosition + float4(shift.x, shift.y, 0, 0);
-    Particles[index * 4 + 2].VelocityLength = velocityLength;
-    
-    // Bottom right.
-    Particles[index * 4 + 3].PositionImage = imagePosition + float4(shift.x, -shift.y, 0, 0);
-    Particles[index * 4 + 3].VelocityLength = velocityLength;
+// Only expand the billboards, the particles were stepped by the simulation thread. They are
+// placed between the last two steps by Interpolation, past the last step when it is above one.
+[numthreads(THREAD_GROUP_X, THREAD_GROUP_Y, 1)]
+void ProjectCS(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    uint index = (groupID.y * DispatchGroupsX + groupID.x) * THREAD_GROUP_TOTAL + groupIndex;
+
+    [flatten]
+    if (index >= ParticlesNumber)
+        return;
+
+    ParticleStateType state = States[index];
+    ParticleStateType previousState = PreviousStates[index];
+
+    float3 position = lerp(previousState.Position, state.Position, Interpolation);
+    float velocityLength = lerp(previousState.VelocityLength, state.VelocityLength, Interpolation);
+
+    _writeBillboard(index, position, velocityLength);
 }
 
 technique ParticleSolver